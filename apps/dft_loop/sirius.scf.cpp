@@ -75,7 +75,13 @@ double ground_state(Simulation_context& ctx,
     double initial_tol = ctx.iterative_solver_tolerance();
 
     /* launch the calculation */
-    auto result = dft.find(inp.density_tol_, inp.energy_tol_, initial_tol, inp.num_dft_iter_, write_state);
+    json result;
+    if (args.exist("direct_minimization")) {
+        result = dft.find_direct(inp.energy_tol_, ctx.iterative_solver_input().residual_tolerance_,
+                                 inp.num_dft_iter_);
+    } else {
+        result = dft.find(inp.density_tol_, inp.energy_tol_, initial_tol, inp.num_dft_iter_, write_state);
+    }
 
     if (ctx.control().verification_ >= 1) {
         dft.check_scf_density();
@@ -91,9 +97,15 @@ double ground_state(Simulation_context& ctx,
 
     //dft.print_magnetic_moment();
 
-    if (ctx.control().print_stress_ && !ctx.full_potential()) {
+    bool need_stress = ctx.control().print_stress_ && !ctx.full_potential();
+    if (need_stress && ctx.control().print_forces_) {
+        /* share the non-local contribution between forces and stress */
+        dft.forces().calc_forces_stress_total(dft.stress());
+    }
+
+    if (need_stress) {
         Stress& s       = dft.stress();
-        auto stress_tot = s.calc_stress_total();
+        auto stress_tot = ctx.control().print_forces_ ? s.stress_total() : s.calc_stress_total();
         s.print_info();
         result["stress"] = std::vector<std::vector<double>>(3, std::vector<double>(3));
         for (int i = 0; i < 3; i++) {
@@ -104,7 +116,7 @@ double ground_state(Simulation_context& ctx,
     }
     if (ctx.control().print_forces_) {
         Force& f         = dft.forces();
-        auto& forces_tot = f.calc_forces_total();
+        auto& forces_tot = need_stress ? f.forces_total() : f.calc_forces_total();
         f.print_info();
         result["forces"] = std::vector<std::vector<double>>(ctx.unit_cell().num_atoms(), std::vector<double>(3));
         for (int i = 0; i < ctx.unit_cell().num_atoms(); i++) {
@@ -285,15 +297,23 @@ void run_tasks(cmd_args const& args)
         potential.generate(density);
         Band band(*ctx);
         Hamiltonian0 H0(potential);
+        /* seed each k-point of the path with the converged wave-functions of the previous one */
+        bool continuation = args.exist("kpath_continuation");
         if (!ctx->full_potential()) {
-            band.initialize_subspace(ks, H0);
+            if (!continuation) {
+                band.initialize_subspace(ks, H0);
+            }
             if (ctx->hubbard_correction()) {
                 TERMINATE("fix me");
                 potential.U().hubbard_compute_occupation_numbers(ks); // TODO: this is wrong; U matrix should come form the saved file
                 potential.U().calculate_hubbard_potential_and_energy();
             }
         }
-        band.solve(ks, H0, true);
+        if (continuation) {
+            band.solve_k_point_path(ks, H0);
+        } else {
+            band.solve(ks, H0, true);
+        }
 
         ks.sync_band_energies();
         if (Communicator::world().rank() == 0) {
@@ -345,6 +365,8 @@ int main(int argn, char** argv)
     args.register_key("--test_against=", "{string} json file with reference values");
     args.register_key("--repeat_update=", "{int} number of times to repeat update()");
     args.register_key("--fpe", "enable check of floating-point exceptions using GNUC library");
+    args.register_key("--kpath_continuation", "start each k-point of the band-structure path from the previous one");
+    args.register_key("--direct_minimization", "find the ground state of an insulator by the direct minimization");
     args.register_key("--control.processing_unit=", "");
     args.register_key("--control.verbosity=", "");
     args.register_key("--control.verification=", "");
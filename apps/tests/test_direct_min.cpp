@@ -0,0 +1,64 @@
+#include <sirius.h>
+
+/* total energy of an insulator found by the direct minimization is compared with the total energy of the SCF loop;
+   run in the directory of an insulating test case; verification/run_tests.x runs it in test04 (LiF, Gamma-point) */
+
+using namespace sirius;
+
+int test_direct_min(cmd_args const& args__)
+{
+    auto fname = args__.value<std::string>("input", "sirius.json");
+    auto tol   = args__.value<double>("tol", 1e-6);
+
+    Simulation_context ctx(fname, Communicator::world());
+    ctx.import(args__);
+    ctx.initialize();
+
+    auto& inp = ctx.parameters_input();
+    double initial_tol = ctx.iterative_solver_tolerance();
+
+    K_point_set kset(ctx, inp.ngridk_, inp.shiftk_, ctx.use_symmetry());
+    DFT_ground_state dft(kset);
+
+    /* reference: Davidson solver in the SCF loop */
+    dft.initial_state();
+    auto result_scf = dft.find(inp.density_tol_, inp.energy_tol_, initial_tol, inp.num_dft_iter_, false);
+    double etot_scf = dft.total_energy();
+
+    /* direct minimization from the same initial state */
+    ctx.iterative_solver_tolerance(initial_tol);
+    dft.initial_state();
+    auto result_dm = dft.find_direct(inp.energy_tol_, ctx.iterative_solver_input().residual_tolerance_,
+                                     inp.num_dft_iter_);
+    double etot_dm = dft.total_energy();
+
+    bool converged = result_scf["converged"].get<bool>() && result_dm["converged"].get<bool>();
+    double diff    = std::abs(etot_scf - etot_dm);
+    if (Communicator::world().rank() == 0) {
+        printf("SCF total energy                  : %18.12f\n", etot_scf);
+        printf("direct minimization total energy  : %18.12f\n", etot_dm);
+        printf("difference                        : %18.12e\n", diff);
+        printf("converged                         : %s\n", converged ? "yes" : "no");
+    }
+
+    return (converged && diff < tol) ? 0 : 1;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"input=", "(string) input file name"},
+                               {"tol=", "(double) tolerance for the total energy difference"}
+                              });
+
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    int result = test_direct_min(args);
+    sirius::finalize();
+
+    return result;
+}
@@ -0,0 +1,158 @@
+#include <sirius.h>
+
+/* band structure along a path of k-points with the continuation solver; eigen-values are checked against the
+   free-electron ones and against the cold solve of each k-point; run with more MPI ranks than k-points to check
+   that ranks without local k-points do not block */
+
+using namespace sirius;
+
+int test_kpath(cmd_args const& args__)
+{
+    auto pw_cutoff = args__.value<double>("pw_cutoff", 20);
+    auto gk_cutoff = args__.value<double>("gk_cutoff", 6);
+    auto nk        = args__.value<int>("num_kpoints", 8);
+
+    /* create simulation context */
+    Simulation_context ctx(
+        "{"
+        "   \"parameters\" : {"
+        "        \"electronic_structure_method\" : \"pseudopotential\""
+        "    },"
+        "   \"control\" : {"
+        "       \"verification\" : 0,"
+        "       \"memory_usage\" : \"low\""
+        "    }"
+        "}");
+
+    /* add a new atom type to the unit cell */
+    auto& atype = ctx.unit_cell().add_atom_type("Cu");
+    /* set pseudo charge */
+    atype.zn(11);
+    /* set radial grid */
+    atype.set_radial_grid(radial_grid_t::lin_exp, 1000, 0.0, 100.0, 6);
+    /* cutoff at ~1 a.u. */
+    int icut = atype.radial_grid().index_of(1.0);
+    double rcut = atype.radial_grid(icut);
+    /* create beta radial function */
+    std::vector<double> beta(icut + 1);
+    for (int l = 0; l <= 2; l++) {
+        for (int i = 0; i <= icut; i++) {
+            double x = atype.radial_grid(i);
+            beta[i] = utils::confined_polynomial(x, rcut, l, l + 1, 0);
+        }
+        atype.add_beta_radial_function(l, beta);
+    }
+
+    std::vector<double> ps_wf(atype.radial_grid().num_points());
+    for (int l = 0; l <= 2; l++) {
+        for (int i = 0; i < atype.radial_grid().num_points(); i++) {
+            double x = atype.radial_grid(i);
+            ps_wf[i] = std::exp(-x) * std::pow(x, l);
+        }
+        atype.add_ps_atomic_wf(3, l, ps_wf);
+    }
+
+    /* zero local potential and zero Dion matrix: free electrons */
+    std::vector<double> vloc(atype.radial_grid().num_points(), 0);
+    atype.local_potential(vloc);
+    int nbf = atype.num_beta_radial_functions();
+    matrix<double> dion(nbf, nbf);
+    dion.zero();
+    atype.d_mtrx_ion(dion);
+    /* set atomic density */
+    std::vector<double> arho(atype.radial_grid().num_points());
+    for (int i = 0; i < atype.radial_grid().num_points(); i++) {
+        double x = atype.radial_grid(i);
+        arho[i] = 2 * atype.zn() * std::exp(-x * x) * x;
+    }
+    atype.ps_total_charge_density(arho);
+
+    double a{5};
+    ctx.unit_cell().set_lattice_vectors({{a, 0, 0}, {0, a, 0}, {0, 0, a}});
+    ctx.unit_cell().add_atom("Cu", {0, 0, 0});
+
+    ctx.pw_cutoff(pw_cutoff);
+    ctx.gk_cutoff(gk_cutoff);
+    ctx.gamma_point(false);
+    ctx.iterative_solver_tolerance(1e-12);
+    ctx.initialize();
+
+    Density rho(ctx);
+    rho.initial_density();
+    rho.zero();
+
+    Potential pot(ctx);
+    pot.generate(rho);
+    pot.zero();
+
+    /* k-points along the [111] direction */
+    K_point_set ks(ctx);
+    for (int ik = 0; ik < nk; ik++) {
+        double vk[] = {0.1 * ik / nk, 0.1 * ik / nk, 0.1 * ik / nk};
+        ks.add_kpoint(vk, 1.0);
+    }
+    ks.initialize();
+
+    Hamiltonian0 H0(pot);
+    Band(ctx).solve_k_point_path(ks, H0);
+
+    /* band energies are synchronized between all ranks by the solver */
+    mdarray<double, 2> band_energy_path(ctx.num_bands(), nk);
+    for (int ik = 0; ik < nk; ik++) {
+        for (int i = 0; i < ctx.num_bands(); i++) {
+            band_energy_path(i, ik) = ks[ik]->band_energy(i, 0);
+        }
+    }
+
+    double max_diff{0};
+    for (int ikloc = 0; ikloc < ks.spl_num_kpoints().local_size(); ikloc++) {
+        auto kp = ks[ks.spl_num_kpoints(ikloc)];
+        std::vector<double> ekin(kp->num_gkvec());
+        for (int i = 0; i < kp->num_gkvec(); i++) {
+            ekin[i] = 0.5 * kp->gkvec().gkvec_cart<index_domain_t::global>(i).length2();
+        }
+        std::sort(ekin.begin(), ekin.end());
+        for (int i = 0; i < ctx.num_bands(); i++) {
+            max_diff = std::max(max_diff, std::abs(ekin[i] - kp->band_energy(i, 0)));
+        }
+    }
+    Communicator::world().allreduce<double, mpi_op_t::max>(&max_diff, 1);
+
+    /* cold solve: each k-point starts from the standard subspace guess */
+    Band(ctx).initialize_subspace(ks, H0);
+    Band(ctx).solve(ks, H0, true);
+
+    double max_diff_cold{0};
+    for (int ik = 0; ik < nk; ik++) {
+        for (int i = 0; i < ctx.num_bands(); i++) {
+            max_diff_cold = std::max(max_diff_cold, std::abs(band_energy_path(i, ik) - ks[ik]->band_energy(i, 0)));
+        }
+    }
+
+    if (Communicator::world().rank() == 0) {
+        printf("maximum eigen-value difference (free electrons): %20.16e\n", max_diff);
+        printf("maximum eigen-value difference (cold solve)    : %20.16e\n", max_diff_cold);
+    }
+
+    return (max_diff > 1e-8 || max_diff_cold > 1e-8) ? 1 : 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"pw_cutoff=", "(double) plane-wave cutoff for density and potential"},
+                               {"gk_cutoff=", "(double) plane-wave cutoff for wave-functions"},
+                               {"num_kpoints=", "(int) number of k-points along the path"}
+                              });
+
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    int result = test_kpath(args);
+    sirius::finalize();
+
+    return result;
+}
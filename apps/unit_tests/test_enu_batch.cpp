@@ -0,0 +1,201 @@
+#include <sirius.h>
+
+/* linearization energies found by the batched search (all channels integrated together) are compared with the
+   scalar search which integrates one channel at a time with Radial_solver::integrate_forward_rk4(); the results
+   must be bitwise identical */
+
+using namespace sirius;
+
+/* scalar search of the band top, bottom and linearization energy for a single channel */
+class Enu_finder_scalar : public Radial_solver
+{
+  private:
+    int n_;
+    int l_;
+    double enu_;
+    double etop_;
+    double ebot_;
+
+    int integrate(relativity_t rel__, double enu__, Spline<double>& chi_p__, Spline<double>& chi_q__,
+                  std::vector<double>& p__, std::vector<double>& dpdr__, std::vector<double>& q__,
+                  std::vector<double>& dqdr__) const
+    {
+        switch (rel__) {
+            case relativity_t::none: {
+                return integrate_forward_rk4<relativity_t::none, false>(enu__, l_, 0, chi_p__, chi_q__, p__, dpdr__,
+                                                                        q__, dqdr__);
+            }
+            case relativity_t::koelling_harmon: {
+                return integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu__, l_, 0, chi_p__, chi_q__,
+                                                                                   p__, dpdr__, q__, dqdr__);
+            }
+            case relativity_t::zora: {
+                return integrate_forward_rk4<relativity_t::zora, false>(enu__, l_, 0, chi_p__, chi_q__, p__, dpdr__,
+                                                                        q__, dqdr__);
+            }
+            case relativity_t::iora: {
+                return integrate_forward_rk4<relativity_t::iora, false>(enu__, l_, 0, chi_p__, chi_q__, p__, dpdr__,
+                                                                        q__, dqdr__);
+            }
+            default: {
+                throw std::runtime_error("not implemented");
+            }
+        }
+    }
+
+  public:
+    Enu_finder_scalar(relativity_t rel__, int zn__, int n__, int l__, Radial_grid<double> const& radial_grid__,
+                      std::vector<double> const& v__, double enu_start__)
+        : Radial_solver(zn__, v__, radial_grid__)
+        , n_(n__)
+        , l_(l__)
+    {
+        int np = num_points();
+
+        Spline<double> chi_p(radial_grid());
+        Spline<double> chi_q(radial_grid());
+
+        std::vector<double> p(np);
+        std::vector<double> q(np);
+        std::vector<double> dpdr(np);
+        std::vector<double> dqdr(np);
+
+        /* top of the band: p(R) = 0 and n-l-1 nodes */
+        double enu = enu_start__;
+        double de  = 0.001;
+        bool found = false;
+        int nndp   = 0;
+        for (int i = 0; i < 1000; i++) {
+            int nnd = integrate(rel__, enu, chi_p, chi_q, p, dpdr, q, dqdr) - (n_ - l_ - 1);
+            enu = (nnd > 0) ? enu - de : enu + de;
+            if (i) {
+                de = (nnd != nndp) ? de * 0.5 : de * 1.25;
+            }
+            if (std::abs(de) < 1e-10) {
+                found = true;
+                break;
+            }
+            nndp = nnd;
+        }
+        etop_ = (!found) ? enu_start__ : enu;
+
+        double sd = dpdr.back();
+
+        /* bottom of the band: p'(R) = 0 */
+        de = 1e-4;
+        for (int i = 0; i < 100; i++) {
+            de *= 1.1;
+            enu -= de;
+            integrate(rel__, enu, chi_p, chi_q, p, dpdr, q, dqdr);
+            if (dpdr.back() * sd <= 0) {
+                break;
+            }
+        }
+
+        double e1 = enu;
+        double e0 = enu + de;
+        for (int i = 0; i < 100; i++) {
+            enu = (e1 + e0) / 2.0;
+            integrate(rel__, enu, chi_p, chi_q, p, dpdr, q, dqdr);
+            if (std::abs(dpdr.back()) < 1e-10) {
+                break;
+            }
+            if (dpdr.back() * sd > 0) {
+                e0 = enu;
+            } else {
+                e1 = enu;
+            }
+        }
+        ebot_ = enu;
+
+        if (integrate(rel__, enu, chi_p, chi_q, p, dpdr, q, dqdr) != n_ - l_ - 1) {
+            throw std::runtime_error("wrong number of nodes");
+        }
+        enu_ = (ebot_ + etop_) / 2.0;
+    }
+
+    double enu() const
+    {
+        return enu_;
+    }
+
+    double ebot() const
+    {
+        return ebot_;
+    }
+
+    double etop() const
+    {
+        return etop_;
+    }
+};
+
+int run_test(cmd_args const& args__)
+{
+    int zn = args__.value<int>("zn", 26);
+    double R = args__.value<double>("R", 2.0);
+
+    auto rgrid = Radial_grid_factory<double>(radial_grid_t::lin_exp, 1500, 1e-7, R, 6.0);
+    /* screened Coulomb potential */
+    std::vector<double> v(rgrid.num_points());
+    for (int ir = 0; ir < rgrid.num_points(); ir++) {
+        v[ir] = -zn * std::exp(-rgrid[ir]) / rgrid[ir];
+    }
+
+    std::vector<int> n;
+    std::vector<int> l;
+    for (int n1 = 1; n1 <= 4; n1++) {
+        for (int l1 = 0; l1 < n1; l1++) {
+            n.push_back(n1);
+            l.push_back(l1);
+        }
+    }
+    std::vector<double> enu_start(n.size(), -0.1);
+
+    int num_fail{0};
+    for (auto rel : {relativity_t::none, relativity_t::koelling_harmon, relativity_t::zora, relativity_t::iora}) {
+        Enu_finder batch(rel, zn, n, l, rgrid, v, enu_start);
+        for (size_t j = 0; j < n.size(); j++) {
+            Enu_finder_scalar ref(rel, zn, n[j], l[j], rgrid, v, enu_start[j]);
+            Enu_finder single(rel, zn, n[j], l[j], rgrid, v, enu_start[j]);
+            if (batch.enu(j) != ref.enu() || batch.etop(j) != ref.etop() || batch.ebot(j) != ref.ebot() ||
+                single.enu() != ref.enu() || single.etop() != ref.etop() || single.ebot() != ref.ebot()) {
+                printf("\nrelativity: %i, n: %i, l: %i\n", static_cast<int>(rel), n[j], l[j]);
+                printf("  scalar  (enu, etop, ebot): %20.16f %20.16f %20.16f\n", ref.enu(), ref.etop(), ref.ebot());
+                printf("  batched (enu, etop, ebot): %20.16f %20.16f %20.16f\n", batch.enu(j), batch.etop(j),
+                       batch.ebot(j));
+                printf("  single  (enu, etop, ebot): %20.16f %20.16f %20.16f\n", single.enu(), single.etop(),
+                       single.ebot());
+                num_fail++;
+            }
+        }
+    }
+
+    return num_fail ? 1 : 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--zn=", "{int} nuclear charge of the model potential");
+    args.register_key("--R=", "{double} radius of the sphere");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
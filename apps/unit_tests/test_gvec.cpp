@@ -23,6 +23,48 @@ int run_test(cmd_args& args)
     if (gvec_r.num_gvec() * 2 != gvec.num_gvec() + 1) {
         return 1;
     }
+
+    /* check the lookup of G-vector indices */
+    mdarray<int, 2> gv(3, gvec.num_gvec());
+    gvec_index_map idx(gvec.num_gvec());
+    for (int ig = 0; ig < gvec.num_gvec(); ig++) {
+        auto G = gvec.gvec(ig);
+        for (int x : {0, 1, 2}) {
+            gv(x, ig) = G[x];
+        }
+        idx.insert(G, ig);
+    }
+    auto igv   = gvec.index_by_gvec(gvec.num_gvec(), &gv(0, 0), false);
+    auto igv_r = gvec_r.index_by_gvec(gvec.num_gvec(), &gv(0, 0), true);
+    auto igh   = idx.find(gvec.num_gvec(), &gv(0, 0));
+    for (int ig = 0; ig < gvec.num_gvec(); ig++) {
+        auto G = gvec.gvec(ig);
+        if (igv[ig].first != ig || igh[ig] != ig || idx.find(G) != ig) {
+            return 2;
+        }
+        /* every G-vector or its inverse is in the reduced set */
+        int ig_r = igv_r[ig].first;
+        if (ig_r < 0 || gvec_r.gvec(ig_r) != (igv_r[ig].second ? G * (-1) : G)) {
+            return 3;
+        }
+    }
+    if (idx.find(vector3d<int>(10000, 0, 0)) != -1) {
+        return 4;
+    }
+
+    /* check the shells of the local G+k vectors */
+    Gvec gkvec(vector3d<double>(0.1, 0.2, -0.3), M, cutoff, Communicator::world(), false);
+    for (int igloc = 0; igloc < gkvec.count(); igloc++) {
+        double len = gkvec.gkvec_cart<index_domain_t::local>(igloc).length();
+        if (std::abs(gkvec.gkvec_shell_len_local(gkvec.gkvec_shell_idx_local(igloc)) - len) > 1e-8) {
+            return 5;
+        }
+    }
+    for (int i = 1; i < gkvec.num_gkvec_shells_local(); i++) {
+        if (gkvec.gkvec_shell_len_local(i) <= gkvec.gkvec_shell_len_local(i - 1)) {
+            return 6;
+        }
+    }
     return 0;
 }
 
@@ -0,0 +1,127 @@
+#include <sirius.h>
+#include <random>
+
+/* incremental update of the phase factors of atom types after many random moves of atoms is compared with the
+   summation over all atoms */
+
+using namespace sirius;
+
+static void add_atom_type(Simulation_context& ctx__, std::string label__)
+{
+    auto& atype = ctx__.unit_cell().add_atom_type(label__);
+    atype.zn(1);
+    atype.set_radial_grid(radial_grid_t::lin_exp, 1000, 0.0, 100.0, 6);
+    int icut = atype.radial_grid().index_of(1.0);
+    double rcut = atype.radial_grid(icut);
+    std::vector<double> beta(icut + 1);
+    for (int i = 0; i <= icut; i++) {
+        beta[i] = utils::confined_polynomial(atype.radial_grid(i), rcut, 0, 1, 0);
+    }
+    atype.add_beta_radial_function(0, beta);
+    std::vector<double> vloc(atype.radial_grid().num_points(), 0);
+    atype.local_potential(vloc);
+    matrix<double> dion(1, 1);
+    dion.zero();
+    atype.d_mtrx_ion(dion);
+    std::vector<double> arho(atype.radial_grid().num_points());
+    for (int i = 0; i < atype.radial_grid().num_points(); i++) {
+        double x = atype.radial_grid(i);
+        arho[i] = 2 * atype.zn() * std::exp(-x * x) * x;
+    }
+    atype.ps_total_charge_density(arho);
+}
+
+/* maximum difference between the stored phase factors of atom types and the sum over atoms */
+static double diff_phase_factors_t(Simulation_context& ctx__)
+{
+    double diff{0};
+    for (int igloc = 0; igloc < ctx__.gvec().count(); igloc++) {
+        int ig = ctx__.gvec().offset() + igloc;
+        for (int iat = 0; iat < ctx__.unit_cell().num_atom_types(); iat++) {
+            double_complex z(0, 0);
+            for (int i = 0; i < ctx__.unit_cell().atom_type(iat).num_atoms(); i++) {
+                z += ctx__.gvec_phase_factor(ig, ctx__.unit_cell().atom_type(iat).atom_id(i));
+            }
+            diff = std::max(diff, std::abs(z - ctx__.phase_factors_t(igloc, iat)));
+        }
+    }
+    ctx__.comm().allreduce<double, mpi_op_t::max>(&diff, 1);
+    return diff;
+}
+
+int run_test(cmd_args& args)
+{
+    int num_steps = args.value<int>("num_steps", 500);
+
+    double diff[2];
+    /* only incremental updates and a summation on every update */
+    for (int rebuild : {num_steps + 1, 1}) {
+        std::stringstream s;
+        s << "{\"parameters\" : {\"electronic_structure_method\" : \"pseudopotential\", \"use_symmetry\" : false,"
+          << "\"pw_cutoff\" : 10, \"gk_cutoff\" : 3},"
+          << "\"control\" : {\"verification\" : 0},"
+          << "\"settings\" : {\"phase_factors_t_rebuild\" : " << rebuild << "}}";
+        Simulation_context ctx(s.str());
+
+        add_atom_type(ctx, "A");
+        add_atom_type(ctx, "B");
+
+        std::mt19937 rnd(1234);
+        std::uniform_real_distribution<double> dist(0, 1);
+
+        double a{8};
+        ctx.unit_cell().set_lattice_vectors({{a, 0, 0}, {0, a, 0}, {0, 0, a}});
+        for (int ia = 0; ia < 8; ia++) {
+            vector3d<double> pos(0.5 * (ia % 2), 0.5 * ((ia / 2) % 2), 0.5 * (ia / 4));
+            for (int x : {0, 1, 2}) {
+                pos[x] += 0.1 * dist(rnd);
+            }
+            ctx.unit_cell().add_atom((ia % 2) ? "A" : "B", pos, {0, 0, 0});
+        }
+        ctx.initialize();
+
+        /* move one or two atoms at a time */
+        for (int istep = 0; istep < num_steps; istep++) {
+            for (int j = 0; j <= istep % 2; j++) {
+                int ia   = static_cast<int>(dist(rnd) * ctx.unit_cell().num_atoms()) % ctx.unit_cell().num_atoms();
+                auto pos = ctx.unit_cell().atom(ia).position();
+                for (int x : {0, 1, 2}) {
+                    pos[x] += 0.05 * (dist(rnd) - 0.5);
+                }
+                ctx.unit_cell().atom(ia).set_position(pos);
+            }
+            ctx.update();
+        }
+        diff[(rebuild == 1) ? 1 : 0] = diff_phase_factors_t(ctx);
+    }
+    if (Communicator::world().rank() == 0) {
+        printf("difference (incremental) : %18.12e, difference (summation) : %18.12e\n", diff[0], diff[1]);
+    }
+
+    return (diff[0] < 1e-10 && diff[1] < 1e-12) ? 0 : 1;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--num_steps=", "{int} number of random moves of atoms");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
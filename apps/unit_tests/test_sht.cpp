@@ -58,6 +58,33 @@ double test1_angular_radial_complex(int lmax__)
     return d;
 }
 
+double test2_sht_hierarchy(int lmax__)
+{
+    SHT_hierarchy sht(sddk::device_t::CPU, lmax__, 0, {{0.5, lmax__ / 2}});
+    int lmmax = utils::lmmax(lmax__);
+
+    auto r = Radial_grid_factory<double>(radial_grid_t::exponential, 1000, 0.01, 2.0, 1.0);
+
+    /* inner points are expanded only up to the lmax of the reduced mesh */
+    Spheric_function<function_domain_t::spectral, double> f1(lmmax, r);
+    for (int ir = 0; ir < r.num_points(); ir++) {
+        int lmmax_ir = (ir < sht.ir_end(1, r.num_points())) ? sht.sht(1).lmmax() : lmmax;
+        for (int lm = 0; lm < lmmax; lm++) {
+            f1(lm, ir) = (lm < lmmax_ir) ? utils::random<double>() : 0;
+        }
+    }
+    auto f2 = transform(sht, f1);
+    auto f3 = transform(sht, f2);
+
+    double d = 0;
+    for (int ir = 0; ir < r.num_points(); ir++) {
+        for (int lm = 0; lm < lmmax; lm++) {
+            d += std::abs(f1(lm, ir) - f3(lm, ir));
+        }
+    }
+    return d;
+}
+
 int main(int argn, char** argv)
 {
     sirius::initialize(true);
@@ -70,6 +97,9 @@ int main(int argn, char** argv)
     if ((diff = test1_angular_radial_complex(10)) > 1e-10) {
         return 2;
     }
+    if ((diff = test2_sht_hierarchy(10)) > 1e-8) {
+        return 3;
+    }
 
     sirius::finalize();
 
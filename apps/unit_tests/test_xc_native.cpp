@@ -0,0 +1,174 @@
+#include <sirius.h>
+
+/* compare built-in XC kernels with Libxc */
+
+using namespace sirius;
+
+double diff(std::vector<double> const& a, std::vector<double> const& b)
+{
+    double d{0};
+    for (size_t i = 0; i < a.size(); i++) {
+        d = std::max(d, std::abs(a[i] - b[i]) / std::max(1e-8, std::abs(b[i])));
+    }
+    return d;
+}
+
+int test_unpolarized(std::string name__, int n__)
+{
+    XC_functional_base ref(name__, 1);
+    XC_functional_base xc(name__, 1);
+    if (!xc.use_native(0)) {
+        return 1;
+    }
+
+    std::vector<double> rho(n__), sigma(n__);
+    for (int i = 0; i < n__; i++) {
+        rho[i]   = std::pow(10, -3 + 3 * utils::random<double>());
+        sigma[i] = rho[i] * utils::random<double>();
+    }
+
+    std::vector<double> e(n__), v(n__), vs(n__), e_ref(n__), v_ref(n__), vs_ref(n__);
+    if (xc.is_lda()) {
+        xc.get_lda(n__, rho.data(), v.data(), e.data());
+        ref.get_lda(n__, rho.data(), v_ref.data(), e_ref.data());
+    } else {
+        xc.get_gga(n__, rho.data(), sigma.data(), v.data(), vs.data(), e.data());
+        ref.get_gga(n__, rho.data(), sigma.data(), v_ref.data(), vs_ref.data(), e_ref.data());
+    }
+    double d = std::max(diff(e, e_ref), std::max(diff(v, v_ref), diff(vs, vs_ref)));
+    printf("%-14s unpolarized : %18.12e\n", name__.c_str(), d);
+
+    return (d > 1e-6) ? 2 : 0;
+}
+
+int test_polarized(std::string name__, int n__)
+{
+    XC_functional_base ref(name__, 2);
+    XC_functional_base xc(name__, 2);
+    if (!xc.use_native(0)) {
+        return 1;
+    }
+
+    std::vector<double> rho_up(n__), rho_dn(n__), s_uu(n__), s_ud(n__), s_dd(n__);
+    for (int i = 0; i < n__; i++) {
+        double rho = std::pow(10, -3 + 3 * utils::random<double>());
+        double z   = 2 * utils::random<double>() - 1;
+        rho_up[i]  = 0.5 * rho * (1 + z);
+        rho_dn[i]  = 0.5 * rho * (1 - z);
+        s_uu[i]    = rho_up[i] * utils::random<double>();
+        s_dd[i]    = rho_dn[i] * utils::random<double>();
+        s_ud[i]    = std::sqrt(s_uu[i] * s_dd[i]) * (2 * utils::random<double>() - 1);
+    }
+
+    std::vector<std::vector<double>> out(6, std::vector<double>(n__));
+    std::vector<std::vector<double>> out_ref(6, std::vector<double>(n__));
+    if (xc.is_lda()) {
+        xc.get_lda(n__, rho_up.data(), rho_dn.data(), out[0].data(), out[1].data(), out[2].data());
+        ref.get_lda(n__, rho_up.data(), rho_dn.data(), out_ref[0].data(), out_ref[1].data(), out_ref[2].data());
+    } else {
+        xc.get_gga(n__, rho_up.data(), rho_dn.data(), s_uu.data(), s_ud.data(), s_dd.data(), out[0].data(),
+                   out[1].data(), out[2].data(), out[3].data(), out[4].data(), out[5].data());
+        ref.get_gga(n__, rho_up.data(), rho_dn.data(), s_uu.data(), s_ud.data(), s_dd.data(), out_ref[0].data(),
+                    out_ref[1].data(), out_ref[2].data(), out_ref[3].data(), out_ref[4].data(), out_ref[5].data());
+    }
+    double d{0};
+    for (int k = 0; k < 6; k++) {
+        d = std::max(d, diff(out[k], out_ref[k]));
+    }
+    printf("%-14s polarized   : %18.12e\n", name__.c_str(), d);
+
+    return (d > 1e-6) ? 3 : 0;
+}
+
+/* points with the total density below the threshold must be screened, the rest must match Libxc */
+int test_screening(std::string name__, int num_spins__, int n__)
+{
+    double const thr = 1e-4;
+
+    XC_functional_base ref(name__, num_spins__);
+    XC_functional_base xc(name__, num_spins__);
+    if (!xc.use_native(thr)) {
+        return 1;
+    }
+
+    /* even points are below the threshold, odd points are well above it (each spin channel is above it as well) */
+    std::vector<double> rho_up(n__), rho_dn(n__), s_uu(n__), s_ud(n__), s_dd(n__);
+    for (int i = 0; i < n__; i++) {
+        double rho = (i % 2) ? 4 * thr * std::pow(10, 3 * utils::random<double>())
+                             : 0.5 * thr * std::pow(10, -3 * utils::random<double>());
+        double z   = (num_spins__ == 1) ? 0 : utils::random<double>() - 0.5;
+        rho_up[i]  = 0.5 * rho * (1 + z);
+        rho_dn[i]  = 0.5 * rho * (1 - z);
+        s_uu[i]    = rho_up[i] * utils::random<double>();
+        s_dd[i]    = rho_dn[i] * utils::random<double>();
+        s_ud[i]    = std::sqrt(s_uu[i] * s_dd[i]) * (2 * utils::random<double>() - 1);
+    }
+
+    std::vector<std::vector<double>> out(6, std::vector<double>(n__));
+    std::vector<std::vector<double>> out_ref(6, std::vector<double>(n__));
+    int nout{0};
+    if (num_spins__ == 1) {
+        std::vector<double> rho(n__), sigma(n__);
+        for (int i = 0; i < n__; i++) {
+            rho[i]   = rho_up[i] + rho_dn[i];
+            sigma[i] = s_uu[i] + 2 * s_ud[i] + s_dd[i];
+        }
+        if (xc.is_lda()) {
+            xc.get_lda(n__, rho.data(), out[0].data(), out[1].data());
+            ref.get_lda(n__, rho.data(), out_ref[0].data(), out_ref[1].data());
+            nout = 2;
+        } else {
+            xc.get_gga(n__, rho.data(), sigma.data(), out[0].data(), out[1].data(), out[2].data());
+            ref.get_gga(n__, rho.data(), sigma.data(), out_ref[0].data(), out_ref[1].data(), out_ref[2].data());
+            nout = 3;
+        }
+    } else {
+        if (xc.is_lda()) {
+            xc.get_lda(n__, rho_up.data(), rho_dn.data(), out[0].data(), out[1].data(), out[2].data());
+            ref.get_lda(n__, rho_up.data(), rho_dn.data(), out_ref[0].data(), out_ref[1].data(), out_ref[2].data());
+            nout = 3;
+        } else {
+            xc.get_gga(n__, rho_up.data(), rho_dn.data(), s_uu.data(), s_ud.data(), s_dd.data(), out[0].data(),
+                       out[1].data(), out[2].data(), out[3].data(), out[4].data(), out[5].data());
+            ref.get_gga(n__, rho_up.data(), rho_dn.data(), s_uu.data(), s_ud.data(), s_dd.data(), out_ref[0].data(),
+                        out_ref[1].data(), out_ref[2].data(), out_ref[3].data(), out_ref[4].data(), out_ref[5].data());
+            nout = 6;
+        }
+    }
+    double d{0};
+    for (int k = 0; k < nout; k++) {
+        for (int i = 0; i < n__; i++) {
+            if (i % 2) {
+                d = std::max(d, std::abs(out[k][i] - out_ref[k][i]) / std::max(1e-8, std::abs(out_ref[k][i])));
+            } else if (out[k][i] != 0) {
+                printf("%-14s point %i below the threshold is not screened\n", name__.c_str(), i);
+                return 4;
+            }
+        }
+    }
+    printf("%-14s screening (%i spin) : %18.12e\n", name__.c_str(), num_spins__, d);
+
+    return (d > 1e-6) ? 5 : 0;
+}
+
+int main(int argn, char** argv)
+{
+    sirius::initialize(true);
+
+    int err{0};
+    for (auto name : {"XC_LDA_X", "XC_LDA_C_PZ", "XC_LDA_C_PW", "XC_GGA_X_PBE", "XC_GGA_C_PBE"}) {
+        if ((err = test_unpolarized(name, 1000))) {
+            break;
+        }
+        if ((err = test_polarized(name, 1000))) {
+            break;
+        }
+        if ((err = test_screening(name, 1, 1000)) || (err = test_screening(name, 2, 1000))) {
+            break;
+        }
+    }
+
+    sirius::finalize();
+
+    return err;
+}
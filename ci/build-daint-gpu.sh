@@ -23,6 +23,7 @@ mkdir -p build
           -DUSE_CUDA=On \
           -DCMAKE_BUILD_TYPE=RELWITHDEBINFO \
           -DCREATE_PYTHON_MODULE=On \
+          -DBUILD_TESTS=On \
           ../
     make clean
     make -j VERBOSE=1
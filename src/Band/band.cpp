@@ -146,6 +146,9 @@ Band::initialize_subspace(K_point_set& kset__, Hamiltonian0& H0__) const
         N = unit_cell_.num_ps_atomic_wf();
     }
 
+    /* radial integrals of atomic wave-functions are created collectively before the loop over k-points */
+    ctx_.atomic_wf_ri();
+
     for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
         int ik  = kset__.spl_num_kpoints(ikloc);
         auto kp = kset__[ik];
@@ -157,6 +160,8 @@ Band::initialize_subspace(K_point_set& kset__, Hamiltonian0& H0__) const
         }
     }
 
+    ctx_.release_atomic_wf_ri();
+
     /* reset the energies for the iterative solver to do at least two steps */
     for (int ik = 0; ik < kset__.num_kpoints(); ik++) {
         for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
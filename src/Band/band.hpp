@@ -84,6 +84,21 @@ class Band // TODO: Band class is lightweight and in principle can be converted
     //template <typename T>
     //void diag_pseudo_potential_rmm_diis(K_point* kp__, int ispn__, Hamiltonian& H__) const;
 
+    /// Reduce the number of iterations, synchronize and print band energies after the k-point loop.
+    void sync_band_energies(K_point_set& kset__, int num_dav_iter__) const;
+
+    /// Solve a single k-point and record the time of the solver.
+    /** Returns the number of iterations of the iterative solver. */
+    int solve_k_point(K_point_set& kset__, Hamiltonian0& H0__, int ik__) const;
+
+    /// Solve a single k-point with the already created Hamiltonian and record the time of the solver.
+    int solve_k_point(K_point_set& kset__, Hamiltonian_k& Hk__, int ik__) const;
+
+    /// Solve local k-points concurrently by independent teams of OpenMP threads.
+    /** Each team has its own local operator and its own FFT grid buffers; k-points are dispatched to the teams
+     *  dynamically. Band energies are synchronized by the caller after all teams are finished. */
+    int solve_concurrent(K_point_set& kset__, Hamiltonian0& H0__, int num_teams__) const;
+
   public:
     /// Constructor
     Band(Simulation_context& ctx__);
@@ -113,6 +128,12 @@ class Band // TODO: Band class is lightweight and in principle can be converted
     /// Solve \f$ \hat H \psi = E \psi \f$ and find eigen-states of the Hamiltonian.
     void solve(K_point_set& kset__, Hamiltonian0& H0__, bool precompute__) const;
 
+    /// Solve the band eigen-problem along a path of k-points.
+    /** Local k-points are processed in order: the first one starts from the standard subspace guess and each
+     *  following one is seeded with the converged wave-functions of its predecessor. Full-potential case falls
+     *  back to the regular solver. */
+    void solve_k_point_path(K_point_set& kset__, Hamiltonian0& H0__) const;
+
     /// Initialize the subspace for the entire k-point set.
     void initialize_subspace(K_point_set& kset__, Hamiltonian0& H0__) const;
 
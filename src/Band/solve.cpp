@@ -21,8 +21,11 @@
  *
  *   \brief Contains interfaces to the sirius::Band solvers.
  */
+#include <chrono>
+#include <omp.h>
 #include "band.hpp"
 #include "Potential/potential.hpp"
+#include "Hamiltonian/local_operator.hpp"
 
 namespace sirius {
 
@@ -118,27 +121,174 @@ Band::solve(K_point_set& kset__, Hamiltonian0& H0__, bool precompute__) const
         ctx_.message(1, __function_name__, "iterative solver tolerance: %18.12f\n", ctx_.iterative_solver_tolerance());
     }
 
+    /* number of k-points solved concurrently on this rank */
+    int num_teams = std::min(ctx_.control().num_kpoint_teams_, kset__.spl_num_kpoints().local_size());
+    num_teams     = std::min(num_teams, omp_get_max_threads());
+
     int num_dav_iter{0};
     /* solve secular equation and generate wave functions */
+    if (num_teams > 1 && !ctx_.full_potential() && ctx_.processing_unit() == device_t::CPU &&
+        ctx_.comm_band().size() == 1) {
+        num_dav_iter = solve_concurrent(kset__, H0__, num_teams);
+    } else {
+        for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
+            num_dav_iter += solve_k_point(kset__, H0__, kset__.spl_num_kpoints(ikloc));
+        }
+    }
+    sync_band_energies(kset__, num_dav_iter);
+}
+
+int
+Band::solve_k_point(K_point_set& kset__, Hamiltonian0& H0__, int ik__) const
+{
+    auto Hk = H0__(*kset__[ik__]);
+    return solve_k_point(kset__, Hk, ik__);
+}
+
+int
+Band::solve_k_point(K_point_set& kset__, Hamiltonian_k& Hk__, int ik__) const
+{
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    int niter{0};
+
+    if (ctx_.full_potential()) {
+        solve_full_potential(Hk__);
+    } else {
+        if (ctx_.gamma_point() && (ctx_.so_correction() == false)) {
+            niter = solve_pseudo_potential<double>(Hk__);
+        } else {
+            niter = solve_pseudo_potential<double_complex>(Hk__);
+        }
+    }
+    /* time of the solver is used to balance the distribution of k-points */
+    std::chrono::duration<double> t = std::chrono::high_resolution_clock::now() - t0;
+    kset__.solve_time(ik__, t.count());
+
+    return niter;
+}
+
+int
+Band::solve_concurrent(K_point_set& kset__, Hamiltonian0& H0__, int num_teams__) const
+{
+    PROFILE("sirius::Band::solve_concurrent");
+
+    /* number of threads in each team */
+    int nt = std::max(1, omp_get_max_threads() / num_teams__);
+
+    ctx_.message(1, __function_name__, "number of k-point teams: %i, number of threads per team: %i\n",
+                 num_teams__, nt);
+
+    /* H0 is shared by all teams; each team has its own buffers of the local operator and its own FFT grid */
+    std::vector<std::unique_ptr<Local_operator>> local_op_team;
+    std::vector<std::unique_ptr<spfft::Grid>> spfft_grid_team;
+    for (int it = 0; it < num_teams__; it++) {
+        local_op_team.emplace_back(new Local_operator(H0__.local_op()));
+        spfft_grid_team.emplace_back(new spfft::Grid(ctx_.fft_coarse_grid()[0], ctx_.fft_coarse_grid()[1],
+                                                     ctx_.fft_coarse_grid()[2],
+                                                     ctx_.gvec_coarse_partition().zcol_count_fft(), SPFFT_PU_HOST,
+                                                     nt));
+    }
+    /* memory pools are created on the first request; this must not happen inside the parallel region */
+    ctx_.mem_pool(memory_t::host);
+    ctx_.mem_pool(ctx_.host_memory_t());
+
+    int num_dav_iter{0};
+
+    utils::global_rtgraph_timer_suspended = true;
+    omp_set_nested(1);
+    #pragma omp parallel num_threads(num_teams__) reduction(+:num_dav_iter)
+    {
+        int it = omp_get_thread_num();
+        omp_set_num_threads(nt);
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
+            int ik  = kset__.spl_num_kpoints(ikloc);
+            auto kp = kset__[ik];
+
+            /* plans are created and destroyed one at a time because FFTW planner is not thread-safe */
+            std::unique_ptr<spfft::Transform> spfftk;
+            #pragma omp critical(spfft_plan)
+            spfftk.reset(new spfft::Transform(kp->create_spfft_transform(*spfft_grid_team[it])));
+
+            /* k-point uses the transformation on the team grid while it is being solved */
+            std::swap(kp->spfft_transform(), *spfftk);
+            Hamiltonian_k Hk(H0__, *kp, *local_op_team[it]);
+            num_dav_iter += solve_k_point(kset__, Hk, ik);
+            std::swap(kp->spfft_transform(), *spfftk);
+
+            #pragma omp critical(spfft_plan)
+            spfftk.reset();
+        }
+    }
+    omp_set_nested(0);
+    utils::global_rtgraph_timer_suspended = false;
+
+    return num_dav_iter;
+}
+
+void
+Band::solve_k_point_path(K_point_set& kset__, Hamiltonian0& H0__) const
+{
+    PROFILE("sirius::Band::solve_k_point_path");
+
+    if (ctx_.full_potential()) {
+        solve(kset__, H0__, true);
+        return;
+    }
+
+    ctx_.message(1, __function_name__, "iterative solver tolerance: %18.12f\n", ctx_.iterative_solver_tolerance());
+
+    int N{0};
+    if (ctx_.iterative_solver_input().init_subspace_ == "lcao") {
+        /* get the total number of atomic-centered orbitals */
+        N = unit_cell_.num_ps_atomic_wf();
+    }
+
+    bool gamma = ctx_.gamma_point() && (ctx_.so_correction() == false);
+
+    /* radial integrals of atomic wave-functions are created collectively before the loop over k-points;
+       ranks without local k-points must take part as well */
+    ctx_.atomic_wf_ri();
+
+    int num_dav_iter{0};
+    /* k-points are distributed in contiguous blocks, so the previous local k-point is a neighbour on the path */
     for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
         int ik  = kset__.spl_num_kpoints(ikloc);
         auto kp = kset__[ik];
 
         auto Hk = H0__(*kp);
-        if (ctx_.full_potential()) {
-            solve_full_potential(Hk);
-        } else {
-            if (ctx_.gamma_point() && (ctx_.so_correction() == false)) {
-                num_dav_iter += solve_pseudo_potential<double>(Hk);
+        if (ikloc == 0) {
+            if (gamma) {
+                initialize_subspace<double>(Hk, N);
             } else {
-                num_dav_iter += solve_pseudo_potential<double_complex>(Hk);
+                initialize_subspace<double_complex>(Hk, N);
+            }
+            for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+                for (int i = 0; i < ctx_.num_bands(); i++) {
+                    kp->band_energy(i, ispn, 0);
+                    kp->band_occupancy(i, ispn, ctx_.max_occupancy());
+                }
             }
+        } else {
+            kp->init_wave_functions_from(*kset__[kset__.spl_num_kpoints(ikloc - 1)]);
         }
+        num_dav_iter += solve_k_point(kset__, Hk, ik);
     }
-    kset__.comm().allreduce(&num_dav_iter, 1);
+
+    ctx_.release_atomic_wf_ri();
+
+    sync_band_energies(kset__, num_dav_iter);
+}
+
+void
+Band::sync_band_energies(K_point_set& kset__, int num_dav_iter__) const
+{
+    kset__.comm().allreduce(&num_dav_iter__, 1);
     if (!ctx_.full_potential()) {
         ctx_.message(1, __function_name__, "average number of iterations: %12.6f\n",
-                     static_cast<double>(num_dav_iter) / kset__.num_kpoints());
+                     static_cast<double>(num_dav_iter__) / kset__.num_kpoints());
     }
 
     /* synchronize eigen-values */
@@ -29,6 +29,10 @@
 
 namespace sirius {
 
+#if defined(__GPU)
+extern "C" void spherical_harmonics_rlm_gpu(int lmax__, int ntp__, double const* tp__, double* rlm__, int ld__);
+#endif
+
 /// Stores <G+k | beta> expansion
 class Beta_projectors : public Beta_projectors_base
 {
@@ -52,25 +56,68 @@ class Beta_projectors : public Beta_projectors_base
             z[l] = std::pow(double_complex(0, -1), l) * fourpi / std::sqrt(ctx_.unit_cell().omega());
         }
 
+        int lmax  = ctx_.unit_cell().lmax();
+        int lmmax = utils::lmmax(lmax);
+
+        /* G+k vectors with the same length share the radial form factors; if the list of G+k vectors is the
+           local set, the precomputed shells of G+k vectors are used */
+        bool is_local = (num_gkvec_loc() == gkvec_.count());
+        for (int igkloc = 0; is_local && igkloc < num_gkvec_loc(); igkloc++) {
+            is_local = (igk__[igkloc] == gkvec_.offset() + igkloc);
+        }
+        std::vector<int> gk_shell(num_gkvec_loc());
+        std::vector<double> gk_shell_len(is_local ? gkvec_.num_gkvec_shells_local() : num_gkvec_loc());
+        for (int i = 0; is_local && i < gkvec_.num_gkvec_shells_local(); i++) {
+            gk_shell_len[i] = gkvec_.gkvec_shell_len_local(i);
+        }
+        /* spherical coordinates of G+k vectors: theta and phi */
+        mdarray<double, 2> tp(num_gkvec_loc(), 2);
+        #pragma omp parallel for schedule(static)
+        for (int igkloc = 0; igkloc < num_gkvec_loc(); igkloc++) {
+            auto vs = SHT::spherical_coordinates(gkvec_.gkvec_cart<index_domain_t::global>(igk__[igkloc]));
+            tp(igkloc, 0) = vs[1];
+            tp(igkloc, 1) = vs[2];
+            if (is_local) {
+                gk_shell[igkloc] = gkvec_.gkvec_shell_idx_local(igkloc);
+            } else {
+                gk_shell[igkloc]     = igkloc;
+                gk_shell_len[igkloc] = vs[0];
+            }
+        }
+
+        /* get all values of radial integrals once per G+k shell */
+        std::vector<mdarray<double, 2>> ri_val(ctx_.unit_cell().num_atom_types());
+        for (int iat = 0; iat < ctx_.unit_cell().num_atom_types(); iat++) {
+            ri_val[iat] = beta_radial_integrals.values(iat, gk_shell_len);
+        }
+
+        /* compute real spherical harmonics for all G+k vectors */
+        mdarray<double, 2> gkvec_rlm(lmmax, num_gkvec_loc());
+        if (ctx_.processing_unit() == device_t::GPU && num_gkvec_loc()) {
+#if defined(__GPU)
+            tp.allocate(memory_t::device).copy_to(memory_t::device);
+            gkvec_rlm.allocate(memory_t::device);
+            spherical_harmonics_rlm_gpu(lmax, num_gkvec_loc(), tp.at(memory_t::device),
+                                        gkvec_rlm.at(memory_t::device), gkvec_rlm.ld());
+            gkvec_rlm.copy_to(memory_t::host);
+#endif
+        } else {
+            sf::spherical_harmonics(lmax, num_gkvec_loc(), &tp(0, 0), &tp(0, 1), &gkvec_rlm(0, 0), lmmax);
+        }
+
         /* compute <G+k|beta> */
         #pragma omp parallel for
         for (int igkloc = 0; igkloc < num_gkvec_loc(); igkloc++) {
-            int igk = igk__[igkloc];
-            /* vs = {r, theta, phi} */
-            auto vs = SHT::spherical_coordinates(gkvec_.gkvec_cart<index_domain_t::global>(igk));
-            /* compute real spherical harmonics for G+k vector */
-            std::vector<double> gkvec_rlm(utils::lmmax(ctx_.unit_cell().lmax()));
-            sf::spherical_harmonics(ctx_.unit_cell().lmax(), vs[1], vs[2], &gkvec_rlm[0]);
+            int ish = gk_shell[igkloc];
             for (int iat = 0; iat < ctx_.unit_cell().num_atom_types(); iat++) {
                 auto& atom_type = ctx_.unit_cell().atom_type(iat);
-                /* get all values of radial integrals */
-                auto ri_val = beta_radial_integrals.values(iat, vs[0]);
                 for (int xi = 0; xi < atom_type.mt_basis_size(); xi++) {
                     int l     = atom_type.indexb(xi).l;
                     int lm    = atom_type.indexb(xi).lm;
                     int idxrf = atom_type.indexb(xi).idxrf;
 
-                    pw_coeffs_t_(igkloc, atom_type.offset_lo() + xi, 0) = z[l] * gkvec_rlm[lm] * ri_val(idxrf);
+                    pw_coeffs_t_(igkloc, atom_type.offset_lo() + xi, 0) =
+                        z[l] * gkvec_rlm(lm, igkloc) * ri_val[iat](idxrf, ish);
                 }
             }
         }
@@ -92,15 +92,11 @@ void Augmentation_operator::generate_pw_coeffs(Radial_integrals_aug<false> const
 
     PROFILE_START("sirius::Augmentation_operator::generate_pw_coeffs|1");
     sddk::mdarray<double, 3> ri_values(nbrf * (nbrf + 1) / 2, 2 * lmax_beta + 1, gvec_.num_gvec_shells_local(), mp__);
-    #pragma omp parallel for
+    std::vector<double> gsh_len(gvec_.num_gvec_shells_local());
     for (int j = 0; j < gvec_.num_gvec_shells_local(); j++) {
-        auto ri = radial_integrals__.values(atom_type_.id(), gvec_.gvec_shell_len_local(j));
-        for (int l = 0; l <= 2 * lmax_beta; l++) {
-            for (int i = 0; i < nbrf * (nbrf + 1) / 2; i++) {
-                ri_values(i, l, j) = ri(i, l);
-            }
-        }
+        gsh_len[j] = gvec_.gvec_shell_len_local(j);
     }
+    radial_integrals__.values(atom_type_.id(), gvec_.num_gvec_shells_local(), gsh_len.data(), ri_values);
     PROFILE_STOP("sirius::Augmentation_operator::generate_pw_coeffs|1");
 
     /* number of beta-projectors */
@@ -1281,8 +1281,13 @@ mdarray<double_complex, 2> Density::generate_rho_aug()
         }
         /* treat auxiliary array as double with x2 size */
         mdarray<double, 2> dm_pw(nbf * (nbf + 1) / 2, spl_ngv_loc.local_size() * 2, ctx_.mem_pool(memory_t::host));
-        mdarray<double, 2> phase_factors(atom_type.num_atoms(), spl_ngv_loc.local_size() * 2,
-                                         ctx_.mem_pool(memory_t::host));
+        /* cached phase factors are used directly as the second operand of GEMM */
+        bool use_pf_cache = (ctx_.processing_unit() == device_t::CPU) && ctx_.phase_factors_cached();
+        mdarray<double, 2> phase_factors;
+        if (!use_pf_cache) {
+            phase_factors = mdarray<double, 2>(atom_type.num_atoms(), spl_ngv_loc.local_size() * 2,
+                                               ctx_.mem_pool(memory_t::host));
+        }
 
         ctx_.print_memory_usage(__FILE__, __LINE__);
 
@@ -1306,22 +1311,32 @@ mdarray<double_complex, 2> Density::generate_rho_aug()
 
             switch (ctx_.processing_unit()) {
                 case device_t::CPU: {
-                    #pragma omp parallel for schedule(static)
-                    for (int igloc = g_begin; igloc < g_end; igloc++) {
-                        int ig = ctx_.gvec().offset() + igloc;
-                        for (int i = 0; i < atom_type.num_atoms(); i++) {
-                            int ia                                      = atom_type.atom_id(i);
-                            double_complex z                            = std::conj(ctx_.gvec_phase_factor(ig, ia));
-                            phase_factors(i, 2 * (igloc - g_begin))     = z.real();
-                            phase_factors(i, 2 * (igloc - g_begin) + 1) = z.imag();
+                    if (!use_pf_cache) {
+                        #pragma omp parallel for schedule(static)
+                        for (int igloc = g_begin; igloc < g_end; igloc++) {
+                            for (int i = 0; i < atom_type.num_atoms(); i++) {
+                                double_complex z = std::conj(ctx_.gvec_phase_factor_loc(igloc, iat, i));
+                                phase_factors(i, 2 * (igloc - g_begin))     = z.real();
+                                phase_factors(i, 2 * (igloc - g_begin) + 1) = z.imag();
+                            }
                         }
                     }
                     for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
                         PROFILE_START("sirius::Density::generate_rho_aug|gemm");
-                        linalg(linalg_t::blas).gemm('N', 'N', nbf * (nbf + 1) / 2, 2 * spl_ngv_loc.local_size(ib),
-                            atom_type.num_atoms(), &linalg_const<double>::one(), dm.at(memory_t::host, 0, 0, iv),
-                            dm.ld(), phase_factors.at(memory_t::host), phase_factors.ld(),
-                            &linalg_const<double>::zero(), dm_pw.at(memory_t::host, 0, 0), dm_pw.ld());
+                        if (use_pf_cache) {
+                            /* density matrix is real, so the product with exp(iGr) gives the complex conjugate of
+                               dm_pw; conjugation is done in the sum below */
+                            auto& pf = ctx_.phase_factors_cache(iat);
+                            linalg(linalg_t::blas).gemm('N', 'T', nbf * (nbf + 1) / 2, 2 * spl_ngv_loc.local_size(ib),
+                                atom_type.num_atoms(), &linalg_const<double>::one(), dm.at(memory_t::host, 0, 0, iv),
+                                dm.ld(), reinterpret_cast<double const*>(pf.at(memory_t::host, g_begin, 0)),
+                                2 * pf.ld(), &linalg_const<double>::zero(), dm_pw.at(memory_t::host, 0, 0), dm_pw.ld());
+                        } else {
+                            linalg(linalg_t::blas).gemm('N', 'N', nbf * (nbf + 1) / 2, 2 * spl_ngv_loc.local_size(ib),
+                                atom_type.num_atoms(), &linalg_const<double>::one(), dm.at(memory_t::host, 0, 0, iv),
+                                dm.ld(), phase_factors.at(memory_t::host), phase_factors.ld(),
+                                &linalg_const<double>::zero(), dm_pw.at(memory_t::host, 0, 0), dm_pw.ld());
+                        }
                         PROFILE_STOP("sirius::Density::generate_rho_aug|gemm");
                         PROFILE_START("sirius::Density::generate_rho_aug|sum");
                         #pragma omp parallel for
@@ -1332,6 +1347,9 @@ mdarray<double_complex, 2> Density::generate_rho_aug()
                                 double_complex z1 = double_complex(ctx_.augmentation_op(iat)->q_pw(i, 2 * igloc),
                                                                    ctx_.augmentation_op(iat)->q_pw(i, 2 * igloc + 1));
                                 double_complex z2(dm_pw(i, 2 * (igloc - g_begin)), dm_pw(i, 2 * (igloc - g_begin) + 1));
+                                if (use_pf_cache) {
+                                    z2 = std::conj(z2);
+                                }
 
                                 zsum += z1 * z2 * ctx_.augmentation_op(iat)->sym_weight(i);
                             }
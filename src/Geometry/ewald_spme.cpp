@@ -0,0 +1,225 @@
+// Copyright (c) 2013-2019 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file ewald_spme.cpp
+ *
+ *  \brief Contains implementation of sirius::Ewald_spme class.
+ */
+
+#include "ewald_spme.hpp"
+
+namespace sirius {
+
+/// Wrap grid coordinate into the [0, k) interval.
+static inline int wrap_coord(int i__, int k__)
+{
+    i__ %= k__;
+    return (i__ < 0) ? i__ + k__ : i__;
+}
+
+void Ewald_spme::bspline(int n__, double w__, double* val__, double* der__)
+{
+    /* values of B-spline of order 2: M_2(w) = w, M_2(w + 1) = 1 - w */
+    std::vector<double> c(n__, 0);
+    c[0] = w__;
+    c[1] = 1 - w__;
+    for (int k = 2; k < n__; k++) {
+        if (k == n__ - 1) {
+            /* derivative of M_n is expressed through M_{n-1}: M_n'(x) = M_{n-1}(x) - M_{n-1}(x - 1) */
+            for (int j = 0; j < n__; j++) {
+                der__[j] = ((j < k) ? c[j] : 0) - ((j > 0) ? c[j - 1] : 0);
+            }
+        }
+        /* M_{k+1}(x) = (x M_k(x) + (k + 1 - x) M_k(x - 1)) / k */
+        for (int j = k; j >= 0; j--) {
+            double x = w__ + j;
+            c[j] = (((j < k) ? x * c[j] : 0) + ((j > 0) ? (k + 1 - x) * c[j - 1] : 0)) / k;
+        }
+    }
+    for (int j = 0; j < n__; j++) {
+        val__[j] = c[j];
+    }
+}
+
+Ewald_spme::Ewald_spme(Simulation_context& ctx__, int order__)
+    : ctx_(ctx__)
+    , order_(order__)
+    , alpha_(ctx__.ewald_lambda())
+    , q_(ctx__.spfft(), ctx__.gvec_partition())
+{
+    PROFILE("sirius::Ewald_spme");
+
+    if (order_ < 4 || order_ % 2) {
+        std::stringstream s;
+        s << "wrong order of B-splines for particle-mesh Ewald summation: " << order_ << std::endl
+          << "  order must be even and not smaller than 4";
+        TERMINATE(s);
+    }
+
+    auto& fft_grid = ctx_.fft_grid();
+
+    /* squared modulus of the exponential spline factors along each direction */
+    std::vector<double> m(order_), dm(order_);
+    bspline(order_, 0, m.data(), dm.data());
+    std::array<std::vector<double>, 3> bmod;
+    for (int x : {0, 1, 2}) {
+        int k = fft_grid[x];
+        bmod[x].resize(k);
+        for (int i = 0; i < k; i++) {
+            double_complex z(0, 0);
+            for (int j = 0; j < order_ - 1; j++) {
+                z += m[j + 1] * std::exp(double_complex(0, twopi * i * j / k));
+            }
+            bmod[x][i] = 1.0 / std::norm(z);
+        }
+    }
+
+    bsp_mod_ = mdarray<double, 1>(ctx_.gvec().count());
+    #pragma omp parallel for schedule(static)
+    for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+        int ig = ctx_.gvec().offset() + igloc;
+        if (!ig) {
+            bsp_mod_[igloc] = 0;
+            continue;
+        }
+        auto G = ctx_.gvec().gvec(ig);
+        bsp_mod_[igloc] = 1;
+        for (int x : {0, 1, 2}) {
+            bsp_mod_[igloc] *= bmod[x][wrap_coord(G[x], fft_grid[x])];
+        }
+    }
+
+    spread_charges();
+}
+
+void Ewald_spme::spread_charges()
+{
+    PROFILE("sirius::Ewald_spme::spread_charges");
+
+    auto& uc       = ctx_.unit_cell();
+    auto& fft_grid = ctx_.fft_grid();
+    int z_off      = ctx_.spfft().local_z_offset();
+    int z_len      = ctx_.spfft().local_z_length();
+
+    base_ = mdarray<int, 2>(3, uc.num_atoms());
+    w_    = mdarray<double, 3>(order_, 3, uc.num_atoms());
+    dw_   = mdarray<double, 3>(order_, 3, uc.num_atoms());
+
+    #pragma omp parallel for schedule(static)
+    for (int ia = 0; ia < uc.num_atoms(); ia++) {
+        auto pos = uc.atom(ia).position();
+        for (int x : {0, 1, 2}) {
+            double u      = pos[x] * fft_grid[x];
+            double fl     = std::floor(u);
+            base_(x, ia)  = static_cast<int>(fl);
+            bspline(order_, u - fl, &w_(0, x, ia), &dw_(0, x, ia));
+        }
+    }
+
+    for (int ir = 0; ir < ctx_.spfft().local_slice_size(); ir++) {
+        q_.f_rg(ir) = 0;
+    }
+
+    /* point (base - j) of the grid gets the weight M_n(w + j); only local z-planes are updated */
+    for (int ia = 0; ia < uc.num_atoms(); ia++) {
+        double zn = uc.atom(ia).zn();
+        for (int j2 = 0; j2 < order_; j2++) {
+            int z = wrap_coord(base_(2, ia) - j2, fft_grid[2]) - z_off;
+            if (z < 0 || z >= z_len) {
+                continue;
+            }
+            for (int j1 = 0; j1 < order_; j1++) {
+                int y      = wrap_coord(base_(1, ia) - j1, fft_grid[1]);
+                double w12 = zn * w_(j1, 1, ia) * w_(j2, 2, ia);
+                for (int j0 = 0; j0 < order_; j0++) {
+                    int x = wrap_coord(base_(0, ia) - j0, fft_grid[0]);
+                    q_.f_rg(fft_grid.index_by_coord(x, y, z)) += w_(j0, 0, ia) * w12;
+                }
+            }
+        }
+    }
+
+    q_.fft_transform(-1);
+}
+
+mdarray<double, 2> Ewald_spme::forces()
+{
+    PROFILE("sirius::Ewald_spme::forces");
+
+    auto& uc       = ctx_.unit_cell();
+    auto& fft_grid = ctx_.fft_grid();
+    int z_off      = ctx_.spfft().local_z_offset();
+    int z_len      = ctx_.spfft().local_z_length();
+    double n       = static_cast<double>(fft_grid.num_points());
+
+    /* potential of the charge mesh: phi(r) = sum_G C(G) Q(G) e^{-iGr}, such that dE/dQ(r) = 2 phi(r) */
+    Smooth_periodic_function<double> phi(ctx_.spfft(), ctx_.gvec_partition());
+    #pragma omp parallel for schedule(static)
+    for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+        int ig = ctx_.gvec().offset() + igloc;
+        if (!ig) {
+            phi.f_pw_local(igloc) = 0;
+            continue;
+        }
+        double g2 = std::pow(ctx_.gvec().gvec_len(ig), 2);
+        double c  = (twopi / uc.omega()) * bsp_mod_[igloc] * std::exp(-g2 / 4 / alpha_) / g2;
+        phi.f_pw_local(igloc) = n * c * q_.f_pw_local(igloc);
+    }
+    phi.fft_transform(1);
+
+    mdarray<double, 2> forces(3, uc.num_atoms());
+    forces.zero();
+
+    #pragma omp parallel for schedule(static)
+    for (int ia = 0; ia < uc.num_atoms(); ia++) {
+        /* derivative of energy with respect to the scaled fractional coordinates u = K x */
+        vector3d<double> de(0, 0, 0);
+        for (int j2 = 0; j2 < order_; j2++) {
+            int z = wrap_coord(base_(2, ia) - j2, fft_grid[2]) - z_off;
+            if (z < 0 || z >= z_len) {
+                continue;
+            }
+            for (int j1 = 0; j1 < order_; j1++) {
+                int y = wrap_coord(base_(1, ia) - j1, fft_grid[1]);
+                for (int j0 = 0; j0 < order_; j0++) {
+                    int x    = wrap_coord(base_(0, ia) - j0, fft_grid[0]);
+                    double p = phi.f_rg(fft_grid.index_by_coord(x, y, z));
+                    de[0] += p * dw_(j0, 0, ia) * w_(j1, 1, ia) * w_(j2, 2, ia);
+                    de[1] += p * w_(j0, 0, ia) * dw_(j1, 1, ia) * w_(j2, 2, ia);
+                    de[2] += p * w_(j0, 0, ia) * w_(j1, 1, ia) * dw_(j2, 2, ia);
+                }
+            }
+        }
+        for (int x : {0, 1, 2}) {
+            de[x] *= 2 * uc.atom(ia).zn() * fft_grid[x];
+        }
+        /* transform to Cartesian derivatives: x = L^{-1} r */
+        for (int x : {0, 1, 2}) {
+            for (int k : {0, 1, 2}) {
+                forces(x, ia) -= de[k] * uc.inverse_lattice_vectors()(k, x);
+            }
+        }
+    }
+    /* real-space mesh is split between the ranks of the FFT communicator */
+    ctx_.comm_fft().allreduce(&forces(0, 0), 3 * uc.num_atoms());
+
+    return forces;
+}
+
+} // namespace sirius
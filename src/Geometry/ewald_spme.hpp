@@ -0,0 +1,104 @@
+// Copyright (c) 2013-2019 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file ewald_spme.hpp
+ *
+ *  \brief Contains definition of sirius::Ewald_spme class.
+ */
+
+#ifndef __EWALD_SPME_HPP__
+#define __EWALD_SPME_HPP__
+
+#include "simulation_context.hpp"
+#include "smooth_periodic_function.hpp"
+
+namespace sirius {
+
+/// Smooth particle-mesh Ewald summation of the G-space part of the ion-ion interaction.
+/** Point charges of the ions are interpolated on the fine-grained FFT grid with the cardinal B-splines
+    \f$ M_n \f$ of order \f$ n \f$:
+    \f[
+      Q({\bf k}) = \sum_{\alpha} Z_{\alpha} \prod_{i=1}^{3} M_n(u_{\alpha i} - k_i), \quad
+      u_{\alpha i} = K_i x_{\alpha i}
+    \f]
+    where \f$ x_{\alpha i} \f$ are the fractional coordinates of atoms and \f$ K_i \f$ are the dimensions of the
+    FFT grid. The ionic structure factor is then approximated by
+    \f[
+      S({\bf G}) = \sum_{\alpha} Z_{\alpha} e^{i {\bf G} {\bf r}_{\alpha}} \approx b({\bf G}) \hat Q({\bf G})
+    \f]
+    where \f$ \hat Q \f$ is the Fourier transform of the charge mesh and \f$ b({\bf G}) \f$ are the Euler
+    exponential spline factors (see U. Essmann et al., J. Chem. Phys. 103, 8577 (1995)). The cost of the
+    structure factor drops from \f$ O(N_G N_{atoms}) \f$ to \f$ O(N_{atoms} n^3 + N_G \log N_G) \f$.
+
+    The charge mesh depends only on the fractional coordinates of atoms, so the strain derivative of the
+    SPME energy is given by the same expression as the exact one with \f$ |S({\bf G})|^2 \f$ replaced by
+    its mesh approximation. Forces are obtained by the back-interpolation of the convolved mesh potential
+    with the derivatives of B-splines.
+ */
+class Ewald_spme
+{
+  private:
+    /// Simulation context.
+    Simulation_context& ctx_;
+
+    /// Order of B-splines.
+    int order_;
+
+    /// Ewald parameter.
+    double alpha_;
+
+    /// Base grid coordinate of each atom along each direction.
+    mdarray<int, 2> base_;
+
+    /// Values of B-splines for each atom along each direction.
+    mdarray<double, 3> w_;
+
+    /// Derivatives of B-splines for each atom along each direction.
+    mdarray<double, 3> dw_;
+
+    /// Squared modulus of the exponential spline factors for the local set of G-vectors.
+    mdarray<double, 1> bsp_mod_;
+
+    /// Charge mesh.
+    Smooth_periodic_function<double> q_;
+
+    /// Compute values and derivatives of cardinal B-splines of order n at the points w + j, j = 0..n-1.
+    static void bspline(int n__, double w__, double* val__, double* der__);
+
+    /// Interpolate charges on the FFT grid and compute the plane-wave coefficients of the charge mesh.
+    void spread_charges();
+
+  public:
+    /// Constructor.
+    Ewald_spme(Simulation_context& ctx__, int order__);
+
+    /// Squared modulus of the ionic structure factor for the local G-vector.
+    inline double structure_factor_sq(int igloc__) const
+    {
+        double n = static_cast<double>(ctx_.fft_grid().num_points());
+        return bsp_mod_[igloc__] * std::norm(n * q_.f_pw_local(igloc__));
+    }
+
+    /// Compute G-space contribution to the Ewald forces.
+    mdarray<double, 2> forces();
+};
+
+} // namespace sirius
+
+#endif // __EWALD_SPME_HPP__
@@ -23,6 +23,7 @@
  */
 
 #include "force.hpp"
+#include "stress.hpp"
 #include "K_point/k_point.hpp"
 #include "K_point/k_point_set.hpp"
 #include "Density/density.hpp"
@@ -30,7 +31,9 @@
 #include "Potential/potential.hpp"
 #include "Beta_projectors/beta_projectors.hpp"
 #include "Beta_projectors/beta_projectors_gradient.hpp"
+#include "Beta_projectors/beta_projectors_strain_deriv.hpp"
 #include "non_local_functor.hpp"
+#include "ewald_spme.hpp"
 #include "Hamiltonian/hamiltonian.hpp"
 
 namespace sirius {
@@ -46,7 +49,7 @@ Force::Force(Simulation_context& ctx__, Density& density__, Potential& potential
 }
 
 template <typename T>
-void Force::add_k_point_contribution(K_point& kpoint, mdarray<double, 2>& forces__) const
+void Force::add_k_point_contribution(K_point& kpoint, mdarray<double, 2>& forces__, mdarray<double, 2>* stress__) const
 {
     /* if there are no beta projectors then get out there */
     if (ctx_.unit_cell().mt_lo_basis_size() == 0) {
@@ -54,6 +57,11 @@ void Force::add_k_point_contribution(K_point& kpoint, mdarray<double, 2>& forces
     }
 
     Beta_projectors_gradient bp_grad(ctx_, kpoint.gkvec(), kpoint.igk_loc(), kpoint.beta_projectors());
+    std::unique_ptr<Beta_projectors_strain_deriv> bp_strain_deriv;
+    if (stress__) {
+        bp_strain_deriv = std::unique_ptr<Beta_projectors_strain_deriv>(
+            new Beta_projectors_strain_deriv(ctx_, kpoint.gkvec(), kpoint.igk_loc()));
+    }
     if (is_device_memory(ctx_.preferred_memory_t())) {
         int nbnd = ctx_.num_bands();
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
@@ -63,9 +71,15 @@ void Force::add_k_point_contribution(K_point& kpoint, mdarray<double, 2>& forces
         }
     }
 
-    Non_local_functor<T> nlf(ctx_, bp_grad);
-
-    nlf.add_k_point_contribution(kpoint, forces__);
+    if (stress__) {
+        /* <beta|psi> is shared between gradient and strain derivative of beta-projectors */
+        Non_local_functor<T> nlf(ctx_, {&bp_grad, bp_strain_deriv.get()});
+        std::vector<mdarray<double, 2>*> collect_res({&forces__, stress__});
+        nlf.add_k_point_contribution(kpoint, collect_res);
+    } else {
+        Non_local_functor<T> nlf(ctx_, bp_grad);
+        nlf.add_k_point_contribution(kpoint, forces__);
+    }
     if (is_device_memory(ctx_.preferred_memory_t())) {
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
             /* deallocate GPU memory */
@@ -126,6 +140,24 @@ void Force::compute_dmat(K_point* kp__, dmatrix<double_complex>& dm__) const
 }
 
 mdarray<double, 2> const& Force::calc_forces_total()
+{
+    if (!ctx_.full_potential()) {
+        calc_forces_nonloc();
+    }
+    return calc_forces_total_reuse_nonloc();
+}
+
+mdarray<double, 2> const& Force::calc_forces_stress_total(Stress& stress__)
+{
+    if (ctx_.full_potential()) {
+        TERMINATE("stress tensor is not implemented for the full-potential method");
+    }
+    calc_forces_stress_nonloc(stress__);
+    stress__.calc_stress_total_reuse_nonloc();
+    return calc_forces_total_reuse_nonloc();
+}
+
+mdarray<double, 2> const& Force::calc_forces_total_reuse_nonloc()
 {
     forces_total_ = mdarray<double, 2>(3, ctx_.unit_cell().num_atoms());
     if (ctx_.full_potential()) {
@@ -140,7 +172,6 @@ mdarray<double, 2> const& Force::calc_forces_total()
     } else {
         calc_forces_vloc();
         calc_forces_us();
-        calc_forces_nonloc();
         calc_forces_core();
         calc_forces_ewald();
         calc_forces_scf_corr();
@@ -281,49 +312,54 @@ mdarray<double, 2> const& Force::calc_forces_ewald()
 
     double alpha = ctx_.ewald_lambda();
 
-    double prefac = (ctx_.gvec().reduced() ? 4.0 : 2.0) * (twopi / unit_cell.omega());
+    if (ctx_.settings().ewald_spme_) {
+        Ewald_spme spme(ctx_, ctx_.settings().ewald_spme_order_);
+        forces_ewald_ = spme.forces();
+    } else {
+        double prefac = (ctx_.gvec().reduced() ? 4.0 : 2.0) * (twopi / unit_cell.omega());
 
-    int ig0{0};
-    if (ctx_.comm().rank() == 0) {
-        ig0 = 1;
-    }
+        int ig0{0};
+        if (ctx_.comm().rank() == 0) {
+            ig0 = 1;
+        }
 
-    mdarray<double_complex, 1> rho_tmp(ctx_.gvec().count());
-    rho_tmp.zero();
-    #pragma omp parallel for schedule(static)
-    for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
-        int ig = ctx_.gvec().offset() + igloc;
+        mdarray<double_complex, 1> rho_tmp(ctx_.gvec().count());
+        rho_tmp.zero();
+        #pragma omp parallel for schedule(static)
+        for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
+            int ig = ctx_.gvec().offset() + igloc;
 
-        double_complex rho(0, 0);
+            double_complex rho(0, 0);
 
-        for (int ja = 0; ja < unit_cell.num_atoms(); ja++) {
-            rho += ctx_.gvec_phase_factor(ig, ja) * static_cast<double>(unit_cell.atom(ja).zn());
-        }
+            for (int ja = 0; ja < unit_cell.num_atoms(); ja++) {
+                rho += ctx_.gvec_phase_factor(ig, ja) * static_cast<double>(unit_cell.atom(ja).zn());
+            }
 
-        rho_tmp[igloc] = std::conj(rho);
-    }
+            rho_tmp[igloc] = std::conj(rho);
+        }
 
-    #pragma omp parallel for
-    for (int ja = 0; ja < unit_cell.num_atoms(); ja++) {
-        for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
-            int ig = ctx_.gvec().offset() + igloc;
+        #pragma omp parallel for
+        for (int ja = 0; ja < unit_cell.num_atoms(); ja++) {
+            for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
+                int ig = ctx_.gvec().offset() + igloc;
 
-            double g2 = std::pow(ctx_.gvec().gvec_len(ig), 2);
+                double g2 = std::pow(ctx_.gvec().gvec_len(ig), 2);
 
-            /* cartesian form for getting cartesian force components */
-            vector3d<double> gvec_cart = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
-            double_complex rho(0, 0);
+                /* cartesian form for getting cartesian force components */
+                vector3d<double> gvec_cart = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
+                double_complex rho(0, 0);
 
-            double scalar_part = prefac * (rho_tmp[igloc] * ctx_.gvec_phase_factor(ig, ja)).imag() *
-                                 static_cast<double>(unit_cell.atom(ja).zn()) * std::exp(-g2 / (4 * alpha)) / g2;
+                double scalar_part = prefac * (rho_tmp[igloc] * ctx_.gvec_phase_factor(ig, ja)).imag() *
+                                     static_cast<double>(unit_cell.atom(ja).zn()) * std::exp(-g2 / (4 * alpha)) / g2;
 
-            for (int x : {0, 1, 2}) {
-                forces_ewald_(x, ja) += scalar_part * gvec_cart[x];
+                for (int x : {0, 1, 2}) {
+                    forces_ewald_(x, ja) += scalar_part * gvec_cart[x];
+                }
             }
         }
-    }
 
-    ctx_.comm().allreduce(&forces_ewald_(0, 0), 3 * ctx_.unit_cell().num_atoms());
+        ctx_.comm().allreduce(&forces_ewald_(0, 0), 3 * ctx_.unit_cell().num_atoms());
+    }
 
     double invpi = 1. / pi;
 
@@ -395,37 +431,67 @@ mdarray<double, 2> const& Force::calc_forces_us()
         /* get auxiliary density matrix */
         auto dm = density_.density_matrix_aux(iat);
 
-        mdarray<double, 2> v_tmp(atom_type.num_atoms(), ctx_.gvec().count() * 2, *mp);
+        /* cached phase factors are used directly as the second operand of GEMM; i * G * Veff^{*}(G) is then moved
+           to Q(G) */
+        bool use_pf_cache = ctx_.phase_factors_cached();
+
+        mdarray<double, 2> v_tmp;
+        if (use_pf_cache) {
+            v_tmp = mdarray<double, 2>(nbf * (nbf + 1) / 2, ctx_.gvec().count() * 2, *mp);
+        } else {
+            v_tmp = mdarray<double, 2>(atom_type.num_atoms(), ctx_.gvec().count() * 2, *mp);
+        }
         mdarray<double, 2> tmp(nbf * (nbf + 1) / 2, atom_type.num_atoms(), *mp);
 
         /* over spin components, can be from 1 to 4*/
         for (int ispin = 0; ispin < ctx_.num_mag_dims() + 1; ispin++) {
             /* over 3 components of the force/G - vectors */
             for (int ivec = 0; ivec < 3; ivec++) {
-                /* over local rank G vectors */
-                #pragma omp parallel for schedule(static)
-                for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
-                    int ig   = ctx_.gvec().offset() + igloc;
-                    auto gvc = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
-                    for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
-                        /* here we write in v_tmp  -i * G * exp[ iGRn] Veff(G)
-                         * but in formula we have   i * G * exp[-iGRn] Veff*(G)
-                         * the differences because we unfold complex array in the real one
-                         * and need negative imagine part due to a multiplication law of complex numbers */
-                        auto z = double_complex(0, -gvc[ivec]) * ctx_.gvec_phase_factor(ig, atom_type.atom_id(ia)) *
-                                 potential_.component(ispin).f_pw_local(igloc);
-                        v_tmp(ia, 2 * igloc)     = z.real();
-                        v_tmp(ia, 2 * igloc + 1) = z.imag();
+                if (use_pf_cache) {
+                    #pragma omp parallel for schedule(static)
+                    for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+                        auto gvc = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
+                        /* Q(G) * (-i * G * Veff(G))^{*} */
+                        auto v = std::conj(double_complex(0, -gvc[ivec]) *
+                                           potential_.component(ispin).f_pw_local(igloc));
+                        for (int i = 0; i < nbf * (nbf + 1) / 2; i++) {
+                            auto z = double_complex(aug_op->q_pw(i, 2 * igloc), aug_op->q_pw(i, 2 * igloc + 1)) * v;
+                            v_tmp(i, 2 * igloc)     = z.real();
+                            v_tmp(i, 2 * igloc + 1) = z.imag();
+                        }
+                    }
+                    auto& pf = ctx_.phase_factors_cache(iat);
+                    linalg(la).gemm('N', 'N', nbf * (nbf + 1) / 2, atom_type.num_atoms(), 2 * ctx_.gvec().count(),
+                        &linalg_const<double>::one(),
+                        v_tmp.at(memory_t::host), v_tmp.ld(),
+                        reinterpret_cast<double const*>(pf.at(memory_t::host)), 2 * pf.ld(),
+                        &linalg_const<double>::zero(),
+                        tmp.at(memory_t::host), tmp.ld());
+                } else {
+                    /* over local rank G vectors */
+                    #pragma omp parallel for schedule(static)
+                    for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+                        auto gvc = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
+                        for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
+                            /* here we write in v_tmp  -i * G * exp[ iGRn] Veff(G)
+                             * but in formula we have   i * G * exp[-iGRn] Veff*(G)
+                             * the differences because we unfold complex array in the real one
+                             * and need negative imagine part due to a multiplication law of complex numbers */
+                            auto z = double_complex(0, -gvc[ivec]) * ctx_.gvec_phase_factor_loc(igloc, iat, ia) *
+                                     potential_.component(ispin).f_pw_local(igloc);
+                            v_tmp(ia, 2 * igloc)     = z.real();
+                            v_tmp(ia, 2 * igloc + 1) = z.imag();
+                        }
                     }
-                }
 
-                /* multiply tmp matrices, or sum over G */
-                linalg(la).gemm('N', 'T', nbf * (nbf + 1) / 2, atom_type.num_atoms(), 2 * ctx_.gvec().count(),
-                    &linalg_const<double>::one(),
-                    aug_op->q_pw().at(memory_t::host), aug_op->q_pw().ld(),
-                    v_tmp.at(memory_t::host), v_tmp.ld(),
-                    &linalg_const<double>::zero(),
-                    tmp.at(memory_t::host), tmp.ld());
+                    /* multiply tmp matrices, or sum over G */
+                    linalg(la).gemm('N', 'T', nbf * (nbf + 1) / 2, atom_type.num_atoms(), 2 * ctx_.gvec().count(),
+                        &linalg_const<double>::one(),
+                        aug_op->q_pw().at(memory_t::host), aug_op->q_pw().ld(),
+                        v_tmp.at(memory_t::host), v_tmp.ld(),
+                        &linalg_const<double>::zero(),
+                        tmp.at(memory_t::host), tmp.ld());
+                }
 
                 #pragma omp parallel for
                 for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
@@ -860,6 +926,40 @@ mdarray<double, 2> const& Force::calc_forces_nonloc()
     return forces_nonloc_;
 }
 
+mdarray<double, 2> const& Force::calc_forces_stress_nonloc(Stress& stress__)
+{
+    PROFILE("sirius::Force::calc_forces_stress_nonloc");
+
+    forces_nonloc_ = mdarray<double, 2>(3, ctx_.unit_cell().num_atoms());
+    forces_nonloc_.zero();
+
+    mdarray<double, 2> collect_result(9, ctx_.unit_cell().num_atoms());
+    collect_result.zero();
+
+    auto& spl_num_kp = kset_.spl_num_kpoints();
+
+    /* radial integrals are created collectively before the loop over k-points */
+    ctx_.beta_ri_djl();
+
+    for (int ikploc = 0; ikploc < spl_num_kp.local_size(); ikploc++) {
+        K_point* kp = kset_[spl_num_kp[ikploc]];
+
+        if (ctx_.gamma_point()) {
+            add_k_point_contribution<double>(*kp, forces_nonloc_, &collect_result);
+        } else {
+            add_k_point_contribution<double_complex>(*kp, forces_nonloc_, &collect_result);
+        }
+    }
+
+    ctx_.comm().allreduce(&forces_nonloc_(0, 0), 3 * ctx_.unit_cell().num_atoms());
+
+    symmetrize(forces_nonloc_);
+
+    stress__.set_stress_nonloc(collect_result);
+
+    return forces_nonloc_;
+}
+
 void Force::print_info()
 {
     if (ctx_.comm().rank() == 0) {
@@ -35,6 +35,7 @@ class Potential;
 class K_point;
 class K_point_set;
 class Hamiltonian_k;
+class Stress;
 
 /// Compute atomic forces.
 class Force
@@ -72,8 +73,15 @@ class Force
 
     sddk::mdarray<double, 2> forces_total_;
 
+    /// Add k-point contribution to the non-local forces.
+    /** If stress__ is not null, the strain-derivative terms of the non-local stress are accumulated in the same
+        pass over chunks of beta-projectors. */
     template <typename T>
-    void add_k_point_contribution(K_point& kp__, sddk::mdarray<double, 2>& forces__) const;
+    void add_k_point_contribution(K_point& kp__, sddk::mdarray<double, 2>& forces__,
+                                  sddk::mdarray<double, 2>* stress__ = nullptr) const;
+
+    /// Compute all contributions to forces except the non-local one and sum them.
+    sddk::mdarray<double, 2> const& calc_forces_total_reuse_nonloc();
 
     void symmetrize(sddk::mdarray<double, 2>& forces__) const;
 
@@ -112,6 +120,12 @@ class Force
 
     sddk::mdarray<double, 2> const& calc_forces_nonloc();
 
+    /// Compute non-local contributions to forces and stress tensor in a single pass over k-points.
+    /** Wave-functions are copied to the device once per k-point and <beta|psi> is computed once per chunk of
+        atoms; it is reused for the 3 gradient and the 9 strain-derivative projections. The stress contribution
+        is stored in stress__. */
+    sddk::mdarray<double, 2> const& calc_forces_stress_nonloc(Stress& stress__);
+
     inline sddk::mdarray<double, 2> const& forces_nonloc() const
     {
         return forces_nonloc_;
@@ -177,6 +191,11 @@ class Force
 
     sddk::mdarray<double, 2> const& calc_forces_total();
 
+    /// Compute total forces and total stress tensor.
+    /** Non-local contributions to both quantities are computed in a single pass over k-points. This is used in
+        variable-cell relaxations where forces and stress are required at each ionic step. */
+    sddk::mdarray<double, 2> const& calc_forces_stress_total(Stress& stress__);
+
     inline sddk::mdarray<double, 2> const& forces_total() const
     {
         return forces_total_;
@@ -37,17 +37,33 @@ class Non_local_functor
 {
   private:
     Simulation_context& ctx_;
-    Beta_projectors_base& bp_base_;
+    /// List of derivatives of beta-projectors (gradient, strain derivative).
+    std::vector<Beta_projectors_base*> bp_base_;
   public:
 
     Non_local_functor(Simulation_context& ctx__, Beta_projectors_base& bp_base__)
+        : ctx_(ctx__)
+        , bp_base_({&bp_base__})
+    {
+    }
+
+    /// Constructor for several types of beta-projector derivatives sharing the same <beta|psi>.
+    Non_local_functor(Simulation_context& ctx__, std::vector<Beta_projectors_base*> bp_base__)
         : ctx_(ctx__)
         , bp_base_(bp_base__)
     {
     }
 
     /// Collect summation result in an array
-    void add_k_point_contribution(K_point& kpoint__, sddk::mdarray<double, 2>& collect_res__);
+    void add_k_point_contribution(K_point& kpoint__, sddk::mdarray<double, 2>& collect_res__)
+    {
+        std::vector<sddk::mdarray<double, 2>*> collect_res({&collect_res__});
+        add_k_point_contribution(kpoint__, collect_res);
+    }
+
+    /// Collect summation results for each type of beta-projector derivatives in a separate array.
+    /** Inner product <beta|psi> is computed once for each chunk of atoms and is reused for all derivatives. */
+    void add_k_point_contribution(K_point& kpoint__, std::vector<sddk::mdarray<double, 2>*>& collect_res__);
 };
 }
 
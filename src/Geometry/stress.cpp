@@ -26,6 +26,7 @@
 #include "K_point/k_point.hpp"
 #include "stress.hpp"
 #include "non_local_functor.hpp"
+#include "ewald_spme.hpp"
 #include "utils/profiler.hpp"
 
 namespace sirius {
@@ -49,6 +50,9 @@ void Stress::calc_stress_nonloc_aux()
 
     ctx_.print_memory_usage(__FILE__, __LINE__);
 
+    /* radial integrals are created collectively before the loop over k-points */
+    ctx_.beta_ri_djl();
+
     for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
         int ik  = kset_.spl_num_kpoints(ikloc);
         auto kp = kset_[ik];
@@ -74,6 +78,13 @@ void Stress::calc_stress_nonloc_aux()
         }
     }
 
+    set_stress_nonloc(collect_result);
+}
+
+void Stress::set_stress_nonloc(mdarray<double, 2> const& collect_result__)
+{
+    stress_nonloc_.zero();
+
     #pragma omp parallel
     {
         matrix3d<double> tmp_stress; // TODO: test pragma omp paralell for reduction(+:stress)
@@ -82,7 +93,7 @@ void Stress::calc_stress_nonloc_aux()
         for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
             for (int i = 0; i < 3; i++) {
                 for (int j = 0; j < 3; j++) {
-                    tmp_stress(i, j) -= collect_result(j * 3 + i, ia);
+                    tmp_stress(i, j) -= collect_result__(j * 3 + i, ia);
                 }
             }
         }
@@ -104,14 +115,16 @@ template void Stress::calc_stress_nonloc_aux<double_complex>();
 
 matrix3d<double> Stress::calc_stress_total()
 {
-    calc_stress_kin();
-    calc_stress_har();
+    calc_stress_nonloc();
+    return calc_stress_total_reuse_nonloc();
+}
+
+matrix3d<double> Stress::calc_stress_total_reuse_nonloc()
+{
+    calc_stress_gvec();
     calc_stress_ewald();
-    calc_stress_vloc();
-    calc_stress_core();
     calc_stress_xc();
     calc_stress_us();
-    calc_stress_nonloc();
     stress_hubbard_.zero();
     if (ctx_.hubbard_correction()) {
         calc_stress_hubbard();
@@ -125,6 +138,9 @@ matrix3d<double> Stress::calc_stress_total()
                                     stress_us_(mu, nu) + stress_nonloc_(mu, nu) + stress_hubbard_(mu, nu);
         }
     }
+
+    ctx_.release_ri_djl();
+
     return stress_total_;
 }
 
@@ -145,6 +161,9 @@ matrix3d<double> Stress::calc_stress_hubbard()
 
     Q_operator q_op(ctx_);
 
+    /* radial integrals are created collectively before the loop over k-points */
+    ctx_.atomic_wf_djl();
+
     for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
         dn.zero();
         int ik    = kset_.spl_num_kpoints(ikloc);
@@ -338,20 +357,29 @@ matrix3d<double> Stress::calc_stress_us()
         /* get auxiliary density matrix */
         auto dm = density_.density_matrix_aux(iat);
 
-        mdarray<double_complex, 2> phase_factors(atom_type.num_atoms(), ctx_.gvec().count(),
-                                                 ctx_.mem_pool(memory_t::host));
-
-        PROFILE_START("sirius::Stress|us|phase_fac");
-        #pragma omp parallel for schedule(static)
-        for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
-            int ig = ctx_.gvec().offset() + igloc;
-            for (int i = 0; i < atom_type.num_atoms(); i++) {
-                phase_factors(i, igloc) = ctx_.gvec_phase_factor(ig, atom_type.atom_id(i));
+        /* cached phase factors are used directly as the second operand of GEMM; G-dependent factors are then moved
+           to dQ(G) */
+        bool use_pf_cache = ctx_.phase_factors_cached();
+
+        mdarray<double_complex, 2> phase_factors;
+        mdarray<double, 2> v_tmp;
+        if (use_pf_cache) {
+            v_tmp = mdarray<double, 2>(nbf * (nbf + 1) / 2, ctx_.gvec().count() * 2, *mp);
+        } else {
+            phase_factors = mdarray<double_complex, 2>(atom_type.num_atoms(), ctx_.gvec().count(),
+                                                       ctx_.mem_pool(memory_t::host));
+
+            PROFILE_START("sirius::Stress|us|phase_fac");
+            #pragma omp parallel for schedule(static)
+            for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+                for (int i = 0; i < atom_type.num_atoms(); i++) {
+                    phase_factors(i, igloc) = ctx_.gvec_phase_factor_loc(igloc, iat, i);
+                }
             }
-        }
-        PROFILE_STOP("sirius::Stress|us|phase_fac");
+            PROFILE_STOP("sirius::Stress|us|phase_fac");
 
-        mdarray<double, 2> v_tmp(atom_type.num_atoms(), ctx_.gvec().count() * 2, *mp);
+            v_tmp = mdarray<double, 2>(atom_type.num_atoms(), ctx_.gvec().count() * 2, *mp);
+        }
         mdarray<double, 2> tmp(nbf * (nbf + 1) / 2, atom_type.num_atoms(), *mp);
         /* over spin components, can be from 1 to 4 */
         for (int ispin = 0; ispin < ctx_.num_mag_dims() + 1; ispin++) {
@@ -359,36 +387,67 @@ matrix3d<double> Stress::calc_stress_us()
                 q_deriv.generate_pw_coeffs(atom_type, ri, ri_dq, nu, *mp);
 
                 for (int mu = 0; mu < 3; mu++) {
-                    PROFILE_START("sirius::Stress|us|prepare");
-                    int igloc0{0};
-                    if (ctx_.comm().rank() == 0) {
-                        for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
-                            v_tmp(ia, 0) = v_tmp(ia, 1) = 0;
+                    if (use_pf_cache) {
+                        PROFILE_START("sirius::Stress|us|prepare");
+                        #pragma omp parallel for schedule(static)
+                        for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+                            /* G=0 term is zero */
+                            double_complex v(0, 0);
+                            if (igloc + ctx_.gvec().offset() != 0) {
+                                auto gvc = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
+                                v = std::conj(potential_.component(ispin).f_pw_local(igloc) *
+                                              (-gvc[mu] / gvc.length()));
+                            }
+                            for (int i = 0; i < nbf * (nbf + 1) / 2; i++) {
+                                auto z = double_complex(q_deriv.q_pw(i, 2 * igloc),
+                                                        q_deriv.q_pw(i, 2 * igloc + 1)) * v;
+                                v_tmp(i, 2 * igloc)     = z.real();
+                                v_tmp(i, 2 * igloc + 1) = z.imag();
+                            }
                         }
-                        igloc0 = 1;
-                    }
-                    #pragma omp parallel for schedule(static)
-                    for (int igloc = igloc0; igloc < ctx_.gvec().count(); igloc++) {
-                        auto gvc = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
-                        double g = gvc.length();
-
-                        for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
-                            auto z = phase_factors(ia, igloc) * potential_.component(ispin).f_pw_local(igloc) *
-                                     (-gvc[mu] / g);
-                            v_tmp(ia, 2 * igloc)     = z.real();
-                            v_tmp(ia, 2 * igloc + 1) = z.imag();
+                        PROFILE_STOP("sirius::Stress|us|prepare");
+
+                        PROFILE_START("sirius::Stress|us|gemm");
+                        auto& pf = ctx_.phase_factors_cache(iat);
+                        linalg(la).gemm('N', 'N', nbf * (nbf + 1) / 2, atom_type.num_atoms(), 2 * ctx_.gvec().count(),
+                            &linalg_const<double>::one(),
+                            v_tmp.at(memory_t::host), v_tmp.ld(),
+                            reinterpret_cast<double const*>(pf.at(memory_t::host)), 2 * pf.ld(),
+                            &linalg_const<double>::zero(),
+                            tmp.at(memory_t::host), tmp.ld());
+                        PROFILE_STOP("sirius::Stress|us|gemm");
+                    } else {
+                        PROFILE_START("sirius::Stress|us|prepare");
+                        int igloc0{0};
+                        if (ctx_.comm().rank() == 0) {
+                            for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
+                                v_tmp(ia, 0) = v_tmp(ia, 1) = 0;
+                            }
+                            igloc0 = 1;
+                        }
+                        #pragma omp parallel for schedule(static)
+                        for (int igloc = igloc0; igloc < ctx_.gvec().count(); igloc++) {
+                            auto gvc = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
+                            double g = gvc.length();
+
+                            for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
+                                auto z = phase_factors(ia, igloc) * potential_.component(ispin).f_pw_local(igloc) *
+                                         (-gvc[mu] / g);
+                                v_tmp(ia, 2 * igloc)     = z.real();
+                                v_tmp(ia, 2 * igloc + 1) = z.imag();
+                            }
                         }
+                        PROFILE_STOP("sirius::Stress|us|prepare");
+
+                        PROFILE_START("sirius::Stress|us|gemm");
+                        linalg(la).gemm('N', 'T', nbf * (nbf + 1) / 2, atom_type.num_atoms(), 2 * ctx_.gvec().count(),
+                            &linalg_const<double>::one(),
+                            q_deriv.q_pw().at(memory_t::host), q_deriv.q_pw().ld(),
+                            v_tmp.at(memory_t::host), v_tmp.ld(),
+                            &linalg_const<double>::zero(),
+                            tmp.at(memory_t::host), tmp.ld());
+                        PROFILE_STOP("sirius::Stress|us|gemm");
                     }
-                    PROFILE_STOP("sirius::Stress|us|prepare");
-
-                    PROFILE_START("sirius::Stress|us|gemm");
-                    linalg(la).gemm('N', 'T', nbf * (nbf + 1) / 2, atom_type.num_atoms(), 2 * ctx_.gvec().count(),
-                        &linalg_const<double>::one(),
-                        q_deriv.q_pw().at(memory_t::host), q_deriv.q_pw().ld(),
-                        v_tmp.at(memory_t::host), v_tmp.ld(),
-                        &linalg_const<double>::zero(),
-                        tmp.at(memory_t::host), tmp.ld());
-                    PROFILE_STOP("sirius::Stress|us|gemm");
 
                     for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
                         for (int i = 0; i < nbf * (nbf + 1) / 2; i++) {
@@ -422,31 +481,50 @@ matrix3d<double> Stress::calc_stress_ewald()
 
     auto& uc = ctx_.unit_cell();
 
+    std::unique_ptr<Ewald_spme> spme;
+    if (ctx_.settings().ewald_spme_) {
+        spme = std::unique_ptr<Ewald_spme>(new Ewald_spme(ctx_, ctx_.settings().ewald_spme_order_));
+    }
+
     int ig0 = (ctx_.comm().rank() == 0) ? 1 : 0;
-    for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
-        int ig = ctx_.gvec().offset() + igloc;
+    #pragma omp parallel
+    {
+        matrix3d<double> tmp_stress;
 
-        auto G          = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
-        double g2       = std::pow(G.length(), 2);
-        double g2lambda = g2 / 4.0 / lambda;
+        #pragma omp for schedule(static)
+        for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
+            int ig = ctx_.gvec().offset() + igloc;
 
-        double_complex rho(0, 0);
+            auto G          = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
+            double g2       = std::pow(G.length(), 2);
+            double g2lambda = g2 / 4.0 / lambda;
+
+            double rho2{0};
+            if (spme) {
+                rho2 = spme->structure_factor_sq(igloc);
+            } else {
+                double_complex rho(0, 0);
+                for (int ia = 0; ia < uc.num_atoms(); ia++) {
+                    rho += ctx_.gvec_phase_factor(ig, ia) * static_cast<double>(uc.atom(ia).zn());
+                }
+                rho2 = std::norm(rho);
+            }
 
-        for (int ia = 0; ia < uc.num_atoms(); ia++) {
-            rho += ctx_.gvec_phase_factor(ig, ia) * static_cast<double>(uc.atom(ia).zn());
-        }
+            double a1 = twopi * rho2 * std::exp(-g2lambda) / g2 / std::pow(uc.omega(), 2);
 
-        double a1 = twopi * std::pow(std::abs(rho) / uc.omega(), 2) * std::exp(-g2lambda) / g2;
+            for (int mu : {0, 1, 2}) {
+                for (int nu : {0, 1, 2}) {
+                    tmp_stress(mu, nu) += a1 * G[mu] * G[nu] * 2 * (g2lambda + 1) / g2;
+                }
+            }
 
-        for (int mu : {0, 1, 2}) {
-            for (int nu : {0, 1, 2}) {
-                stress_ewald_(mu, nu) += a1 * G[mu] * G[nu] * 2 * (g2lambda + 1) / g2;
+            for (int mu : {0, 1, 2}) {
+                tmp_stress(mu, mu) -= a1;
             }
         }
 
-        for (int mu : {0, 1, 2}) {
-            stress_ewald_(mu, mu) -= a1;
-        }
+        #pragma omp critical
+        stress_ewald_ += tmp_stress;
     }
 
     if (ctx_.gvec().reduced()) {
@@ -582,7 +660,20 @@ matrix3d<double> Stress::calc_stress_kin()
 {
     PROFILE("sirius::Stress|kin");
 
-    stress_kin_.zero();
+    stress_kin_ = calc_stress_kin_local();
+
+    ctx_.comm().allreduce(&stress_kin_(0, 0), 9);
+
+    stress_kin_ *= (-1.0 / ctx_.unit_cell().omega());
+
+    symmetrize(stress_kin_);
+
+    return stress_kin_;
+}
+
+matrix3d<double> Stress::calc_stress_kin_local() const
+{
+    matrix3d<double> stress_kin;
 
     for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
         int ik  = kset_.spl_num_kpoints(ikloc);
@@ -614,17 +705,11 @@ matrix3d<double> Stress::calc_stress_kin()
                 }
             } // igloc
             #pragma omp critical
-            stress_kin_ += tmp;
+            stress_kin += tmp;
         }
     } // ikloc
 
-    ctx_.comm().allreduce(&stress_kin_(0, 0), 9);
-
-    stress_kin_ *= (-1.0 / ctx_.unit_cell().omega());
-
-    symmetrize(stress_kin_);
-
-    return stress_kin_;
+    return stress_kin;
 }
 
 void Stress::symmetrize(matrix3d<double>& mtrx__) const
@@ -699,6 +784,155 @@ matrix3d<double> Stress::calc_stress_vloc()
     return stress_vloc_;
 }
 
+void Stress::calc_stress_gvec()
+{
+    PROFILE("sirius::Stress|gvec");
+
+    auto& uc = ctx_.unit_cell();
+
+    /* check if the pseudo-core charge density is set up for at least one atom */
+    bool has_core{false};
+    for (int iat = 0; iat < uc.num_atom_types(); iat++) {
+        if (uc.atom_type(iat).num_atoms() && !uc.atom_type(iat).ps_core_charge_density().empty()) {
+            has_core = true;
+        }
+    }
+
+    if (has_core) {
+        potential_.xc_potential().fft_transform(-1);
+    }
+
+    auto& ri_vloc    = ctx_.vloc_ri();
+    auto& ri_vloc_dg = ctx_.vloc_ri_djl();
+    auto& ri_core_dg = ctx_.ps_core_ri_djl();
+
+    double fourpi_omega = fourpi / uc.omega();
+
+    /* local contributions: kinetic, Hartree, local potential and core correction followed by the
+       diagonal terms of the local potential and core correction */
+    std::array<matrix3d<double>, 4> sloc;
+    std::array<double, 2> sdiag{{0, 0}};
+
+    int ig0 = (ctx_.comm().rank() == 0) ? 1 : 0;
+    #pragma omp parallel
+    {
+        std::array<matrix3d<double>, 3> tmp;
+        std::array<double, 2> tmp_diag{{0, 0}};
+
+        #pragma omp for schedule(static)
+        for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
+            int ig = ctx_.gvec().offset() + igloc;
+
+            auto G    = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
+            double g  = ctx_.gvec().gvec_len(ig);
+            double g2 = g * g;
+
+            auto rho = density_.rho().f_pw_local(igloc);
+
+            /* local potential, its derivative and derivative of pseudo-core density at this G-vector */
+            double_complex v(0, 0);
+            double_complex dv(0, 0);
+            double_complex drhoc(0, 0);
+            for (int iat = 0; iat < uc.num_atom_types(); iat++) {
+                auto z = fourpi_omega * std::conj(ctx_.phase_factors_t(igloc, iat));
+                v += z * ri_vloc.value(iat, g);
+                dv += z * ri_vloc_dg.value(iat, g);
+                if (has_core) {
+                    drhoc += z * ri_core_dg.value<int>(iat, g);
+                }
+            }
+
+            double d_har  = twopi * std::norm(rho) / g2;
+            double d_vloc = std::real(std::conj(rho) * dv);
+            tmp_diag[0] += std::real(std::conj(rho) * v);
+
+            double d_core{0};
+            if (has_core) {
+                auto vxc = potential_.xc_potential().f_pw_local(igloc);
+                d_core   = std::real(std::conj(vxc) * drhoc) / g;
+                tmp_diag[1] += std::real(std::conj(vxc) * density_.rho_pseudo_core().f_pw_local(igloc));
+            }
+
+            for (int mu : {0, 1, 2}) {
+                for (int nu : {0, 1, 2}) {
+                    double gg = G[mu] * G[nu];
+                    tmp[0](mu, nu) += d_har * 2 * gg / g2;
+                    tmp[1](mu, nu) += d_vloc * gg;
+                    tmp[2](mu, nu) -= d_core * gg;
+                }
+                tmp[0](mu, mu) -= d_har;
+            }
+        }
+
+        #pragma omp critical
+        {
+            for (int i = 0; i < 3; i++) {
+                sloc[i + 1] += tmp[i];
+            }
+            sdiag[0] += tmp_diag[0];
+            sdiag[1] += tmp_diag[1];
+        }
+    }
+
+    if (ctx_.gvec().reduced()) {
+        for (int i = 1; i < 4; i++) {
+            sloc[i] *= 2;
+        }
+        sdiag[0] *= 2;
+        sdiag[1] *= 2;
+    }
+
+    /* G=0 contribution to the diagonal terms */
+    if (ctx_.comm().rank() == 0) {
+        double_complex v(0, 0);
+        for (int iat = 0; iat < uc.num_atom_types(); iat++) {
+            v += fourpi_omega * std::conj(ctx_.phase_factors_t(0, iat)) * ri_vloc.value(iat, 0.0);
+        }
+        sdiag[0] += std::real(std::conj(density_.rho().f_pw_local(0)) * v);
+        if (has_core) {
+            sdiag[1] += std::real(std::conj(potential_.xc_potential().f_pw_local(0)) *
+                                  density_.rho_pseudo_core().f_pw_local(0));
+        }
+    }
+
+    /* kinetic contribution is a sum over G+k vectors of local k-points */
+    sloc[0] = calc_stress_kin_local();
+
+    /* single reduction of all terms */
+    std::vector<double> buf(4 * 9 + 2);
+    for (int i = 0; i < 4; i++) {
+        for (int mu : {0, 1, 2}) {
+            for (int nu : {0, 1, 2}) {
+                buf[i * 9 + mu * 3 + nu] = sloc[i](mu, nu);
+            }
+        }
+    }
+    buf[36] = sdiag[0];
+    buf[37] = sdiag[1];
+    ctx_.comm().allreduce(buf.data(), static_cast<int>(buf.size()));
+    for (int i = 0; i < 4; i++) {
+        for (int mu : {0, 1, 2}) {
+            for (int nu : {0, 1, 2}) {
+                sloc[i](mu, nu) = buf[i * 9 + mu * 3 + nu];
+            }
+        }
+    }
+
+    stress_kin_  = sloc[0] * (-1.0 / uc.omega());
+    stress_har_  = sloc[1];
+    stress_vloc_ = sloc[2];
+    stress_core_ = sloc[3];
+    for (int mu : {0, 1, 2}) {
+        stress_vloc_(mu, mu) -= buf[36];
+        stress_core_(mu, mu) -= buf[37];
+    }
+
+    symmetrize(stress_kin_);
+    symmetrize(stress_har_);
+    symmetrize(stress_vloc_);
+    symmetrize(stress_core_);
+}
+
 matrix3d<double> Stress::calc_stress_nonloc()
 {
     if (ctx_.gamma_point()) {
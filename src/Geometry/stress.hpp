@@ -191,6 +191,9 @@ class Stress
 
     void symmetrize(matrix3d<double>& mtrx__) const;
 
+    /// Sum of the kinetic contribution over local k-points without reduction and normalization.
+    matrix3d<double> calc_stress_kin_local() const;
+
   public:
     Stress(Simulation_context& ctx__, Density& density__, Potential& potential__, K_point_set& kset__)
         : ctx_(ctx__)
@@ -332,6 +335,12 @@ class Stress
 
     matrix3d<double> calc_stress_nonloc();
 
+    /// Set the non-local contribution from the accumulated per-atom strain derivatives.
+    /** The array collect_result__(9, num_atoms) is the local (not yet reduced) sum over k-points of the
+     *  strain-derivative terms. This is used by sirius::Force::calc_forces_stress_nonloc() which computes the
+     *  non-local forces and stress in a single pass over k-points. */
+    void set_stress_nonloc(sddk::mdarray<double, 2> const& collect_result__);
+
     inline matrix3d<double> stress_nonloc() const
     {
         return stress_nonloc_;
@@ -398,6 +407,13 @@ class Stress
         return stress_core_;
     }
 
+    /// Compute kinetic, Hartree, local potential and core correction contributions in a single pass.
+    /** G-vector dependent quantities (Cartesian components, length, radial integrals and phase factors of atom
+        types) are evaluated once per G-vector and all contributions are accumulated in thread-local matrices.
+        All terms are reduced in a single MPI call. The individual contributions are stored as in
+        calc_stress_kin(), calc_stress_har(), calc_stress_vloc() and calc_stress_core(). */
+    void calc_stress_gvec();
+
     matrix3d<double> calc_stress_hubbard();
 
     inline matrix3d<double> stress_hubbard() const
@@ -407,6 +423,15 @@ class Stress
 
     matrix3d<double> calc_stress_total();
 
+    inline matrix3d<double> stress_total() const
+    {
+        return stress_total_;
+    }
+
+    /// Compute all contributions to the stress tensor except the non-local one and sum them.
+    /** The non-local contribution must be computed beforehand (see sirius::Force::calc_forces_stress_total). */
+    matrix3d<double> calc_stress_total_reuse_nonloc();
+
     void print_info() const;
 };
 
@@ -171,6 +171,9 @@ class Hamiltonian_k
   private:
     Hamiltonian0& H0_;
     K_point& kp_;
+    /// Local operator applied to the wave-functions of this k-point.
+    /** By default this is the operator of H0; k-points solved concurrently use their own copies. */
+    Local_operator& local_op_;
 
     /// Copy constructor is forbidden.
     Hamiltonian_k(Hamiltonian_k const& src__) = delete;
@@ -181,6 +184,9 @@ class Hamiltonian_k
   public:
     Hamiltonian_k(Hamiltonian0& H0__, K_point& kp__);
 
+    /// Create a Hamiltonian which uses an external local operator sharing the effective fields with H0.
+    Hamiltonian_k(Hamiltonian0& H0__, K_point& kp__, Local_operator& local_op__);
+
     ~Hamiltonian_k();
 
     Hamiltonian0 const& H0() const
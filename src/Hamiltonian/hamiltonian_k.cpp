@@ -35,11 +35,17 @@
 namespace sirius {
 
 Hamiltonian_k::Hamiltonian_k(Hamiltonian0& H0__, K_point& kp__) // TODO: move kinetic part from local_op to here
+    : Hamiltonian_k(H0__, kp__, H0__.local_op())
+{
+}
+
+Hamiltonian_k::Hamiltonian_k(Hamiltonian0& H0__, K_point& kp__, Local_operator& local_op__)
     : H0_(H0__)
     , kp_(kp__)
+    , local_op_(local_op__)
 {
     PROFILE("sirius::Hamiltonian_k");
-    H0_.local_op().prepare_k(kp_.gkvec_partition());
+    local_op_.prepare_k(kp_.gkvec_partition());
     if (!H0_.ctx().full_potential()) {
         if (H0_.ctx().iterative_solver_input().type_ != "exact") {
             kp_.beta_projectors().prepare();
@@ -77,7 +83,7 @@ Hamiltonian_k::get_h_o_diag_pw() const
         for (int ig_loc = 0; ig_loc < kp_.num_gkvec_loc(); ig_loc++) {
             if (what & 1) {
                 auto ekin = 0.5 * kp_.gkvec().gkvec_cart<index_domain_t::local>(ig_loc).length2();
-                h_diag(ig_loc, ispn) = ekin + H0_.local_op().v0(ispn);
+                h_diag(ig_loc, ispn) = ekin + local_op_.v0(ispn);
             }
             if (what & 2) {
                 o_diag(ig_loc, ispn) = 1;
@@ -179,7 +185,7 @@ Hamiltonian_k::get_h_o_diag_lapw() const
         if (what & 1) {
             auto gvc = kp_.gkvec().gkvec_cart<index_domain_t::local>(igloc);
             double ekin = 0.5 * dot(gvc, gvc);
-            h_diag[igloc] = H0_.local_op().v0(0) + ekin * H0_.ctx().theta_pw(0).real();
+            h_diag[igloc] = local_op_.v0(0) + ekin * H0_.ctx().theta_pw(0).real();
         }
         if (what & 2) {
             o_diag[igloc] = H0_.ctx().theta_pw(0).real();
@@ -724,7 +730,7 @@ void Hamiltonian_k::apply_h_s(spin_range spins__, int N__, int n__, Wave_functio
 
     if (hphi__ != nullptr) {
         /* apply local part of Hamiltonian */
-        H0().local_op().apply_h(kp().spfft_transform(), kp().gkvec_partition(), spins__, phi__, *hphi__, N__, n__);
+        local_op_.apply_h(kp().spfft_transform(), kp().gkvec_partition(), spins__, phi__, *hphi__, N__, n__);
     }
 
     t1 += omp_get_wtime();
@@ -831,7 +837,7 @@ void Hamiltonian_k::apply_fv_h_o(bool apw_only__, bool phi_is_lo__, int N__, int
 
     if (!phi_is_lo__) {
         /* interstitial part */
-        H0_.local_op().apply_h_o(kp().spfft_transform(), kp().gkvec_partition(), N__, n__, phi__, hphi__, ophi__);
+        local_op_.apply_h_o(kp().spfft_transform(), kp().gkvec_partition(), N__, n__, phi__, hphi__, ophi__);
         //if (ctx.control().print_checksum_) {
         //    if (hphi__) {
         //        hphi__->print_checksum(pu, "hloc_phi", N__, n__);
@@ -1357,7 +1363,7 @@ void Hamiltonian_k::apply_b(Wave_functions& psi__, std::vector<Wave_functions>&
 
     assert(bpsi__.size() == 2 || bpsi__.size() == 3);
 
-    H0().local_op().apply_b(kp().spfft_transform(), 0, H0().ctx().num_fv_states(), psi__, bpsi__);
+    local_op_.apply_b(kp().spfft_transform(), 0, H0().ctx().num_fv_states(), psi__, bpsi__);
     H0().apply_bmt(psi__, bpsi__);
 
     /* copy Bz|\psi> to -Bz|\psi> */
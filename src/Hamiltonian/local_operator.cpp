@@ -42,8 +42,8 @@ Local_operator::Local_operator(Simulation_context const& ctx__, spfft::Transform
 
     /* allocate functions */
     for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
-        veff_vec_[j] = std::unique_ptr<Smooth_periodic_function<double>>(
-            new Smooth_periodic_function<double>(fft_coarse__, gvec_coarse_p__, &ctx_.mem_pool(memory_t::host)));
+        veff_vec_[j] = std::make_shared<Smooth_periodic_function<double>>(
+            fft_coarse__, gvec_coarse_p__, &ctx_.mem_pool(memory_t::host));
         #pragma omp parallel for schedule(static)
         for (int ir = 0; ir < fft_coarse__.local_slice_size(); ir++) {
             veff_vec_[j]->f_rg(ir) = 2.71828;
@@ -52,8 +52,8 @@ Local_operator::Local_operator(Simulation_context const& ctx__, spfft::Transform
     /* map Theta(r) to the coarse mesh */
     if (ctx_.full_potential()) {
         auto& gvec_dense_p = ctx_.gvec_partition();
-        veff_vec_[4] = std::unique_ptr<Smooth_periodic_function<double>>(
-            new Smooth_periodic_function<double>(fft_coarse__, gvec_coarse_p__, &ctx_.mem_pool(memory_t::host)));
+        veff_vec_[4] = std::make_shared<Smooth_periodic_function<double>>(
+            fft_coarse__, gvec_coarse_p__, &ctx_.mem_pool(memory_t::host));
         /* map unit-step function */
         #pragma omp parallel for schedule(static)
         for (int igloc = 0; igloc < gvec_coarse_p_.gvec().count(); igloc++) {
@@ -106,8 +106,8 @@ Local_operator::Local_operator(Simulation_context const& ctx__, spfft::Transform
                 veff_vec_[j]->fft_transform(1);
             }
             if (ctx_.valence_relativity() == relativity_t::zora) {
-                veff_vec_[5] = std::unique_ptr<Smooth_periodic_function<double>>(
-                    new Smooth_periodic_function<double>(fft_coarse__, gvec_coarse_p__, &ctx_.mem_pool(memory_t::host)));
+                veff_vec_[5] = std::make_shared<Smooth_periodic_function<double>>(
+                    fft_coarse__, gvec_coarse_p__, &ctx_.mem_pool(memory_t::host));
                 /* loop over local set of coarse G-vectors */
                 #pragma omp parallel for schedule(static)
                 for (int igloc = 0; igloc < gvec_coarse_p_.gvec().count(); igloc++) {
@@ -177,6 +177,22 @@ Local_operator::Local_operator(Simulation_context const& ctx__, spfft::Transform
     }
 }
 
+Local_operator::Local_operator(Local_operator const& src__)
+    : ctx_(src__.ctx_)
+    , fft_coarse_(src__.fft_coarse_)
+    , gvec_coarse_p_(src__.gvec_coarse_p_)
+    , veff_vec_(src__.veff_vec_)
+{
+    v0_[0] = src__.v0_[0];
+    v0_[1] = src__.v0_[1];
+
+    buf_rg_ = mdarray<double_complex, 1>(fft_coarse_.local_slice_size(), ctx_.mem_pool(memory_t::host),
+                                         "Local_operator::buf_rg_");
+    if (fft_coarse_.processing_unit() == SPFFT_PU_GPU) {
+        buf_rg_.allocate(ctx_.mem_pool(memory_t::device));
+    }
+}
+
 void Local_operator::prepare_k(Gvec_partition const& gkvec_p__)
 {
     PROFILE("sirius::Local_operator::prepare_k");
@@ -207,7 +223,7 @@ void Local_operator::prepare_k(Gvec_partition const& gkvec_p__)
 }
 
 static inline void mul_by_veff(spfft::Transform& spfftk__, double* buff__,
-                               std::array<std::unique_ptr<Smooth_periodic_function<double>>, 6>& veff_vec__,
+                               std::array<std::shared_ptr<Smooth_periodic_function<double>>, 6> const& veff_vec__,
                                int idx_veff__)
 {
     int nr = spfftk__.local_slice_size();
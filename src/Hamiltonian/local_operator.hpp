@@ -94,7 +94,8 @@ class Local_operator
          - Theta(r) (in FP-LAPW case)
          - inverse of 1 + relative mass (needed for ZORA LAPW)
      */
-    std::array<std::unique_ptr<Smooth_periodic_function<double>>, 6> veff_vec_;
+    /** The functions are not modified after construction and can be shared between several operators. */
+    std::array<std::shared_ptr<Smooth_periodic_function<double>>, 6> veff_vec_;
 
     /// Temporary array to store [V*phi](G)
     sddk::mdarray<double_complex, 1> vphi_;
@@ -124,6 +125,11 @@ class Local_operator
                    sddk::Gvec_partition const& gvec_coarse_p__,
                    Potential*                  potential__ = nullptr);
 
+    /// Create an operator which shares the effective fields with another operator.
+    /** The new operator has its own k-point dependent buffers and can be applied concurrently with the original
+     *  one to a different k-point. */
+    Local_operator(Local_operator const& src__);
+
     /// Prepare the k-point dependent arrays.
     /** \param [in] gkvec_p  FFT-friendly G+k vector partitioning. */
     void prepare_k(sddk::Gvec_partition const& gkvec_p__);
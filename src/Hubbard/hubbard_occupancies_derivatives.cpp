@@ -423,6 +423,8 @@ void
 Hubbard::wavefunctions_strain_deriv(K_point& kp__, Wave_functions& dphi, mdarray<double, 2> const& rlm_g,
                                     mdarray<double, 3> const& rlm_dg, const int nu, const int mu)
 {
+    auto& ri    = ctx_.atomic_wf_ri();
+    auto& ridjl = ctx_.atomic_wf_djl();
     #pragma omp parallel for schedule(static)
     for (int igkloc = 0; igkloc < kp__.num_gkvec_loc(); igkloc++) {
         /* global index of G+k vector */
@@ -432,12 +434,12 @@ Hubbard::wavefunctions_strain_deriv(K_point& kp__, Wave_functions& dphi, mdarray
         auto gvs = SHT::spherical_coordinates(gvc);
         std::vector<mdarray<double, 1>> ri_values(unit_cell_.num_atom_types());
         for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
-            ri_values[iat] = ctx_.atomic_wf_ri().values(iat, gvs[0]);
+            ri_values[iat] = ri.values(iat, gvs[0]);
         }
 
         std::vector<mdarray<double, 1>> ridjl_values(unit_cell_.num_atom_types());
         for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
-            ridjl_values[iat] = ctx_.atomic_wf_djl().values(iat, gvs[0]);
+            ridjl_values[iat] = ridjl.values(iat, gvs[0]);
         }
 
         const double p = (mu == nu) ? 0.5 : 0.0;
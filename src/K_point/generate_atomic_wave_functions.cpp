@@ -41,21 +41,38 @@ void K_point::generate_atomic_wave_functions(const basis_functions_index& index,
     lmax = std::max(lmax, unit_cell_.lmax());
 
     auto& atom_type = unit_cell_.atom(atom).type();
+    auto& ri        = ctx_.atomic_wf_ri();
+
+    /* spherical coordinates of G+k vectors: theta and phi */
+    sddk::mdarray<double, 2> tp(this->num_gkvec_loc(), 2);
     #pragma omp parallel for schedule(static)
     for (int igk_loc = 0; igk_loc < this->num_gkvec_loc(); igk_loc++) {
-        /* global index of G+k vector */
-        int igk = this->idxgk(igk_loc);
         /* vs = {r, theta, phi} */
         auto vs = SHT::spherical_coordinates(this->gkvec().gkvec_cart<index_domain_t::local>(igk_loc));
+        tp(igk_loc, 0) = vs[1];
+        tp(igk_loc, 1) = vs[2];
+    }
+    /* compute real spherical harmonics for all G+k vectors */
+    sddk::mdarray<double, 2> gkvec_rlm(utils::lmmax(lmax), this->num_gkvec_loc());
+    sf::spherical_harmonics(lmax, this->num_gkvec_loc(), &tp(0, 0), &tp(0, 1), &gkvec_rlm(0, 0), utils::lmmax(lmax));
+
+    /* get values of radial integrals once per G+k shell */
+    std::vector<double> gk_shell_len(this->gkvec().num_gkvec_shells_local());
+    for (int i = 0; i < this->gkvec().num_gkvec_shells_local(); i++) {
+        gk_shell_len[i] = this->gkvec().gkvec_shell_len_local(i);
+    }
+    auto ri_shells = ri.values(atom_type.id(), gk_shell_len);
+
+    #pragma omp parallel for schedule(static)
+    for (int igk_loc = 0; igk_loc < this->num_gkvec_loc(); igk_loc++) {
+        /* global index of G+k vector */
+        int igk = this->idxgk(igk_loc);
 
-        /* compute real spherical harmonics for G+k vector */
-        std::vector<double> rlm(utils::lmmax(lmax));
-        sf::spherical_harmonics(lmax, vs[1], vs[2], &rlm[0]);
+        /* real spherical harmonics for G+k vector */
+        double const* rlm = &gkvec_rlm(0, igk_loc);
 
-        /* need to find the index of the atom type get values of radial
-           integrals for a given G+k vector length */
-        sddk::mdarray<double, 1> ri_values;
-        ri_values = ctx_.atomic_wf_ri().values(atom_type.id(), vs[0]);
+        /* values of radial integrals for a given G+k vector length */
+        double const* ri_values = &ri_shells(0, this->gkvec().gkvec_shell_idx_local(igk_loc));
 
         int n{0};
         for (int xi = 0; xi < index.size();) {
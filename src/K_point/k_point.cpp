@@ -297,14 +297,18 @@ void K_point::generate_gkvec(double gk_cutoff__)
 
     gkvec_offset_ = gkvec().gvec_offset(comm().rank());
 
+    /* create transformation */
+    spfft_transform_.reset(new spfft::Transform(create_spfft_transform(ctx_.spfft_grid_coarse())));
+}
+
+spfft::Transform K_point::create_spfft_transform(spfft::Grid& grid__) const
+{
     const auto fft_type = gkvec_->reduced() ? SPFFT_TRANS_R2C : SPFFT_TRANS_C2C;
     const auto spfft_pu = ctx_.processing_unit() == device_t::CPU ? SPFFT_PU_HOST : SPFFT_PU_GPU;
     auto gv = gkvec_partition_->get_gvec();
-    /* create transformation */
-    spfft_transform_.reset(new spfft::Transform(ctx_.spfft_grid_coarse().create_transform(
-        spfft_pu, fft_type, ctx_.fft_coarse_grid()[0], ctx_.fft_coarse_grid()[1], ctx_.fft_coarse_grid()[2],
-        ctx_.spfft_coarse().local_z_length(), gkvec_partition_->gvec_count_fft(), SPFFT_INDEX_TRIPLETS,
-        gv.at(memory_t::host))));
+    return grid__.create_transform(spfft_pu, fft_type, ctx_.fft_coarse_grid()[0], ctx_.fft_coarse_grid()[1],
+                                   ctx_.fft_coarse_grid()[2], ctx_.spfft_coarse().local_z_length(),
+                                   gkvec_partition_->gvec_count_fft(), SPFFT_INDEX_TRIPLETS, gv.at(memory_t::host));
 }
 
 void K_point::update()
@@ -754,6 +758,54 @@ void K_point::test_spinor_wave_functions(int use_fft)
 //==     std :: cout << "maximum error = " << maxerr << std::endl;
 }
 
+/** Plane-wave coefficients are matched by the Miller indices of G; missing G+k vectors get zero coefficients. */
+void K_point::init_wave_functions_from(K_point& kp__)
+{
+    PROFILE("sirius::K_point::init_wave_functions_from");
+
+    if (kp__.comm().size() != comm().size()) {
+        TERMINATE("k-points must share the same communicator");
+    }
+
+    auto& gkvec_src = kp__.gkvec();
+
+    /* map local G+k vectors of this k-point to the global index of the same G in the source k-point */
+    std::vector<int> igmap(num_gkvec_loc(), -1);
+    #pragma omp parallel for schedule(static)
+    for (int igk_loc = 0; igk_loc < num_gkvec_loc(); igk_loc++) {
+        auto G = gkvec().gvec(idxgk(igk_loc));
+        int ig = gkvec_src.index_by_gvec(G);
+        /* index can be bogus if G is outside of the z-column of the source set */
+        if (ig >= 0 && ig < gkvec_src.num_gvec() && gkvec_src.gvec(ig) == G) {
+            igmap[igk_loc] = ig;
+        }
+    }
+
+    auto& psi_src = kp__.spinor_wave_functions();
+    auto& psi     = spinor_wave_functions();
+
+    std::vector<double_complex> wf_tmp(gkvec_src.num_gvec());
+    for (int ispn = 0; ispn < psi.num_sc(); ispn++) {
+        for (int i = 0; i < ctx_.num_bands(); i++) {
+            /* gather full column of PW coefficients of the source k-point */
+            kp__.comm().allgather(&psi_src.pw_coeffs(ispn).prime(0, i), wf_tmp.data(), gkvec_src.offset(),
+                                  gkvec_src.count());
+            #pragma omp parallel for schedule(static)
+            for (int igk_loc = 0; igk_loc < num_gkvec_loc(); igk_loc++) {
+                psi.pw_coeffs(ispn).prime(igk_loc, i) = (igmap[igk_loc] >= 0) ? wf_tmp[igmap[igk_loc]] : 0;
+            }
+        }
+    }
+
+    /* band energies are reset to force at least two iterations of the iterative solver */
+    for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+        for (int i = 0; i < ctx_.num_bands(); i++) {
+            band_energy(i, ispn, 0);
+            band_occupancy(i, ispn, ctx_.max_occupancy());
+        }
+    }
+}
+
 /** The following HDF5 data structure is created:
   \verbatim
   /K_point_set/ik/vk
@@ -977,24 +1029,34 @@ K_point::generate_atomic_wave_functions(std::vector<int> atoms__,
         }
     }
 
+    /* spherical coordinates of G+k vectors: theta and phi */
+    mdarray<double, 2> tp(this->num_gkvec_loc(), 2);
     #pragma omp parallel for schedule(static)
     for (int igk_loc = 0; igk_loc < this->num_gkvec_loc(); igk_loc++) {
-        /* global index of G+k vector */
-        //int igk = this->idxgk(igk_loc);
         /* vs = {r, theta, phi} */
         auto vs = geometry3d::spherical_coordinates(this->gkvec().gkvec_cart<index_domain_t::local>(igk_loc));
-
-        /* compute real spherical harmonics for G+k vector */
-        std::vector<double> rlm(lmmax);
-        sf::spherical_harmonics(lmax, vs[1], vs[2], &rlm[0]);
-
-        /* get all values of the radial integrals for a given G+k vector */
-        std::vector<mdarray<double, 1>> ri_values(unit_cell_.num_atom_types());
-        for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
-            if (wf_t[iat].size() != 0) {
-                ri_values[iat] = ri__.values(iat, vs[0]);
-            }
+        tp(igk_loc, 0) = vs[1];
+        tp(igk_loc, 1) = vs[2];
+    }
+    /* compute real spherical harmonics for all G+k vectors */
+    mdarray<double, 2> rlm(lmmax, this->num_gkvec_loc());
+    sf::spherical_harmonics(lmax, this->num_gkvec_loc(), &tp(0, 0), &tp(0, 1), &rlm(0, 0), lmmax);
+
+    /* get all values of the radial integrals once per G+k shell */
+    std::vector<double> gk_shell_len(this->gkvec().num_gkvec_shells_local());
+    for (int i = 0; i < this->gkvec().num_gkvec_shells_local(); i++) {
+        gk_shell_len[i] = this->gkvec().gkvec_shell_len_local(i);
+    }
+    std::vector<mdarray<double, 2>> ri_values(unit_cell_.num_atom_types());
+    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+        if (wf_t[iat].size() != 0) {
+            ri_values[iat] = ri__.values(iat, gk_shell_len);
         }
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int igk_loc = 0; igk_loc < this->num_gkvec_loc(); igk_loc++) {
+        int ish = this->gkvec().gkvec_shell_idx_local(igk_loc);
         for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
             if (wf_t[iat].size() == 0) {
                 continue;
@@ -1010,7 +1072,7 @@ K_point::generate_atomic_wave_functions(std::vector<int> atoms__,
 
                 auto z = std::pow(double_complex(0, -1), l) * fourpi / std::sqrt(unit_cell_.omega());
 
-                wf_t[iat](igk_loc, xi) = z * rlm[lm] * ri_values[iat](idxrf);
+                wf_t[iat](igk_loc, xi) = z * rlm(lm, igk_loc) * ri_values[iat](idxrf, ish);
             }
         }
     }
@@ -263,6 +263,12 @@ class K_point
         states and second-variational eigen-vectors. */
     void generate_spinor_wave_functions();
 
+    /// Initialize spinor wave-functions from the converged wave-functions of another k-point.
+    /** Plane-wave coefficients are matched by the Miller indices of G; G+k vectors of this k-point which are not
+        present in the basis of the source k-point get zero coefficients. Both k-points must be stored on the same
+        k-point communicator. This is used to continue the band-structure calculation along a path of k-points. */
+    void init_wave_functions_from(K_point& kp__);
+
     void generate_atomic_wave_functions(const basis_functions_index& index, const int atom, const int offset,
                                         const bool hubbard, Wave_functions& phi);
 
@@ -756,6 +762,10 @@ class K_point
     {
         return *spfft_transform_;
     }
+
+    /// Create FFT transformation of the G+k vectors of this k-point on a given FFT grid.
+    /** Transformations created on the same grid share its buffers and can't be executed concurrently. */
+    spfft::Transform create_spfft_transform(spfft::Grid& grid__) const;
 };
 
 } // namespace sirius
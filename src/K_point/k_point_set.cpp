@@ -18,6 +18,8 @@
 // OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <limits>
+#include <algorithm>
+#include <numeric>
 #include "K_point/k_point.hpp"
 #include "K_point/k_point_set.hpp"
 
@@ -98,8 +100,14 @@ void K_point_set::initialize(std::vector<int> const& counts)
     PROFILE("sirius::K_point_set::initialize");
     /* distribute k-points along the 1-st dimension of the MPI grid */
     if (counts.empty()) {
-        splindex<splindex_t::block> spl_tmp(num_kpoints(), comm().size(), comm().rank());
-        spl_num_kpoints_ = splindex<splindex_t::chunk>(num_kpoints(), comm().size(), comm().rank(), spl_tmp.counts());
+        if (ctx_.control().kpoints_distribution_ == "cost") {
+            spl_num_kpoints_ = splindex<splindex_t::chunk>(num_kpoints(), comm().size(), comm().rank(),
+                                                           balanced_counts(estimate_cost()));
+        } else {
+            splindex<splindex_t::block> spl_tmp(num_kpoints(), comm().size(), comm().rank());
+            spl_num_kpoints_ =
+                splindex<splindex_t::chunk>(num_kpoints(), comm().size(), comm().rank(), spl_tmp.counts());
+        }
     } else {
         spl_num_kpoints_ = splindex<splindex_t::chunk>(num_kpoints(), comm().size(), comm().rank(), counts);
     }
@@ -108,12 +116,168 @@ void K_point_set::initialize(std::vector<int> const& counts)
         kpoints_[spl_num_kpoints_[ikloc]]->initialize();
     }
 
+    /* timings of the band solver are stored by the concurrent teams, so the vector is never resized there */
+    solve_time_ = std::vector<double>(num_kpoints(), 0);
+
     if (ctx_.control().verbosity_ > 0) {
         print_info();
     }
     ctx_.print_memory_usage(__FILE__, __LINE__);
 }
 
+std::vector<double> K_point_set::estimate_cost() const
+{
+    PROFILE("sirius::K_point_set::estimate_cost");
+
+    auto M     = unit_cell_.reciprocal_lattice_vectors();
+    double gk2 = std::pow(ctx_.gk_cutoff(), 2);
+    /* third reciprocal lattice vector */
+    vector3d<double> m3(M(0, 2), M(1, 2), M(2, 2));
+    double m3m3 = dot(m3, m3);
+
+    std::vector<double> cost(num_kpoints(), 0);
+
+    /* count G+k vectors; for each (x, y) column the condition |G+k|^2 < Gmax^2 is a quadratic inequality in z */
+    splindex<splindex_t::block> spl_k(num_kpoints(), comm().size(), comm().rank());
+    for (int ikloc = 0; ikloc < spl_k.local_size(); ikloc++) {
+        int ik  = spl_k[ikloc];
+        auto vk = kpoints_[ik]->vk();
+        /* |G+k| < Gmax requires |G| < Gmax + |k|, so the box of G-vectors is enlarged by the length of k */
+        auto box = get_min_fft_grid(ctx_.gk_cutoff() + (M * vk).length(), M);
+        int n{0};
+        for (int i = box.limits(0).first; i <= box.limits(0).second; i++) {
+            for (int j = box.limits(1).first; j <= box.limits(1).second; j++) {
+                auto a      = M * vector3d<double>(i + vk[0], j + vk[1], 0);
+                double b    = dot(a, m3);
+                double disc = b * b - m3m3 * (dot(a, a) - gk2);
+                if (disc < 0) {
+                    continue;
+                }
+                double t1 = (-b - std::sqrt(disc)) / m3m3 - vk[2];
+                double t2 = (-b + std::sqrt(disc)) / m3m3 - vk[2];
+                n += std::max(0, static_cast<int>(std::floor(t2) - std::ceil(t1)) + 1);
+            }
+        }
+        cost[ik] = static_cast<double>(n) * ctx_.num_bands();
+    }
+    comm().allgather(cost.data(), spl_k.global_offset(), spl_k.local_size());
+
+    return cost;
+}
+
+std::vector<int> K_point_set::balanced_counts(std::vector<double> const& cost__) const
+{
+    int nk = static_cast<int>(cost__.size());
+    int np = comm().size();
+
+    /* greedy filling of contiguous chunks for a given bottleneck; returns the number of k-points in each chunk */
+    auto fill = [&](double bottleneck__) {
+        std::vector<int> counts(np, 0);
+        int ik{0};
+        for (int r = 0; r < np && ik < nk; r++) {
+            double c{0};
+            /* leave at least one k-point to each of the remaining ranks */
+            while (ik < nk && (counts[r] == 0 || (c + cost__[ik] <= bottleneck__ && nk - ik > np - r - 1))) {
+                c += cost__[ik++];
+                counts[r]++;
+            }
+        }
+        /* not all k-points were assigned */
+        if (ik < nk) {
+            counts.clear();
+        }
+        return counts;
+    };
+
+    double lo = *std::max_element(cost__.begin(), cost__.end());
+    double hi = std::accumulate(cost__.begin(), cost__.end(), 0.0);
+
+    auto counts = fill(hi);
+    for (int i = 0; i < 50 && hi - lo > 1e-6 * hi; i++) {
+        double b = 0.5 * (lo + hi);
+        auto c   = fill(b);
+        if (c.empty()) {
+            lo = b;
+        } else {
+            hi     = b;
+            counts = c;
+        }
+    }
+    return counts;
+}
+
+void K_point_set::rebalance()
+{
+    PROFILE("sirius::K_point_set::rebalance");
+
+    double threshold = ctx_.control().kpoints_rebalance_threshold_;
+    if (threshold < 0 || ctx_.full_potential() || comm().size() == 1 ||
+        solve_time_.size() != kpoints_.size()) {
+        return;
+    }
+
+    /* collect timings of all k-points */
+    auto t = solve_time_;
+    comm().allreduce(t.data(), num_kpoints());
+    solve_time_ = std::vector<double>(num_kpoints(), 0);
+
+    std::vector<double> load(comm().size(), 0);
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        load[spl_num_kpoints_.local_rank(ik)] += t[ik];
+    }
+    double avg = std::accumulate(load.begin(), load.end(), 0.0) / comm().size();
+    double imbalance = (avg > 0) ? *std::max_element(load.begin(), load.end()) / avg - 1 : 0;
+    if (imbalance <= threshold) {
+        return;
+    }
+
+    splindex<splindex_t::chunk> spl_new(num_kpoints(), comm().size(), comm().rank(), balanced_counts(t));
+
+    int nmig{0};
+    /* move wave-functions of the k-points which change their location */
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        int rank_old = spl_num_kpoints_.local_rank(ik);
+        int rank_new = spl_new.local_rank(ik);
+        if (rank_old == rank_new) {
+            continue;
+        }
+        nmig++;
+        if (comm().rank() == rank_new) {
+            kpoints_[ik]->initialize();
+        }
+        int num_sc = ctx_.num_spins();
+        for (int ispn = 0; ispn < num_sc; ispn++) {
+            int tag = Communicator::get_tag(rank_old, rank_new) + ispn;
+            if (comm().rank() == rank_old) {
+                auto& psi = kpoints_[ik]->spinor_wave_functions();
+                comm().send(psi.pw_coeffs(ispn).prime().at(memory_t::host),
+                            kpoints_[ik]->num_gkvec_loc() * ctx_.num_bands(), rank_new, tag);
+            }
+            if (comm().rank() == rank_new) {
+                auto& psi = kpoints_[ik]->spinor_wave_functions();
+                comm().recv(psi.pw_coeffs(ispn).prime().at(memory_t::host),
+                            kpoints_[ik]->num_gkvec_loc() * ctx_.num_bands(), rank_old, tag);
+            }
+        }
+        /* release the k-point on the old rank and keep only band energies and occupancies */
+        if (comm().rank() == rank_old) {
+            auto vk = kpoints_[ik]->vk();
+            std::unique_ptr<K_point> kp(new K_point(ctx_, &vk[0], kpoints_[ik]->weight()));
+            for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+                for (int j = 0; j < ctx_.num_bands(); j++) {
+                    kp->band_energy(j, ispn, kpoints_[ik]->band_energy(j, ispn));
+                    kp->band_occupancy(j, ispn, kpoints_[ik]->band_occupancy(j, ispn));
+                }
+            }
+            kpoints_[ik] = std::move(kp);
+        }
+    }
+    spl_num_kpoints_ = spl_new;
+    solve_time_      = std::vector<double>(num_kpoints(), 0);
+
+    ctx_.message(1, __function_name__, "load imbalance: %f, number of migrated k-points: %i\n", imbalance, nmig);
+}
+
 void K_point_set::sync_band_occupancies()
 {
     int nranks = comm().size();
@@ -159,19 +323,91 @@ void K_point_set::sync_band_occupancies()
     }
 }
 
-void K_point_set::find_band_occupancies()
+/// Compute the number of electrons and its derivative with respect to the Fermi energy.
+/** Band energies and weights (k-point weight times maximum occupancy) are stored in flat contiguous arrays, so
+ *  the loop over all (band, spin, k-point) triplets is vectorized. */
+template <typename S>
+static void
+count_electrons(int n__, double const* e__, double const* w__, double ef__, double width__, double& ne__,
+                double& dne__)
 {
-    PROFILE("sirius::K_point_set::find_band_occupancies");
+    double ne{0};
+    double dne{0};
+    #pragma omp parallel for simd schedule(static) reduction(+:ne,dne)
+    for (int i = 0; i < n__; i++) {
+        double x = (e__[i] - ef__) / width__;
+        ne += w__[i] * S::occupancy(x);
+        dne += w__[i] * S::delta(x);
+    }
+    ne__  = ne;
+    dne__ = dne / width__;
+}
 
-    double ef{0};
-    double de{0.1};
+/// Find the Fermi energy by a bracketed Newton search and compute the band occupancies.
+/** The bracket [emin - 40 width, emax + 40 width] contains the root of the electron count function for all
+ *  smearing types. Newton step is taken when it stays inside the bracket, otherwise the bracket is bisected.
+ *  The smearing contribution -TS to the free energy is returned in ts__. */
+template <typename S>
+static double
+find_fermi_energy(int n__, double const* e__, double const* w__, double width__, double ne_target__, double ef0__,
+                  double* occ__, double& ts__)
+{
+    auto minmax = std::minmax_element(e__, e__ + n__);
 
-    int s{1};
-    int sp;
+    double lo = *minmax.first - 40 * width__;
+    double hi = *minmax.second + 40 * width__;
 
-    mdarray<double, 3> bnd_occ(ctx_.num_bands(), ctx_.num_spin_dims(), num_kpoints());
+    double ne, dne;
+    count_electrons<S>(n__, e__, w__, hi, width__, ne, dne);
+    if (ne < ne_target__) {
+        std::stringstream s;
+        s << "not enough bands to accommodate " << ne_target__ << " electrons";
+        TERMINATE(s);
+    }
 
-    double ne{0};
+    /* start from the previous Fermi energy if it is inside the bracket */
+    double ef = (ef0__ > lo && ef0__ < hi) ? ef0__ : 0.5 * (lo + hi);
+
+    for (int step = 0; step < 200; step++) {
+        count_electrons<S>(n__, e__, w__, ef, width__, ne, dne);
+        double f = ne - ne_target__;
+        if (std::abs(f) < 1e-11) {
+            break;
+        }
+        if (f < 0) {
+            lo = ef;
+        } else {
+            hi = ef;
+        }
+        /* bracket can't be reduced any further */
+        if (hi - lo < 1e-14 * std::max(1.0, std::abs(ef))) {
+            break;
+        }
+        double ef_new = (dne > 0) ? ef - f / dne : hi;
+        if (ef_new <= lo || ef_new >= hi) {
+            ef_new = 0.5 * (lo + hi);
+        }
+        ef = ef_new;
+        if (step == 199) {
+            TERMINATE("search of the Fermi energy failed after 200 steps");
+        }
+    }
+
+    double ts{0};
+    #pragma omp parallel for simd schedule(static) reduction(+:ts)
+    for (int i = 0; i < n__; i++) {
+        double x = (e__[i] - ef) / width__;
+        occ__[i] = S::occupancy(x);
+        ts += w__[i] * S::entropy(x);
+    }
+    ts__ = ts * width__;
+
+    return ef;
+}
+
+void K_point_set::find_band_occupancies()
+{
+    PROFILE("sirius::K_point_set::find_band_occupancies");
 
     /* target number of electrons */
     double ne_target = unit_cell_.num_valence_electrons() - ctx_.parameters_input().extra_charge_;
@@ -190,46 +426,56 @@ void K_point_set::find_band_occupancies()
             }
         }
         energy_fermi_ = efermi;
+        entropy_sum_  = 0;
         return;
     }
 
-    int step{0};
-    /* calculate occupations */
-    while (std::abs(ne - ne_target) >= 1e-11) {
-        /* update Efermi */
-        ef += de;
-        /* compute total number of electrons */
-        ne = 0.0;
-        for (int ik = 0; ik < num_kpoints(); ik++) {
-            for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
-                for (int j = 0; j < ctx_.num_bands(); j++) {
-                    bnd_occ(j, ispn, ik) =
-                        smearing::gaussian(kpoints_[ik]->band_energy(j, ispn) - ef, ctx_.smearing_width()) *
-                        ctx_.max_occupancy();
-                    ne += bnd_occ(j, ispn, ik) * kpoints_[ik]->weight();
-                }
+    /* flat arrays of band energies, weights and occupancies */
+    int n = ctx_.num_bands() * ctx_.num_spin_dims() * num_kpoints();
+    mdarray<double, 3> bnd_e(ctx_.num_bands(), ctx_.num_spin_dims(), num_kpoints());
+    mdarray<double, 3> bnd_w(ctx_.num_bands(), ctx_.num_spin_dims(), num_kpoints());
+    mdarray<double, 3> bnd_occ(ctx_.num_bands(), ctx_.num_spin_dims(), num_kpoints());
+
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+            for (int j = 0; j < ctx_.num_bands(); j++) {
+                bnd_e(j, ispn, ik) = kpoints_[ik]->band_energy(j, ispn);
+                bnd_w(j, ispn, ik) = kpoints_[ik]->weight() * ctx_.max_occupancy();
             }
         }
+    }
 
-        sp = s;
-        s  = (ne > ne_target) ? -1 : 1;
-        /* reduce de step if we change the direction, otherwise increase the step */
-        de = (s != sp) ? (-de * 0.5) : (de * 1.25);
+    double const* e = bnd_e.at(memory_t::host);
+    double const* w = bnd_w.at(memory_t::host);
+    double* occ     = bnd_occ.at(memory_t::host);
+    double width    = ctx_.smearing_width();
+    double ef0      = energy_fermi_;
 
-        if (step > 10000) {
-            std::stringstream s;
-            s << "search of band occupancies failed after 10000 steps";
-            TERMINATE(s);
+    switch (ctx_.smearing()) {
+        case smearing_t::gaussian: {
+            energy_fermi_ = find_fermi_energy<smearing::gaussian>(n, e, w, width, ne_target, ef0, occ, entropy_sum_);
+            break;
+        }
+        case smearing_t::fermi_dirac: {
+            energy_fermi_ =
+                find_fermi_energy<smearing::fermi_dirac>(n, e, w, width, ne_target, ef0, occ, entropy_sum_);
+            break;
+        }
+        case smearing_t::methfessel_paxton: {
+            energy_fermi_ =
+                find_fermi_energy<smearing::methfessel_paxton>(n, e, w, width, ne_target, ef0, occ, entropy_sum_);
+            break;
+        }
+        case smearing_t::cold: {
+            energy_fermi_ = find_fermi_energy<smearing::cold>(n, e, w, width, ne_target, ef0, occ, entropy_sum_);
+            break;
         }
-        step++;
     }
 
-    energy_fermi_ = ef;
-
     for (int ik = 0; ik < num_kpoints(); ik++) {
         for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
             for (int j = 0; j < ctx_.num_bands(); j++) {
-                kpoints_[ik]->band_occupancy(j, ispn, bnd_occ(j, ispn, ik));
+                kpoints_[ik]->band_occupancy(j, ispn, bnd_occ(j, ispn, ik) * ctx_.max_occupancy());
             }
         }
     }
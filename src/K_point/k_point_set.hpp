@@ -58,10 +58,25 @@ class K_point_set
 
     double band_gap_{0};
 
+    /// Smearing contribution -TS to the free energy.
+    double entropy_sum_{0};
+
     Unit_cell& unit_cell_;
 
+    /// Measured wall-time of the band solver for each k-point.
+    /** Only local k-points have a non-zero value on a given MPI rank. */
+    std::vector<double> solve_time_;
+
     K_point_set(K_point_set& src) = delete;
 
+    /// Estimate the cost of each k-point as the number of G+k vectors times the number of bands.
+    std::vector<double> estimate_cost() const;
+
+    /// Split k-points in contiguous chunks with approximately equal total cost.
+    /** The maximum chunk cost is minimized by a bisection search over the bottleneck value with greedy filling of
+     *  the chunks. Chunks are contiguous because the rest of the code relies on a chunk distribution of k-points. */
+    std::vector<int> balanced_counts(std::vector<double> const& cost__) const;
+
     void create_k_mesh(vector3d<int> k_grid__,
                        vector3d<int> k_shift__,
                        int           use_symmetry__);
@@ -111,6 +126,21 @@ class K_point_set
     /// Initialize the k-point set
     void initialize(std::vector<int> const& counts = {});
 
+    /// Redistribute k-points between MPI ranks using the measured time of the band solver.
+    /** Redistribution is done only if the load imbalance exceeds the threshold given by
+     *  Control_input::kpoints_rebalance_threshold_. Wave-functions of the migrated k-points are sent to their new
+     *  owners. Only the pseudopotential case is supported. */
+    void rebalance();
+
+    /// Store the measured time of the band solver for a given k-point.
+    /** Called concurrently by the teams of the band solver; each team writes its own k-point and the vector is
+        sized in initialize() and rebalance(). */
+    inline void solve_time(int ik__, double t__)
+    {
+        assert(ik__ >= 0 && ik__ < static_cast<int>(solve_time_.size()));
+        solve_time_[ik__] = t__;
+    }
+
     /// Update k-points after moving atoms or changing the lattice vectors.
     void update()
     {
@@ -228,6 +258,12 @@ class K_point_set
         return band_gap_;
     }
 
+    /// Return the smearing contribution -TS to the free energy.
+    inline double entropy_sum() const
+    {
+        return entropy_sum_;
+    }
+
     /// Find index of k-point.
     inline int find_kpoint(vector3d<double> vk__)
     {
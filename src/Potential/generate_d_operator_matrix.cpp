@@ -83,8 +83,21 @@ void Potential::generate_D_operator_matrix()
 
         ctx_.print_memory_usage(__FILE__, __LINE__);
 
+        /* cached phase factors are used directly as the second operand of GEMM; V(G) is then moved to Q(G) */
+        bool use_pf_cache = (ctx_.processing_unit() == device_t::CPU) && ctx_.phase_factors_cached();
+
         for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
-            matrix<double> veff_a(2 * spl_ngv_loc.local_size(), atom_type.num_atoms(), ctx_.mem_pool(memory_t::host));
+            /* V(G) * exp(i * G * r_{alpha}) */
+            matrix<double> veff_a;
+            /* Q(G) * V^{*}(G) */
+            matrix<double> qv_pw;
+            if (use_pf_cache) {
+                qv_pw = matrix<double>(nbf * (nbf + 1) / 2, 2 * spl_ngv_loc.local_size(),
+                                       ctx_.mem_pool(memory_t::host));
+            } else {
+                veff_a = matrix<double>(2 * spl_ngv_loc.local_size(), atom_type.num_atoms(),
+                                        ctx_.mem_pool(memory_t::host));
+            }
 
             auto la = linalg_t::blas;
             auto mem = memory_t::host;
@@ -102,16 +115,33 @@ void Potential::generate_D_operator_matrix()
                 int g_begin = spl_ngv_loc.global_index(0, ib);
                 int g_end = g_begin + spl_ngv_loc.local_size(ib);
 
+                if (use_pf_cache) {
+                    auto& q_pw = ctx_.augmentation_op(iat)->q_pw();
+                    #pragma omp parallel for schedule(static)
+                    for (int igloc = g_begin; igloc < g_end; igloc++) {
+                        auto v = std::conj(component(iv).f_pw_local(igloc));
+                        for (int j = 0; j < nbf * (nbf + 1) / 2; j++) {
+                            auto z = double_complex(q_pw(j, 2 * igloc), q_pw(j, 2 * igloc + 1)) * v;
+                            qv_pw(j, 2 * (igloc - g_begin))     = z.real();
+                            qv_pw(j, 2 * (igloc - g_begin) + 1) = z.imag();
+                        }
+                    }
+                    auto& pf = ctx_.phase_factors_cache(iat);
+                    linalg(la).gemm('N', 'N', nbf * (nbf + 1) / 2, atom_type.num_atoms(),
+                                    2 * spl_ngv_loc.local_size(ib), &linalg_const<double>::one(),
+                                    qv_pw.at(memory_t::host), qv_pw.ld(),
+                                    reinterpret_cast<double const*>(pf.at(memory_t::host, g_begin, 0)), 2 * pf.ld(),
+                                    &linalg_const<double>::one(), d_tmp.at(memory_t::host), d_tmp.ld());
+                    continue;
+                }
+
                 switch (ctx_.processing_unit()) {
                     case device_t::CPU: {
                         #pragma omp parallel for schedule(static)
                         for (int i = 0; i < atom_type.num_atoms(); i++) {
-                            int ia = atom_type.atom_id(i);
-
                             for (int igloc = g_begin; igloc < g_end; igloc++) {
-                                int ig = ctx_.gvec().offset() + igloc;
                                 /* V(G) * exp(i * G * r_{alpha}) */
-                                auto z = component(iv).f_pw_local(igloc) * ctx_.gvec_phase_factor(ig, ia);
+                                auto z = component(iv).f_pw_local(igloc) * ctx_.gvec_phase_factor_loc(igloc, iat, i);
                                 veff_a(2 * (igloc - g_begin),     i) = z.real();
                                 veff_a(2 * (igloc - g_begin) + 1, i) = z.imag();
                             }
@@ -248,7 +248,8 @@ double Potential::xc_mt_PAW_noncollinear(std::vector<sf>& potential, std::vector
     Spheric_function<function_domain_t::spatial, double> rho_d_tp(sht_->num_points(), rgrid);
 
     for (int ir = 0; ir < rgrid.num_points(); ir++) {
-        for (int itp = 0; itp < sht_->num_points(); itp++) {
+        int ntp = sht_->num_points(ir, rgrid.num_points());
+        for (int itp = 0; itp < ntp; itp++) {
             vector3d<double> magn({rho_tp[2](itp, ir), rho_tp[3](itp, ir), rho_tp[1](itp, ir)});
             double norm = magn.length();
 
@@ -281,7 +282,8 @@ double Potential::xc_mt_PAW_noncollinear(std::vector<sf>& potential, std::vector
 
     /* transform back potential from up/down to 4D form*/
     for (int ir = 0; ir < rgrid.num_points(); ir++) {
-        for (int itp = 0; itp < sht_->num_points(); itp++) {
+        int ntp = sht_->num_points(ir, rgrid.num_points());
+        for (int itp = 0; itp < ntp; itp++) {
             /* get total potential and field abs value*/
             double pot   = 0.5 * (vxc_u_tp(itp, ir) + vxc_d_tp(itp, ir));
             double field = 0.5 * (vxc_u_tp(itp, ir) - vxc_d_tp(itp, ir));
@@ -78,7 +78,8 @@ class Potential : public Field4D
 
     int lmax_;
 
-    std::unique_ptr<SHT> sht_;
+    /// Spherical meshes of the muffin-tin spheres.
+    std::unique_ptr<SHT_hierarchy> sht_;
 
     int pseudo_density_order_{9};
 
@@ -98,6 +99,19 @@ class Potential : public Field4D
 
     std::vector<XC_functional> xc_func_;
 
+    /// Scratch space of the XC kernels on the regular grid (block of points, 6 arrays, thread).
+    /** Kept between the SCF iterations. */
+    mdarray<double, 3> xc_scratch_;
+
+    /// Independent copies of the dense FFT driver used in the batched transforms of the GGA terms.
+    /** Kept between the SCF iterations unless the memory usage is set to "low". */
+    std::vector<spfft::Transform> spfft_gga_;
+
+    /// Gradients of the spin-up and spin-down densities on the regular grid.
+    /** Kept between the SCF iterations unless the memory usage is set to "low"; the buffers are reused for the
+        vsigma-weighted gradients. */
+    std::array<Smooth_periodic_vector_function<double>, 2> grad_rho_gga_;
+
     /// Plane-wave coefficients of the effective potential weighted by the unit step-function.
     mdarray<double_complex, 1> veff_pw_;
 
@@ -300,6 +314,50 @@ class Potential : public Field4D
     /// Generate XC potential in the muffin-tins.
     void xc_mt(Density const& density__);
 
+    /// Allocate scratch space of the XC kernels for all threads if it is not yet allocated.
+    inline void allocate_xc_scratch()
+    {
+        /* number of grid points processed by a thread at once */
+        int const block_size{2048};
+        if (static_cast<int>(xc_scratch_.size(2)) < omp_get_max_threads()) {
+            xc_scratch_ = mdarray<double, 3>(block_size, 6, omp_get_max_threads(), memory_t::host, "xc_scratch_");
+        }
+    }
+
+    /// Allocate FFT drivers and gradient buffers of the GGA terms if they are not yet allocated.
+    inline void allocate_gga_buffers(int num_spins__)
+    {
+        /* three Cartesian components for each spin channel are transformed at once */
+        while (static_cast<int>(spfft_gga_.size()) < 3 * num_spins__) {
+            spfft_gga_.emplace_back(ctx_.spfft().clone());
+        }
+        for (int is = 0; is < num_spins__; is++) {
+            if (grad_rho_gga_[is][0].f_rg().size() == 0) {
+                grad_rho_gga_[is] = Smooth_periodic_vector_function<double>(ctx_.spfft(), ctx_.gvec_partition());
+            }
+        }
+    }
+
+    /// Release FFT drivers and gradient buffers of the GGA terms.
+    inline void deallocate_gga_buffers()
+    {
+        spfft_gga_.clear();
+        for (auto& e : grad_rho_gga_) {
+            e = Smooth_periodic_vector_function<double>();
+        }
+    }
+
+    /// Compute gradients of the spin densities and the contracted gradients on the regular grid.
+    /** Densities are given on the real-space grid and are transformed to the plane-wave domain. For one spin
+     *  channel sigma = grad rho * grad rho; for two spin channels sigma is computed for (up, up), (up, dn) and
+     *  (dn, dn) pairs. */
+    void xc_rg_grad_rho(std::vector<Smooth_periodic_function<double>*> rho__,
+                        std::vector<Smooth_periodic_function<double>*> sigma__);
+
+    /// Subtract divergence of the vsigma-weighted gradients from the XC potential of each spin channel.
+    /** Must be called after xc_rg_grad_rho(); gradient buffers are overwritten. */
+    void xc_rg_div_vsigma_grad_rho(std::vector<double const*> vsigma__, std::vector<double*> vxc__);
+
     /// Generate non-magnetic XC potential on the regular real-space grid.
     template <bool add_pseudo_core__>
     void xc_rg_nonmagnetic(Density const& density__);
@@ -324,7 +382,15 @@ class Potential : public Field4D
         lmax_ = std::max(ctx_.lmax_rho(), ctx_.lmax_pot());
 
         if (lmax_ >= 0) {
-            sht_  = std::unique_ptr<SHT>(new SHT(ctx_.processing_unit(), lmax_, ctx_.settings().sht_coverage_));
+            /* reduced spherical mesh close to the nucleus */
+            std::vector<std::pair<double, int>> levels;
+            double x = ctx_.settings().sht_inner_fraction_;
+            int l    = (ctx_.settings().sht_inner_lmax_ < 0) ? lmax_ / 2 : ctx_.settings().sht_inner_lmax_;
+            if (x > 0 && l < lmax_) {
+                levels.push_back(std::make_pair(x, l));
+            }
+            sht_ = std::unique_ptr<SHT_hierarchy>(
+                new SHT_hierarchy(ctx_.processing_unit(), lmax_, ctx_.settings().sht_coverage_, levels));
             if (ctx_.control().verification_ >= 1)  {
                 sht_->check();
             }
@@ -347,6 +413,9 @@ class Potential : public Field4D
         /* create list of XC functionals */
         for (auto& xc_label : ctx_.xc_functionals()) {
             xc_func_.push_back(std::move(XC_functional(ctx_.spfft(), ctx_.unit_cell().lattice_vectors(), xc_label, ctx_.num_spins())));
+            if (ctx_.settings().xc_native_) {
+                xc_func_.back().use_native(ctx_.settings().xc_dens_threshold_);
+            }
         }
 
         using pf = Periodic_function<double>;
@@ -84,8 +84,9 @@ void Potential::xc_mt_nonmagnetic(Radial_grid<double> const& rgrid,
             std::vector<double> exc_t(sht_->num_points());
             std::vector<double> vxc_t(sht_->num_points());
             for (int ir = 0; ir < rgrid.num_points(); ir++) {
-                ixc.get_lda(sht_->num_points(), &rho_tp(0, ir), &vxc_t[0], &exc_t[0]);
-                for (int itp = 0; itp < sht_->num_points(); itp++) {
+                int ntp = sht_->num_points(ir, rgrid.num_points());
+                ixc.get_lda(ntp, &rho_tp(0, ir), &vxc_t[0], &exc_t[0]);
+                for (int itp = 0; itp < ntp; itp++) {
                     /* add Exc contribution */
                     exc_tp(itp, ir) += exc_t[itp];
 
@@ -99,8 +100,9 @@ void Potential::xc_mt_nonmagnetic(Radial_grid<double> const& rgrid,
             std::vector<double> vrho_t(sht_->num_points());
             std::vector<double> vsigma_t(sht_->num_points());
             for (int ir = 0; ir < rgrid.num_points(); ir++) {
-                ixc.get_gga(sht_->num_points(), &rho_tp(0, ir), &grad_rho_grad_rho_tp(0, ir), &vrho_t[0], &vsigma_t[0], &exc_t[0]);
-                for (int itp = 0; itp < sht_->num_points(); itp++) {
+                int ntp = sht_->num_points(ir, rgrid.num_points());
+                ixc.get_gga(ntp, &rho_tp(0, ir), &grad_rho_grad_rho_tp(0, ir), &vrho_t[0], &vsigma_t[0], &exc_t[0]);
+                for (int itp = 0; itp < ntp; itp++) {
                     /* add Exc contribution */
                     exc_tp(itp, ir) += exc_t[itp];
 
@@ -138,7 +140,8 @@ void Potential::xc_mt_nonmagnetic(Radial_grid<double> const& rgrid,
 
             /* add remaining term to Vxc */
             for (int ir = 0; ir < rgrid.num_points(); ir++) {
-                for (int itp = 0; itp < sht_->num_points(); itp++) {
+                int ntp = sht_->num_points(ir, rgrid.num_points());
+                for (int itp = 0; itp < ntp; itp++) {
                     vxc_tp(itp, ir) -= 2 * grad_vsigma_grad_rho_tp(itp, ir);
                 }
             }
@@ -152,7 +155,8 @@ void Potential::xc_mt_nonmagnetic(Radial_grid<double> const& rgrid,
             auto div_vsigma_grad_rho_tp = transform(*sht_, div_vsigma_grad_rho_lm);
             /* add remaining term to Vxc */
             for (int ir = 0; ir < rgrid.num_points(); ir++) {
-                for (int itp = 0; itp < sht_->num_points(); itp++) {
+                int ntp = sht_->num_points(ir, rgrid.num_points());
+                for (int itp = 0; itp < ntp; itp++) {
                     vxc_tp(itp, ir) -= 2 * div_vsigma_grad_rho_tp(itp, ir);
                 }
             }
@@ -235,8 +239,9 @@ void Potential::xc_mt_magnetic(Radial_grid<double> const& rgrid,
             std::vector<double> vxc_up_t(sht_->num_points());
             std::vector<double> vxc_dn_t(sht_->num_points());
             for (int ir = 0; ir < rgrid.num_points(); ir++) {
-                ixc.get_lda(sht_->num_points(), &rho_up_tp(0, ir), &rho_dn_tp(0, ir), &vxc_up_t[0], &vxc_dn_t[0], &exc_t[0]);
-                for (int itp = 0; itp < sht_->num_points(); itp++) {
+                int ntp = sht_->num_points(ir, rgrid.num_points());
+                ixc.get_lda(ntp, &rho_up_tp(0, ir), &rho_dn_tp(0, ir), &vxc_up_t[0], &vxc_dn_t[0], &exc_t[0]);
+                for (int itp = 0; itp < ntp; itp++) {
                     /* add Exc contribution */
                     exc_tp(itp, ir) += exc_t[itp];
 
@@ -254,7 +259,8 @@ void Potential::xc_mt_magnetic(Radial_grid<double> const& rgrid,
             std::vector<double> vsigma_ud_t(sht_->num_points());
             std::vector<double> vsigma_dd_t(sht_->num_points());
             for (int ir = 0; ir < rgrid.num_points(); ir++) {
-                ixc.get_gga(sht_->num_points(),
+                int ntp = sht_->num_points(ir, rgrid.num_points());
+                ixc.get_gga(ntp,
                             &rho_up_tp(0, ir),
                             &rho_dn_tp(0, ir),
                             &grad_rho_up_grad_rho_up_tp(0, ir),
@@ -267,7 +273,7 @@ void Potential::xc_mt_magnetic(Radial_grid<double> const& rgrid,
                             &vsigma_dd_t[0],
                             &exc_t[0]);
 
-                for (int itp = 0; itp < sht_->num_points(); itp++) {
+                for (int itp = 0; itp < ntp; itp++) {
                     /* add Exc contribution */
                     exc_tp(itp, ir) += exc_t[itp];
 
@@ -313,7 +319,8 @@ void Potential::xc_mt_magnetic(Radial_grid<double> const& rgrid,
 
         /* add remaining terms to Vxc */
         for (int ir = 0; ir < rgrid.num_points(); ir++) {
-            for (int itp = 0; itp < sht_->num_points(); itp++) {
+            int ntp = sht_->num_points(ir, rgrid.num_points());
+            for (int itp = 0; itp < ntp; itp++) {
                 vxc_up_tp(itp, ir) -= (2 * grad_vsigma_uu_grad_rho_up_tp(itp, ir) + grad_vsigma_ud_grad_rho_dn_tp(itp, ir));
                 vxc_dn_tp(itp, ir) -= (2 * grad_vsigma_dd_grad_rho_dn_tp(itp, ir) + grad_vsigma_ud_grad_rho_up_tp(itp, ir));
             }
@@ -325,141 +332,309 @@ void Potential::xc_mt(Density const& density__)
 {
     PROFILE("sirius::Potential::xc_mt");
 
-    #pragma omp parallel for
+    int ntp  = sht_->num_points();
+    int nmag = ctx_.num_mag_dims();
+
+    /* upper limit for the number of (theta, phi, r) points of the batch of atoms */
+    int const max_batch_points = 1 << 22;
+
+    /* atoms of the same type share the radial grid and are transformed together */
+    std::vector<std::vector<int>> atoms_by_type(unit_cell_.num_atom_types());
     for (int ialoc = 0; ialoc < unit_cell_.spl_num_atoms().local_size(); ialoc++) {
         int ia = unit_cell_.spl_num_atoms(ialoc);
-        auto& rgrid = unit_cell_.atom(ia).radial_grid();
-        int nmtp = unit_cell_.atom(ia).num_mt_points();
-
-        /* backward transform density from Rlm to (theta, phi) */
-        auto rho_tp = transform(*sht_, density__.rho().f_mt(ialoc));
+        atoms_by_type[unit_cell_.atom(ia).type_id()].push_back(ialoc);
+    }
 
-        /* backward transform magnetization from Rlm to (theta, phi) */
-        std::vector<Spheric_function<function_domain_t::spatial, double> > vecmagtp(ctx_.num_mag_dims());
-        for (int j = 0; j < ctx_.num_mag_dims(); j++) {
-            vecmagtp[j] = transform(*sht_, density__.magnetization(j).f_mt(ialoc));
+    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+        auto& atoms = atoms_by_type[iat];
+        if (atoms.empty()) {
+            continue;
         }
+        auto& rgrid = unit_cell_.atom_type(iat).radial_grid();
+        int nmtp    = unit_cell_.atom_type(iat).num_mt_points();
+        /* size of the Rlm expansion of the density */
+        int lmmax_rho = density__.rho().f_mt(atoms[0]).angular_domain_size();
 
-        /* "up" component of the density */
-        Spheric_function<function_domain_t::spectral, double> rho_up_lm;
-        Spheric_function<function_domain_t::spatial, double> rho_up_tp(sht_->num_points(), rgrid);
+        int nb = std::max(1, std::min(static_cast<int>(atoms.size()), max_batch_points / (ntp * nmtp)));
 
-        /* "dn" component of the density */
-        Spheric_function<function_domain_t::spectral, double> rho_dn_lm;
-        Spheric_function<function_domain_t::spatial, double> rho_dn_tp(sht_->num_points(), rgrid);
+        for (int i0 = 0; i0 < static_cast<int>(atoms.size()); i0 += nb) {
+            int na = std::min(nb, static_cast<int>(atoms.size()) - i0);
+            int nr = na * nmtp;
 
-        /* check if density has negative values */
-        double rhomin = 0.0;
-        for (int ir = 0; ir < nmtp; ir++) {
-            for (int itp = 0; itp < sht_->num_points(); itp++) {
-                rhomin = std::min(rhomin, rho_tp(itp, ir));
+            /* Rlm expansion of the density and magnetization of the batch of atoms */
+            mdarray<double, 3> f_lm(lmmax_rho, nr, 1 + nmag);
+            #pragma omp parallel for
+            for (int i = 0; i < na; i++) {
+                int ialoc = atoms[i0 + i];
+                for (int j = 0; j < 1 + nmag; j++) {
+                    auto& f = (j == 0) ? density__.rho().f_mt(ialoc) : density__.magnetization(j - 1).f_mt(ialoc);
+                    std::copy(&f(0, 0), &f(0, 0) + lmmax_rho * nmtp, &f_lm(0, i * nmtp, j));
+                }
+            }
+            /* backward transform density and magnetization from Rlm to (theta, phi) for all atoms at once;
+               after the XC kernel magnetization is replaced by the XC magnetic field */
+            mdarray<double, 3> f_tp(ntp, nr, 1 + nmag);
+            for (int j = 0; j < 1 + nmag; j++) {
+                sht_->backward_transform(lmmax_rho, &f_lm(0, 0, j), nmtp, std::min(sht_->lmmax(), lmmax_rho),
+                                         &f_tp(0, 0, j), na);
             }
-        }
 
-        if (rhomin < 0.0 && std::abs(rhomin) > 1e-9) {
-            std::stringstream s;
-            s << "Charge density for atom " << ia << " has negative values" << std::endl
-              << "most negatve value : " << rhomin << std::endl
-              << "current Rlm expansion of the charge density may be not sufficient, try to increase lmax_rho";
-            WARNING(s);
-        }
+            /* XC potential and energy density in (theta, phi) */
+            mdarray<double, 3> v_tp(ntp, nr, 2);
+            /* scratch space for the "up" and "dn" components of the density and potential */
+            mdarray<double, 3> ud_tp;
+            if (ctx_.num_spins() == 2) {
+                ud_tp = mdarray<double, 3>(ntp, nr, 4);
+            }
 
-        if (ctx_.num_spins() == 1) {
-            for (int ir = 0; ir < nmtp; ir++) {
-                /* fix negative density */
-                for (int itp = 0; itp < sht_->num_points(); itp++) {
-                    if (rho_tp(itp, ir) < 0.0) {
-                        rho_tp(itp, ir) = 0.0;
-                    }
+            #pragma omp parallel for
+            for (int i = 0; i < na; i++) {
+                int ialoc = atoms[i0 + i];
+                int ia    = unit_cell_.spl_num_atoms(ialoc);
+                int ir0   = i * nmtp;
+
+                Spheric_function<function_domain_t::spatial, double> rho_tp(&f_tp(0, ir0, 0), ntp, rgrid);
+
+                std::vector<Spheric_function<function_domain_t::spatial, double>> vecmagtp(nmag);
+                for (int j = 0; j < nmag; j++) {
+                    vecmagtp[j] =
+                        Spheric_function<function_domain_t::spatial, double>(&f_tp(0, ir0, 1 + j), ntp, rgrid);
                 }
-            }
-        } else {
-            for (int ir = 0; ir < nmtp; ir++) {
-                for (int itp = 0; itp < sht_->num_points(); itp++) {
-                    /* compute magnitude of the magnetization vector */
-                    double mag = 0.0;
-                    for (int j = 0; j < ctx_.num_mag_dims(); j++) {
-                        mag += std::pow(vecmagtp[j](itp, ir), 2);
-                    }
-                    mag = std::sqrt(mag);
 
-                    /* in magnetic case fix both density and magnetization */
-                    for (int itp = 0; itp < sht_->num_points(); itp++) {
-                        if (rho_tp(itp, ir) < 0.0) {
-                            rho_tp(itp, ir) = 0.0;
-                            mag = 0.0;
-                        }
-                        /* fix numerical noise at high values of magnetization */
-                        mag = std::min(mag, rho_tp(itp, ir));
+                Spheric_function<function_domain_t::spatial, double> vxc_tp(&v_tp(0, ir0, 0), ntp, rgrid);
+                Spheric_function<function_domain_t::spatial, double> exc_tp(&v_tp(0, ir0, 1), ntp, rgrid);
 
-                        /* compute "up" and "dn" components */
-                        rho_up_tp(itp, ir) = 0.5 * (rho_tp(itp, ir) + mag);
-                        rho_dn_tp(itp, ir) = 0.5 * (rho_tp(itp, ir) - mag);
+                /* check if density has negative values */
+                double rhomin = 0.0;
+                for (int ir = 0; ir < nmtp; ir++) {
+                    int ntp_ir = sht_->num_points(ir, nmtp);
+                    for (int itp = 0; itp < ntp_ir; itp++) {
+                        rhomin = std::min(rhomin, rho_tp(itp, ir));
                     }
                 }
-            }
 
-            /* transform from (theta, phi) to Rlm */
-            rho_up_lm = transform(*sht_, rho_up_tp);
-            rho_dn_lm = transform(*sht_, rho_dn_tp);
-        }
-
-        Spheric_function<function_domain_t::spatial, double> exc_tp(sht_->num_points(), rgrid);
-        Spheric_function<function_domain_t::spatial, double> vxc_tp(sht_->num_points(), rgrid);
+                if (rhomin < 0.0 && std::abs(rhomin) > 1e-9) {
+                    std::stringstream s;
+                    s << "Charge density for atom " << ia << " has negative values" << std::endl
+                      << "most negatve value : " << rhomin << std::endl
+                      << "current Rlm expansion of the charge density may be not sufficient, try to increase lmax_rho";
+                    WARNING(s);
+                }
 
-        if (ctx_.num_spins() == 1) {
-            xc_mt_nonmagnetic(rgrid, xc_func_, density__.rho().f_mt(ialoc), rho_tp, vxc_tp, exc_tp);
-        } else {
-            Spheric_function<function_domain_t::spatial, double> vxc_up_tp(sht_->num_points(), rgrid);
-            Spheric_function<function_domain_t::spatial, double> vxc_dn_tp(sht_->num_points(), rgrid);
-
-            xc_mt_magnetic(rgrid, xc_func_, rho_up_lm, rho_up_tp, rho_dn_lm, rho_dn_tp, vxc_up_tp, vxc_dn_tp, exc_tp);
-
-            for (int ir = 0; ir < nmtp; ir++) {
-                for (int itp = 0; itp < sht_->num_points(); itp++) {
-                    /* align magnetic filed parallel to magnetization */
-                    /* use vecmagtp as temporary vector */
-                    double mag =  rho_up_tp(itp, ir) - rho_dn_tp(itp, ir);
-                    if (mag > 1e-8) {
-                        /* |Bxc| = 0.5 * (V_up - V_dn) */
-                        double b = 0.5 * (vxc_up_tp(itp, ir) - vxc_dn_tp(itp, ir));
-                        for (int j = 0; j < ctx_.num_mag_dims(); j++) {
-                            vecmagtp[j](itp, ir) = b * vecmagtp[j](itp, ir) / mag;
+                if (ctx_.num_spins() == 1) {
+                    for (int ir = 0; ir < nmtp; ir++) {
+                        int ntp_ir = sht_->num_points(ir, nmtp);
+                        /* fix negative density */
+                        for (int itp = 0; itp < ntp_ir; itp++) {
+                            if (rho_tp(itp, ir) < 0.0) {
+                                rho_tp(itp, ir) = 0.0;
+                            }
                         }
-                    } else {
-                        for (int j = 0; j < ctx_.num_mag_dims(); j++) {
-                            vecmagtp[j](itp, ir) = 0.0;
+                    }
+                    xc_mt_nonmagnetic(rgrid, xc_func_, density__.rho().f_mt(ialoc), rho_tp, vxc_tp, exc_tp);
+                } else {
+                    /* "up" and "dn" components of the density */
+                    Spheric_function<function_domain_t::spatial, double> rho_up_tp(&ud_tp(0, ir0, 0), ntp, rgrid);
+                    Spheric_function<function_domain_t::spatial, double> rho_dn_tp(&ud_tp(0, ir0, 1), ntp, rgrid);
+
+                    for (int ir = 0; ir < nmtp; ir++) {
+                        int ntp_ir = sht_->num_points(ir, nmtp);
+                        for (int itp = 0; itp < ntp_ir; itp++) {
+                            /* compute magnitude of the magnetization vector */
+                            double mag = 0.0;
+                            for (int j = 0; j < nmag; j++) {
+                                mag += std::pow(vecmagtp[j](itp, ir), 2);
+                            }
+                            mag = std::sqrt(mag);
+
+                            /* in magnetic case fix both density and magnetization */
+                            for (int itp = 0; itp < ntp_ir; itp++) {
+                                if (rho_tp(itp, ir) < 0.0) {
+                                    rho_tp(itp, ir) = 0.0;
+                                    mag = 0.0;
+                                }
+                                /* fix numerical noise at high values of magnetization */
+                                mag = std::min(mag, rho_tp(itp, ir));
+
+                                /* compute "up" and "dn" components */
+                                rho_up_tp(itp, ir) = 0.5 * (rho_tp(itp, ir) + mag);
+                                rho_dn_tp(itp, ir) = 0.5 * (rho_tp(itp, ir) - mag);
+                            }
+                        }
+                    }
+
+                    /* transform from (theta, phi) to Rlm */
+                    auto rho_up_lm = transform(*sht_, rho_up_tp);
+                    auto rho_dn_lm = transform(*sht_, rho_dn_tp);
+
+                    Spheric_function<function_domain_t::spatial, double> vxc_up_tp(&ud_tp(0, ir0, 2), ntp, rgrid);
+                    Spheric_function<function_domain_t::spatial, double> vxc_dn_tp(&ud_tp(0, ir0, 3), ntp, rgrid);
+
+                    xc_mt_magnetic(rgrid, xc_func_, rho_up_lm, rho_up_tp, rho_dn_lm, rho_dn_tp, vxc_up_tp, vxc_dn_tp,
+                                   exc_tp);
+
+                    for (int ir = 0; ir < nmtp; ir++) {
+                        int ntp_ir = sht_->num_points(ir, nmtp);
+                        for (int itp = 0; itp < ntp_ir; itp++) {
+                            /* align magnetic filed parallel to magnetization */
+                            /* use vecmagtp as temporary vector */
+                            double mag =  rho_up_tp(itp, ir) - rho_dn_tp(itp, ir);
+                            if (mag > 1e-8) {
+                                /* |Bxc| = 0.5 * (V_up - V_dn) */
+                                double b = 0.5 * (vxc_up_tp(itp, ir) - vxc_dn_tp(itp, ir));
+                                for (int j = 0; j < nmag; j++) {
+                                    vecmagtp[j](itp, ir) = b * vecmagtp[j](itp, ir) / mag;
+                                }
+                            } else {
+                                for (int j = 0; j < nmag; j++) {
+                                    vecmagtp[j](itp, ir) = 0.0;
+                                }
+                            }
+                            /* Vxc = 0.5 * (V_up + V_dn) */
+                            vxc_tp(itp, ir) = 0.5 * (vxc_up_tp(itp, ir) + vxc_dn_tp(itp, ir));
                         }
                     }
-                    /* Vxc = 0.5 * (V_up + V_dn) */
-                    vxc_tp(itp, ir) = 0.5 * (vxc_up_tp(itp, ir) + vxc_dn_tp(itp, ir));
                 }
+            } // i
+
+            /* forward transform XC potential, energy density and magnetic field from (theta, phi) to Rlm for all
+               atoms at once */
+            mdarray<double, 3> v_lm(sht_->lmmax(), nr, 2 + nmag);
+            for (int j = 0; j < 2; j++) {
+                sht_->forward_transform(&v_tp(0, 0, j), nmtp, sht_->lmmax(), sht_->lmmax(), &v_lm(0, 0, j), na);
+            }
+            for (int j = 0; j < nmag; j++) {
+                sht_->forward_transform(&f_tp(0, 0, 1 + j), nmtp, sht_->lmmax(), sht_->lmmax(), &v_lm(0, 0, 2 + j),
+                                        na);
             }
+
             /* z, x, y order */
             std::array<int, 3> comp_map = {2, 0, 1};
-            /* convert magnetic field back to Rlm */
-            for (int j = 0; j < ctx_.num_mag_dims(); j++) {
-                auto bxcrlm = transform(*sht_, vecmagtp[j]);
+
+            #pragma omp parallel for
+            for (int i = 0; i < na; i++) {
+                int ialoc = atoms[i0 + i];
+                int ia    = unit_cell_.spl_num_atoms(ialoc);
+                int ir0   = i * nmtp;
+                for (int j = 0; j < nmag; j++) {
+                    for (int ir = 0; ir < nmtp; ir++) {
+                        /* add auxiliary magnetic field antiparallel to starting magnetization */
+                        v_lm(0, ir0 + ir, 2 + j) -=
+                            aux_bf_(j, ia) * ctx_.unit_cell().atom(ia).vector_field()[comp_map[j]];
+                        for (int lm = 0; lm < ctx_.lmmax_pot(); lm++) {
+                            effective_magnetic_field(j).f_mt<index_domain_t::local>(lm, ir, ialoc) =
+                                v_lm(lm, ir0 + ir, 2 + j);
+                        }
+                    }
+                }
                 for (int ir = 0; ir < nmtp; ir++) {
-                    /* add auxiliary magnetic field antiparallel to starting magnetization */
-                    bxcrlm(0, ir) -= aux_bf_(j, ia) * ctx_.unit_cell().atom(ia).vector_field()[comp_map[j]];
                     for (int lm = 0; lm < ctx_.lmmax_pot(); lm++) {
-                        effective_magnetic_field(j).f_mt<index_domain_t::local>(lm, ir, ialoc) = bxcrlm(lm, ir);
+                        xc_potential_->f_mt<index_domain_t::local>(lm, ir, ialoc)      = v_lm(lm, ir0 + ir, 0);
+                        xc_energy_density_->f_mt<index_domain_t::local>(lm, ir, ialoc) = v_lm(lm, ir0 + ir, 1);
                     }
                 }
             }
         }
+    }
+}
+
+void Potential::xc_rg_grad_rho(std::vector<Smooth_periodic_function<double>*> rho__,
+                               std::vector<Smooth_periodic_function<double>*> sigma__)
+{
+    PROFILE("sirius::Potential::xc_rg_grad_rho");
+
+    int ns = static_cast<int>(rho__.size());
+
+    allocate_gga_buffers(ns);
+
+    /* get plane-wave coefficients of densities */
+    sirius::fft_transform(rho__, spfft_gga_, -1);
+
+    /* generate pw coeffs of the gradients */
+    std::vector<Smooth_periodic_function<double>*> grad;
+    for (int is = 0; is < ns; is++) {
+        gradient(*rho__[is], grad_rho_gga_[is]);
+        for (int x : {0, 1, 2}) {
+            grad.push_back(&grad_rho_gga_[is][x]);
+        }
+    }
+    /* all Cartesian components of all spin channels are transformed to real space at once */
+    sirius::fft_transform(grad, spfft_gga_, 1);
+
+    auto& grad_up = grad_rho_gga_[0];
+    auto& grad_dn = grad_rho_gga_[ns - 1];
+
+    /* products of gradients */
+    #pragma omp parallel for schedule(static)
+    for (int ir = 0; ir < ctx_.spfft().local_slice_size(); ir++) {
+        double uu{0};
+        double ud{0};
+        double dd{0};
+        for (int x : {0, 1, 2}) {
+            uu += grad_up[x].f_rg(ir) * grad_up[x].f_rg(ir);
+            ud += grad_up[x].f_rg(ir) * grad_dn[x].f_rg(ir);
+            dd += grad_dn[x].f_rg(ir) * grad_dn[x].f_rg(ir);
+        }
+        sigma__[0]->f_rg(ir) = uu;
+        if (ns == 2) {
+            sigma__[1]->f_rg(ir) = ud;
+            sigma__[2]->f_rg(ir) = dd;
+        }
+    }
+}
+
+void Potential::xc_rg_div_vsigma_grad_rho(std::vector<double const*> vsigma__, std::vector<double*> vxc__)
+{
+    PROFILE("sirius::Potential::xc_rg_div_vsigma_grad_rho");
+
+    int ns = static_cast<int>(vxc__.size());
+    int num_points = ctx_.spfft().local_slice_size();
 
-        /* forward transform from (theta, phi) to Rlm */
-        auto vxcrlm = transform(*sht_, vxc_tp);
-        auto excrlm = transform(*sht_, exc_tp);
-        for (int ir = 0; ir < nmtp; ir++) {
-            for (int lm = 0; lm < ctx_.lmmax_pot(); lm++) {
-                xc_potential_->f_mt<index_domain_t::local>(lm, ir, ialoc) = vxcrlm(lm, ir);
-                xc_energy_density_->f_mt<index_domain_t::local>(lm, ir, ialoc) = excrlm(lm, ir);
+    auto& grad_up = grad_rho_gga_[0];
+    auto& grad_dn = grad_rho_gga_[ns - 1];
+
+    /* vsigma-weighted gradients replace the gradients of densities:
+         w_up = 2 vsigma_uu grad rho_up + vsigma_ud grad rho_dn
+         w_dn = 2 vsigma_dd grad rho_dn + vsigma_ud grad rho_up
+       and w = 2 vsigma grad rho in the non-magnetic case */
+    #pragma omp parallel for schedule(static)
+    for (int ir = 0; ir < num_points; ir++) {
+        for (int x : {0, 1, 2}) {
+            if (ns == 1) {
+                grad_up[x].f_rg(ir) *= 2 * vsigma__[0][ir];
+            } else {
+                double u = grad_up[x].f_rg(ir);
+                double d = grad_dn[x].f_rg(ir);
+                grad_up[x].f_rg(ir) = 2 * vsigma__[0][ir] * u + vsigma__[1][ir] * d;
+                grad_dn[x].f_rg(ir) = 2 * vsigma__[2][ir] * d + vsigma__[1][ir] * u;
             }
         }
-    } // ialoc
+    }
+
+    /* transform all components to plane-wave domain at once */
+    std::vector<Smooth_periodic_function<double>*> w;
+    for (int is = 0; is < ns; is++) {
+        for (int x : {0, 1, 2}) {
+            w.push_back(&grad_rho_gga_[is][x]);
+        }
+    }
+    sirius::fft_transform(w, spfft_gga_, -1);
+
+    /* divergence is stored in the first Cartesian component */
+    std::vector<Smooth_periodic_function<double>*> div;
+    for (int is = 0; is < ns; is++) {
+        divergence(grad_rho_gga_[is], grad_rho_gga_[is][0]);
+        div.push_back(&grad_rho_gga_[is][0]);
+    }
+    sirius::fft_transform(div, spfft_gga_, 1);
+
+    /* add remaining term to Vxc */
+    #pragma omp parallel for schedule(static)
+    for (int ir = 0; ir < num_points; ir++) {
+        for (int is = 0; is < ns; is++) {
+            vxc__[is][ir] -= grad_rho_gga_[is][0].f_rg(ir);
+        }
+    }
 }
 
 template <bool add_pseudo_core__>
@@ -532,18 +707,15 @@ void Potential::xc_rg_nonmagnetic(Density const& density__)
         }
     }
 
-    Smooth_periodic_vector_function<double> grad_rho;
     Smooth_periodic_function<double> lapl_rho;
     Smooth_periodic_function<double> grad_rho_grad_rho;
 
-    Smooth_periodic_function<double> div_vsigma_grad_rho;
-
     if (is_gga) {
-        /* use fft_transfrom of the base class (Smooth_periodic_function) */
-        rho.fft_transform(-1);
+        grad_rho_grad_rho = Smooth_periodic_function<double>(ctx_.spfft(), gvp);
+
+        /* gradient of density in real space and product of gradients */
+        xc_rg_grad_rho({&rho}, {&grad_rho_grad_rho});
 
-        /* generate pw coeffs of the gradient */
-        grad_rho = gradient(rho);
         /* generate pw coeffs of the laplacian */
         if (use_2nd_deriv) {
             lapl_rho = laplacian(rho);
@@ -551,14 +723,6 @@ void Potential::xc_rg_nonmagnetic(Density const& density__)
             lapl_rho.fft_transform(1);
         }
 
-        /* gradient in real space */
-        for (int x: {0, 1, 2}) {
-            grad_rho[x].fft_transform(1);
-        }
-
-        /* product of gradients */
-        grad_rho_grad_rho = dot(grad_rho, grad_rho);
-
         if (ctx_.control().print_hash_) {
             //auto h1 = lapl_rho.hash_f_rg();
             auto h2 = grad_rho_grad_rho.hash_f_rg();
@@ -581,6 +745,11 @@ void Potential::xc_rg_nonmagnetic(Density const& density__)
         vsigma_tmp.zero();
     }
 
+    /* grid points are processed in blocks using the persistent scratch space of threads */
+    allocate_xc_scratch();
+    int block_size = static_cast<int>(xc_scratch_.size(0));
+    int num_blocks = utils::num_blocks(num_points, block_size);
+
     /* loop over XC functionals */
     for (auto& ixc: xc_func_) {
 
@@ -620,47 +789,38 @@ void Potential::xc_rg_nonmagnetic(Density const& density__)
             TERMINATE("You should not be there since SIRIUS is not compiled with libVDWXC support\n");
 #endif
         } else {
-            #pragma omp parallel
-            {
-                /* split local size between threads */
-                splindex<splindex_t::block> spl_np_t(num_points, omp_get_num_threads(), omp_get_thread_num());
+            #pragma omp parallel for schedule(static)
+            for (int ib = 0; ib < num_blocks; ib++) {
+                int i0 = ib * block_size;
+                int n  = std::min(block_size, num_points - i0);
 
-                std::vector<double> exc_t(spl_np_t.local_size());
+                /* scratch space of the thread */
+                int it           = omp_get_thread_num();
+                double* exc_t    = &xc_scratch_(0, 0, it);
+                double* vrho_t   = &xc_scratch_(0, 1, it);
+                double* vsigma_t = &xc_scratch_(0, 2, it);
 
                 /* if this is an LDA functional */
                 if (ixc.is_lda()) {
-                    std::vector<double> vxc_t(spl_np_t.local_size());
+                    ixc.get_lda(n, &rho.f_rg(i0), vrho_t, exc_t);
 
-                    ixc.get_lda(spl_np_t.local_size(),
-                                &rho.f_rg(spl_np_t.global_offset()),
-                                &vxc_t[0],
-                                &exc_t[0]);
-
-                    for (int i = 0; i < spl_np_t.local_size(); i++) {
+                    for (int i = 0; i < n; i++) {
                         /* add Exc contribution */
-                        exc_tmp(spl_np_t[i]) += exc_t[i];
+                        exc_tmp(i0 + i) += exc_t[i];
 
                         /* directly add to Vxc */
-                        vxc_tmp(spl_np_t[i]) += vxc_t[i];
+                        vxc_tmp(i0 + i) += vrho_t[i];
                     }
                 }
 
                 if (ixc.is_gga()) {
-                    std::vector<double> vrho_t(spl_np_t.local_size());
-                    std::vector<double> vsigma_t(spl_np_t.local_size());
-
-                    ixc.get_gga(spl_np_t.local_size(),
-                                &rho.f_rg(spl_np_t.global_offset()),
-                                &grad_rho_grad_rho.f_rg(spl_np_t.global_offset()),
-                                &vrho_t[0],
-                                &vsigma_t[0],
-                                &exc_t[0]);
+                    ixc.get_gga(n, &rho.f_rg(i0), &grad_rho_grad_rho.f_rg(i0), vrho_t, vsigma_t, exc_t);
 
                     /* this is the same expression between gga and vdw corrections.
                      * The functionals are different that's all */
-                    for (int i = 0; i < spl_np_t.local_size(); i++) {
+                    for (int i = 0; i < n; i++) {
                         /* add Exc contribution */
-                        exc_tmp(spl_np_t[i]) += exc_t[i];
+                        exc_tmp(i0 + i) += exc_t[i];
 
                         /* directly add to Vxc available contributions */
                         //if (use_2nd_deriv) {
@@ -668,10 +828,10 @@ void Potential::xc_rg_nonmagnetic(Density const& density__)
                         //} else {
                         //    vxc_tmp(spl_np_t[i]) += vrho_t[i];
                         //}
-                        vxc_tmp(spl_np_t[i]) += vrho_t[i];
+                        vxc_tmp(i0 + i) += vrho_t[i];
 
                         /* save the sigma derivative */
-                        vsigma_tmp(spl_np_t[i]) += vsigma_t[i];
+                        vsigma_tmp(i0 + i) += vsigma_t[i];
                     }
                 }
             }
@@ -700,7 +860,7 @@ void Potential::xc_rg_nonmagnetic(Density const& density__)
             }
 
             /* compute scalar product of two gradients */
-            auto grad_vsigma_grad_rho = dot(grad_vsigma, grad_rho);
+            auto grad_vsigma_grad_rho = dot(grad_vsigma, grad_rho_gga_[0]);
 
             /* add remaining term to Vxc */
             #pragma omp parallel for
@@ -708,21 +868,7 @@ void Potential::xc_rg_nonmagnetic(Density const& density__)
                 vxc_tmp(ir) -= 2 * (vsigma.f_rg(ir) * lapl_rho.f_rg(ir) + grad_vsigma_grad_rho.f_rg(ir));
             }
         } else {
-            Smooth_periodic_vector_function<double> vsigma_grad_rho(ctx_.spfft(), gvp);
-
-            for (int x: {0, 1, 2}) {
-                for (int ir = 0; ir < num_points; ir++) {
-                    vsigma_grad_rho[x].f_rg(ir) = grad_rho[x].f_rg(ir) * vsigma.f_rg(ir);
-                }
-                /* transform to plane wave domain */
-                vsigma_grad_rho[x].fft_transform(-1);
-            }
-            div_vsigma_grad_rho = divergence(vsigma_grad_rho);
-            /* transform to real space domain */
-            div_vsigma_grad_rho.fft_transform(1);
-            for (int ir = 0; ir < num_points; ir++) {
-                vxc_tmp(ir) -= 2 * div_vsigma_grad_rho.f_rg(ir);
-            }
+            xc_rg_div_vsigma_grad_rho({&vsigma_tmp[0]}, {&vxc_tmp[0]});
         }
     }
     //comm.allgather(&vxc_tmp[0], &xc_potential_->f_rg(0), spl_np.global_offset(), spl_np.local_size());
@@ -805,32 +951,19 @@ void Potential::xc_rg_magnetic(Density const& density__)
         }
     }
 
-    Smooth_periodic_vector_function<double> grad_rho_up;
-    Smooth_periodic_vector_function<double> grad_rho_dn;
     Smooth_periodic_function<double> grad_rho_up_grad_rho_up;
     Smooth_periodic_function<double> grad_rho_up_grad_rho_dn;
     Smooth_periodic_function<double> grad_rho_dn_grad_rho_dn;
 
     if (is_gga) {
         PROFILE("sirius::Potential::xc_rg_magnetic|grad1");
-        /* get plane-wave coefficients of densities */
-        rho_up.fft_transform(-1);
-        rho_dn.fft_transform(-1);
-
-        /* generate pw coeffs of the gradient and laplacian */
-        grad_rho_up = gradient(rho_up);
-        grad_rho_dn = gradient(rho_dn);
-
-        /* gradient in real space */
-        for (int x: {0, 1, 2}) {
-            grad_rho_up[x].fft_transform(1);
-            grad_rho_dn[x].fft_transform(1);
-        }
+        grad_rho_up_grad_rho_up = Smooth_periodic_function<double>(ctx_.spfft(), ctx_.gvec_partition());
+        grad_rho_up_grad_rho_dn = Smooth_periodic_function<double>(ctx_.spfft(), ctx_.gvec_partition());
+        grad_rho_dn_grad_rho_dn = Smooth_periodic_function<double>(ctx_.spfft(), ctx_.gvec_partition());
 
-        /* product of gradients */
-        grad_rho_up_grad_rho_up = dot(grad_rho_up, grad_rho_up);
-        grad_rho_up_grad_rho_dn = dot(grad_rho_up, grad_rho_dn);
-        grad_rho_dn_grad_rho_dn = dot(grad_rho_dn, grad_rho_dn);
+        /* gradients of densities in real space and products of gradients */
+        xc_rg_grad_rho({&rho_up, &rho_dn},
+                       {&grad_rho_up_grad_rho_up, &grad_rho_up_grad_rho_dn, &grad_rho_dn_grad_rho_dn});
 
         if (ctx_.control().print_hash_) {
             auto h3 = grad_rho_up_grad_rho_up.hash_f_rg();
@@ -869,6 +1002,11 @@ void Potential::xc_rg_magnetic(Density const& density__)
         vsigma_dd_tmp.zero();
     }
 
+    /* grid points are processed in blocks using the persistent scratch space of threads */
+    allocate_xc_scratch();
+    int block_size = static_cast<int>(xc_scratch_.size(0));
+    int num_blocks = utils::num_blocks(num_points, block_size);
+
     PROFILE_START("sirius::Potential::xc_rg_magnetic|libxc");
     /* loop over XC functionals */
     for (auto& ixc: xc_func_) {
@@ -912,68 +1050,59 @@ void Potential::xc_rg_magnetic(Density const& density__)
             TERMINATE("You should not be there since sirius is not compiled with libVDWXC\n");
 #endif
         } else {
-#pragma omp parallel
-            {
-                /* split local size between threads */
-                splindex<splindex_t::block> spl_t(num_points, omp_get_num_threads(), omp_get_thread_num());
-
-                std::vector<double> exc_t(spl_t.local_size());
+            #pragma omp parallel for schedule(static)
+            for (int ib = 0; ib < num_blocks; ib++) {
+                int i0 = ib * block_size;
+                int n  = std::min(block_size, num_points - i0);
+
+                /* scratch space of the thread */
+                int it              = omp_get_thread_num();
+                double* exc_t       = &xc_scratch_(0, 0, it);
+                double* vrho_up_t   = &xc_scratch_(0, 1, it);
+                double* vrho_dn_t   = &xc_scratch_(0, 2, it);
+                double* vsigma_uu_t = &xc_scratch_(0, 3, it);
+                double* vsigma_ud_t = &xc_scratch_(0, 4, it);
+                double* vsigma_dd_t = &xc_scratch_(0, 5, it);
 
                 /* if this is an LDA functional */
                 if (ixc.is_lda()) {
-                    std::vector<double> vxc_up_t(spl_t.local_size());
-                    std::vector<double> vxc_dn_t(spl_t.local_size());
-
-
-                    ixc.get_lda(spl_t.local_size(),
-                                &rho_up.f_rg(spl_t.global_offset()),
-                                &rho_dn.f_rg(spl_t.global_offset()),
-                                &vxc_up_t[0],
-                                &vxc_dn_t[0],
-                                &exc_t[0]);
+                    ixc.get_lda(n, &rho_up.f_rg(i0), &rho_dn.f_rg(i0), vrho_up_t, vrho_dn_t, exc_t);
 
-                    for (int i = 0; i < spl_t.local_size(); i++) {
+                    for (int i = 0; i < n; i++) {
                         /* add Exc contribution */
-                        exc_tmp(spl_t[i]) += exc_t[i];
+                        exc_tmp(i0 + i) += exc_t[i];
 
                         /* directly add to Vxc */
-                        vxc_up_tmp(spl_t[i]) += vxc_up_t[i];
-                        vxc_dn_tmp(spl_t[i]) += vxc_dn_t[i];
+                        vxc_up_tmp(i0 + i) += vrho_up_t[i];
+                        vxc_dn_tmp(i0 + i) += vrho_dn_t[i];
                     }
                 }
 
                 if (ixc.is_gga()) {
-                    std::vector<double> vrho_up_t(spl_t.local_size());
-                    std::vector<double> vrho_dn_t(spl_t.local_size());
-                    std::vector<double> vsigma_uu_t(spl_t.local_size());
-                    std::vector<double> vsigma_ud_t(spl_t.local_size());
-                    std::vector<double> vsigma_dd_t(spl_t.local_size());
-
-                    ixc.get_gga(spl_t.local_size(),
-                                &rho_up.f_rg(spl_t.global_offset()),
-                                &rho_dn.f_rg(spl_t.global_offset()),
-                                &grad_rho_up_grad_rho_up.f_rg(spl_t.global_offset()),
-                                &grad_rho_up_grad_rho_dn.f_rg(spl_t.global_offset()),
-                                &grad_rho_dn_grad_rho_dn.f_rg(spl_t.global_offset()),
-                                &vrho_up_t[0],
-                                &vrho_dn_t[0],
-                                &vsigma_uu_t[0],
-                                &vsigma_ud_t[0],
-                                &vsigma_dd_t[0],
-                                &exc_t[0]);
-
-                    #pragma omp parallel for
-                    for (int i = 0; i < spl_t.local_size(); i++) {
+                    ixc.get_gga(n,
+                                &rho_up.f_rg(i0),
+                                &rho_dn.f_rg(i0),
+                                &grad_rho_up_grad_rho_up.f_rg(i0),
+                                &grad_rho_up_grad_rho_dn.f_rg(i0),
+                                &grad_rho_dn_grad_rho_dn.f_rg(i0),
+                                vrho_up_t,
+                                vrho_dn_t,
+                                vsigma_uu_t,
+                                vsigma_ud_t,
+                                vsigma_dd_t,
+                                exc_t);
+
+                    for (int i = 0; i < n; i++) {
                         /* add Exc contribution */
-                        exc_tmp(spl_t[i]) += exc_t[i];
+                        exc_tmp(i0 + i) += exc_t[i];
                         /* directly add to Vxc available contributions */
-                        vxc_up_tmp(spl_t[i]) += vrho_up_t[i];
-                        vxc_dn_tmp(spl_t[i]) += vrho_dn_t[i];
+                        vxc_up_tmp(i0 + i) += vrho_up_t[i];
+                        vxc_dn_tmp(i0 + i) += vrho_dn_t[i];
 
                         /* save the sigma derivative */
-                        vsigma_uu_tmp(spl_t[i]) += vsigma_uu_t[i];
-                        vsigma_ud_tmp(spl_t[i]) += vsigma_ud_t[i];
-                        vsigma_dd_tmp(spl_t[i]) += vsigma_dd_t[i];
+                        vsigma_uu_tmp(i0 + i) += vsigma_uu_t[i];
+                        vsigma_ud_tmp(i0 + i) += vsigma_ud_t[i];
+                        vsigma_dd_tmp(i0 + i) += vsigma_dd_t[i];
                     }
                 }
             }
@@ -983,42 +1112,9 @@ void Potential::xc_rg_magnetic(Density const& density__)
 
     if (is_gga) {
         PROFILE("sirius::Potential::xc_rg_magnetic|grad2");
-        /* gather vsigma */
-        // vsigma_uu: dϵ/dσ↑↑
-        Smooth_periodic_function<double> vsigma_uu(ctx_.spfft(), ctx_.gvec_partition());
-        // vsigma_ud: dϵ/dσ↑↓
-        Smooth_periodic_function<double> vsigma_ud(ctx_.spfft(), ctx_.gvec_partition());
-        // vsigma_dd: dϵ/dσ↓↓
-        Smooth_periodic_function<double> vsigma_dd(ctx_.spfft(), ctx_.gvec_partition());
-        for (int ir = 0; ir < num_points; ir++) {
-            vsigma_uu.f_rg(ir) = vsigma_uu_tmp[ir];
-            vsigma_ud.f_rg(ir) = vsigma_ud_tmp[ir];
-            vsigma_dd.f_rg(ir) = vsigma_dd_tmp[ir];
-        }
-
-        Smooth_periodic_vector_function<double> up_gradrho_vsigma(ctx_.spfft(), ctx_.gvec_partition());
-        Smooth_periodic_vector_function<double> dn_gradrho_vsigma(ctx_.spfft(), ctx_.gvec_partition());
-        for (int x: {0, 1, 2}) {
-            for(int ir = 0; ir < num_points; ++ir) {
-              up_gradrho_vsigma[x].f_rg(ir) = 2 * grad_rho_up[x].f_rg(ir) * vsigma_uu.f_rg(ir) + grad_rho_dn[x].f_rg(ir) * vsigma_ud.f_rg(ir);
-              dn_gradrho_vsigma[x].f_rg(ir) = 2 * grad_rho_dn[x].f_rg(ir) * vsigma_dd.f_rg(ir) + grad_rho_up[x].f_rg(ir) * vsigma_ud.f_rg(ir);
-            }
-            /* transform to plane wave domain */
-            up_gradrho_vsigma[x].fft_transform(-1);
-            dn_gradrho_vsigma[x].fft_transform(-1);
-        }
-
-        auto div_up_gradrho_vsigma = divergence(up_gradrho_vsigma);
-        div_up_gradrho_vsigma.fft_transform(1);
-        auto div_dn_gradrho_vsigma = divergence(dn_gradrho_vsigma);
-        div_dn_gradrho_vsigma.fft_transform(1);
-
-        /* add remaining term to Vxc */
-        #pragma omp parallel for
-        for (int ir = 0; ir < num_points; ir++) {
-            vxc_up_tmp(ir) -= div_up_gradrho_vsigma.f_rg(ir);
-            vxc_dn_tmp(ir) -= div_dn_gradrho_vsigma.f_rg(ir);
-        }
+        /* vsigma_uu: dϵ/dσ↑↑, vsigma_ud: dϵ/dσ↑↓, vsigma_dd: dϵ/dσ↓↓ */
+        xc_rg_div_vsigma_grad_rho({&vsigma_uu_tmp[0], &vsigma_ud_tmp[0], &vsigma_dd_tmp[0]},
+                                  {&vxc_up_tmp[0], &vxc_dn_tmp[0]});
     }
 
     #pragma omp parallel for
@@ -1063,6 +1159,10 @@ void Potential::xc(Density const& density__)
     } else {
         xc_rg_magnetic<add_pseudo_core__>(density__);
     }
+    /* the GGA terms keep up to six FFT drivers and six gradient components on the dense grid */
+    if (ctx_.control().memory_usage_ == "low") {
+        deallocate_gga_buffers();
+    }
 
     if (ctx_.control().print_hash_) {
         auto h = xc_energy_density_->hash_f_rg();
@@ -28,6 +28,7 @@
 #include <xc.h>
 #include <string.h>
 #include <memory>
+#include "xc_native.hpp"
 
 namespace sirius {
 
@@ -1387,6 +1388,12 @@ class XC_functional_base
         std::unique_ptr<xc_func_type> handler_{nullptr};
 
         bool libxc_initialized_{false};
+
+        /// Built-in kernel which replaces Libxc.
+        xc_native::kernel_t native_{xc_native::kernel_t::none};
+
+        /// Density below which the built-in kernel returns zero.
+        double dens_threshold_{0};
     private:
         /* forbid copy constructor */
         XC_functional_base(const XC_functional_base& src) = delete;
@@ -1428,6 +1435,8 @@ class XC_functional_base
             this->num_spins_   = src__.num_spins_;
             this->handler_     = std::move(src__.handler_);
             this->libxc_initialized_ = src__.libxc_initialized_;
+            this->native_      = src__.native_;
+            this->dens_threshold_ = src__.dens_threshold_;
             src__.libxc_initialized_ = false;
         }
 
@@ -1477,6 +1486,22 @@ class XC_functional_base
             }
         }
 
+        /// Use the built-in implementation of the functional if it exists.
+        /** Libxc is kept as the reference implementation and is used for all other functionals. Returns true if
+         *  the built-in kernel is available. */
+        bool use_native(double dens_threshold__)
+        {
+            native_         = (handler_) ? xc_native::get_kernel_t(libxc_name_) : xc_native::kernel_t::none;
+            dens_threshold_ = dens_threshold__;
+            return native_ != xc_native::kernel_t::none;
+        }
+
+        /// True if the built-in kernel is used.
+        bool is_native() const
+        {
+            return native_ != xc_native::kernel_t::none;
+        }
+
         bool is_lda() const
         {
             return family() == XC_FAMILY_LDA;
@@ -1530,6 +1555,24 @@ class XC_functional_base
                 }
             }
 
+            switch (native_) {
+                case xc_native::kernel_t::lda_x: {
+                    xc_native::lda_x(size, rho, v, e, dens_threshold_);
+                    return;
+                }
+                case xc_native::kernel_t::lda_c_pz: {
+                    xc_native::lda_c_pz(size, rho, v, e, dens_threshold_);
+                    return;
+                }
+                case xc_native::kernel_t::lda_c_pw: {
+                    xc_native::lda_c_pw(size, rho, v, e, dens_threshold_);
+                    return;
+                }
+                default: {
+                    break;
+                }
+            }
+
             if (handler_) {
                 xc_lda_exc_vxc(handler_.get(), size, rho, e, v);
             } else {
@@ -1554,8 +1597,7 @@ class XC_functional_base
                 TERMINATE("wrong XC");
             }
 
-            std::vector<double> rho_ud(size * 2);
-            /* check and rearrange density */
+            /* check density */
             for (int i = 0; i < size; i++) {
                 if (rho_up[i] < 0 || rho_dn[i] < 0) {
                     std::stringstream s;
@@ -1563,7 +1605,29 @@ class XC_functional_base
                       << " " << utils::double_to_string(rho_dn[i]);
                     TERMINATE(s);
                 }
+            }
+
+            switch (native_) {
+                case xc_native::kernel_t::lda_x: {
+                    xc_native::lda_x(size, rho_up, rho_dn, v_up, v_dn, e, dens_threshold_);
+                    return;
+                }
+                case xc_native::kernel_t::lda_c_pz: {
+                    xc_native::lda_c_pz(size, rho_up, rho_dn, v_up, v_dn, e, dens_threshold_);
+                    return;
+                }
+                case xc_native::kernel_t::lda_c_pw: {
+                    xc_native::lda_c_pw(size, rho_up, rho_dn, v_up, v_dn, e, dens_threshold_);
+                    return;
+                }
+                default: {
+                    break;
+                }
+            }
 
+            /* rearrange density */
+            std::vector<double> rho_ud(size * 2);
+            for (int i = 0; i < size; i++) {
                 rho_ud[2 * i]     = rho_up[i];
                 rho_ud[2 * i + 1] = rho_dn[i];
             }
@@ -1606,6 +1670,20 @@ class XC_functional_base
                 }
             }
 
+            switch (native_) {
+                case xc_native::kernel_t::gga_x_pbe: {
+                    xc_native::gga_x_pbe(size, rho, sigma, vrho, vsigma, e, dens_threshold_);
+                    return;
+                }
+                case xc_native::kernel_t::gga_c_pbe: {
+                    xc_native::gga_c_pbe(size, rho, sigma, vrho, vsigma, e, dens_threshold_);
+                    return;
+                }
+                default: {
+                    break;
+                }
+            }
+
             if (handler_) {
                 xc_gga_exc_vxc(handler_.get(), size, rho, sigma, e, vrho, vsigma);
             } else {
@@ -1635,10 +1713,7 @@ class XC_functional_base
                 TERMINATE("wrong XC");
             }
 
-            std::vector<double> rho(2 * size);
-            std::vector<double> sigma(3 * size);
-            /* check and rearrange density */
-            /* rearrange sigma as well */
+            /* check density */
             for (int i = 0; i < size; i++) {
                 if (rho_up[i] < 0 || rho_dn[i] < 0) {
                     std::stringstream s;
@@ -1646,7 +1721,28 @@ class XC_functional_base
                       << " " << utils::double_to_string(rho_dn[i]);
                     TERMINATE(s);
                 }
+            }
+
+            switch (native_) {
+                case xc_native::kernel_t::gga_x_pbe: {
+                    xc_native::gga_x_pbe(size, rho_up, rho_dn, sigma_uu, sigma_ud, sigma_dd, vrho_up, vrho_dn,
+                                         vsigma_uu, vsigma_ud, vsigma_dd, e, dens_threshold_);
+                    return;
+                }
+                case xc_native::kernel_t::gga_c_pbe: {
+                    xc_native::gga_c_pbe(size, rho_up, rho_dn, sigma_uu, sigma_ud, sigma_dd, vrho_up, vrho_dn,
+                                         vsigma_uu, vsigma_ud, vsigma_dd, e, dens_threshold_);
+                    return;
+                }
+                default: {
+                    break;
+                }
+            }
 
+            std::vector<double> rho(2 * size);
+            std::vector<double> sigma(3 * size);
+            /* rearrange density and sigma */
+            for (int i = 0; i < size; i++) {
                 rho[2 * i] = rho_up[i];
                 rho[2 * i + 1] = rho_dn[i];
 
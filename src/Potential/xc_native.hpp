@@ -0,0 +1,563 @@
+// Copyright (c) 2013-2016 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file xc_native.hpp
+ *
+ *  \brief Built-in implementations of the Slater, Perdew-Zunger, Perdew-Wang and PBE functionals.
+ */
+
+#ifndef __XC_NATIVE_HPP__
+#define __XC_NATIVE_HPP__
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include "constants.hpp"
+
+namespace sirius {
+
+/// Built-in exchange-correlation kernels.
+/** The kernels take separate arrays of spin densities and contracted gradients (no interleaving as in Libxc) and
+ *  are written as straight loops over the grid points. The loops contain no calls to libm (see vmath) and no
+ *  branches, and GCC vectorizes all of them with -fno-math-errno -fno-trapping-math (set for Potential/xc.cpp in
+ *  CMake; checked with -fopt-info-vec for SSE2 and AVX2). Points with the total density below the threshold are
+ *  screened: the kernel is evaluated for a dummy density with the branch-free selection of the result, and energy,
+ *  potential and sigma derivatives at these points are set to zero.
+ *
+ *  The output follows Libxc conventions (Hartree atomic units): e is the energy per particle,
+ *  \f$ v = \partial (\rho e) / \partial \rho \f$ and \f$ v_{\sigma} = \partial (\rho e) / \partial \sigma \f$.
+ */
+namespace xc_native {
+
+/// Type of the built-in kernel.
+enum class kernel_t
+{
+    /// No built-in kernel, Libxc is used.
+    none,
+    /// Slater exchange (XC_LDA_X).
+    lda_x,
+    /// Perdew-Zunger correlation (XC_LDA_C_PZ).
+    lda_c_pz,
+    /// Perdew-Wang correlation (XC_LDA_C_PW).
+    lda_c_pw,
+    /// PBE exchange (XC_GGA_X_PBE).
+    gga_x_pbe,
+    /// PBE correlation (XC_GGA_C_PBE).
+    gga_c_pbe
+};
+
+/// Get the type of the built-in kernel from the Libxc name of the functional.
+inline kernel_t get_kernel_t(std::string const& name__)
+{
+    std::map<std::string, kernel_t> const m = {
+        {"XC_LDA_X", kernel_t::lda_x},
+        {"XC_LDA_C_PZ", kernel_t::lda_c_pz},
+        {"XC_LDA_C_PW", kernel_t::lda_c_pw},
+        {"XC_GGA_X_PBE", kernel_t::gga_x_pbe},
+        {"XC_GGA_C_PBE", kernel_t::gga_c_pbe}
+    };
+    return m.count(name__) ? m.at(name__) : kernel_t::none;
+}
+
+/// Math functions which are inlined into the loops over grid points.
+/** Calls to std::cbrt, std::log and std::exp prevent the vectorization of a loop unless fast-math and a vector
+ *  math library are used. The functions below are branch-free and use only the arithmetic which is vectorized by
+ *  the compiler. */
+namespace vmath {
+
+/// Reinterpret the bits of a double as a 64-bit integer.
+inline uint64_t as_uint64(double x__)
+{
+    uint64_t i;
+    std::memcpy(&i, &x__, sizeof(double));
+    return i;
+}
+
+/// Reinterpret a 64-bit integer as a double.
+inline double as_double(uint64_t i__)
+{
+    double x;
+    std::memcpy(&x, &i__, sizeof(double));
+    return x;
+}
+
+/// Split a positive normal number into \f$ x = 2^k m \f$ with \f$ m \in [1, 2) \f$; k is returned as a double.
+/** The exponent is converted with the \f$ 2^{52} \f$ trick because there is no vector instruction converting
+ *  64-bit integers to doubles before AVX-512. */
+inline double split_exponent(double x__, double& m__)
+{
+    double const two52 = 4503599627370496.0;
+    uint64_t i         = as_uint64(x__);
+    m__                = as_double((i & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    return as_double(((i >> 52) & 0x7ff) | 0x4330000000000000ULL) - two52 - 1023;
+}
+
+/// Clamp the value to [lo, hi].
+/** Unlike std::min and std::max, the arguments are passed by value, which keeps the loops over grid points
+ *  vectorizable. */
+inline double clamp(double x__, double lo__, double hi__)
+{
+    return (x__ < lo__) ? lo__ : ((x__ > hi__) ? hi__ : x__);
+}
+
+/// Return \f$ 2^k \f$ for an integer k in [-1022, 1023] stored as a double.
+inline double pow2(double k__)
+{
+    /* the lower bits of the sum contain the integer k + 1023 */
+    return as_double(as_uint64(k__ + 1023 + 4503599627370496.0) << 52);
+}
+
+/// Branch-free cube root of a normal number or zero.
+/** The cube root of the mantissa is refined by two Halley iterations from a quadratic guess. */
+inline double cbrt(double x__)
+{
+    double const c1 = 1.2599210498948731648; // 2^{1/3}
+    double const c2 = 1.5874010519681994748; // 2^{2/3}
+
+    double m;
+    double k = split_exponent(std::abs(x__), m);
+    /* floor(k / 3) of the integer k; (k - 1) / 3 is rounded to the nearest integer by the 1.5 * 2^52 trick */
+    double q = ((k - 1) / 3 + 6755399441055744.0) - 6755399441055744.0;
+    double r = k - 3 * q;
+
+    double y = 0.6264 + m * (0.4336 - 0.0586 * m);
+    for (int it = 0; it < 2; it++) {
+        double y3 = y * y * y;
+        y *= (y3 + 2 * m) / (2 * y3 + m);
+    }
+    /* multiply by 2^{r/3}; the quadratic through (0, 1), (1, c1) and (2, c2) avoids the selection */
+    y *= 1 + r * ((c1 - 1) + 0.5 * (r - 1) * (c2 - 2 * c1 + 1));
+    y *= pow2(q);
+    /* restore the sign bit */
+    y = as_double(as_uint64(y) | (as_uint64(x__) & 0x8000000000000000ULL));
+    return (x__ == 0) ? 0.0 : y;
+}
+
+/// Branch-free natural logarithm of a positive normal number.
+/** The mantissa is reduced to \f$ [\sqrt{2}/2, \sqrt{2}) \f$ and the rest is the polynomial of fdlibm. */
+inline double log(double x__)
+{
+    double const ln2_hi = 6.93147180369123816490e-01;
+    double const ln2_lo = 1.90821492927058770002e-10;
+    double const lg1    = 6.666666666666735130e-01;
+    double const lg2    = 3.999999999940941908e-01;
+    double const lg3    = 2.857142874366239149e-01;
+    double const lg4    = 2.222219843214978396e-01;
+    double const lg5    = 1.818357216161805012e-01;
+    double const lg6    = 1.531383769920937332e-01;
+    double const lg7    = 1.479819860511658591e-01;
+
+    double m;
+    double k = split_exponent(x__, m);
+    bool big = m > 1.41421356237309504880;
+    m        = big ? 0.5 * m : m;
+    k        = big ? k + 1 : k;
+
+    double f    = m - 1;
+    double s    = f / (2 + f);
+    double z    = s * s;
+    double w    = z * z;
+    double R    = z * (lg1 + w * (lg3 + w * (lg5 + w * lg7))) + w * (lg2 + w * (lg4 + w * lg6));
+    double hfsq = 0.5 * f * f;
+    return k * ln2_hi - ((hfsq - (s * (hfsq + R) + k * ln2_lo)) - f);
+}
+
+/// Branch-free exponential function.
+/** The argument is clamped to the range of normal numbers and reduced to \f$ |r| \le \ln(2)/2 \f$; the rest is the
+ *  rational approximation of fdlibm. */
+inline double exp(double x__)
+{
+    double const ln2_hi = 6.93147180369123816490e-01;
+    double const ln2_lo = 1.90821492927058770002e-10;
+    double const p1     = 1.66666666666666019037e-01;
+    double const p2     = -2.77777777770155933842e-03;
+    double const p3     = 6.61375632143793436117e-05;
+    double const p4     = -1.65339022054652515390e-06;
+    double const p5     = 4.13813679705723846039e-08;
+    /* 1.5 * 2^52: adding and subtracting it rounds to the nearest integer */
+    double const round  = 6755399441055744.0;
+
+    double x = clamp(x__, -708.0, 709.0);
+    double k = (x * 1.44269504088896338700 + round) - round;
+    double r = (x - k * ln2_hi) - k * ln2_lo;
+    double t = r * r;
+    double c = r - t * (p1 + t * (p2 + t * (p3 + t * (p4 + t * p5))));
+    return (1 - ((r * c) / (c - 2) - r)) * pow2(k);
+}
+
+} // namespace vmath
+
+/// Wigner-Seitz radius.
+inline double wigner_seitz_radius(double n__)
+{
+    return vmath::cbrt(3 / (fourpi * n__));
+}
+
+/// Spin-interpolation function \f$ f(\zeta) \f$ and its derivative.
+inline void spin_interpolation(double z__, double& f__, double& df__)
+{
+    double const c = 1 / (std::cbrt(16.0) - 2);
+    double a       = vmath::cbrt(1 + z__);
+    double b       = vmath::cbrt(1 - z__);
+    f__            = ((1 + z__) * a + (1 - z__) * b - 2) * c;
+    df__           = 4.0 / 3 * (a - b) * c;
+}
+
+/// Perdew-Zunger fit of the correlation energy of the unpolarized (i = 0) or fully polarized (i = 1) gas.
+/** Returns \f$ \varepsilon_c(r_s) \f$ and \f$ d\varepsilon_c / dr_s \f$. */
+template <int i__>
+inline void pz_fit(double rs__, double& e__, double& de__)
+{
+    double const gamma[] = {-0.1423, -0.0843};
+    double const beta1[] = {1.0529, 1.3981};
+    double const beta2[] = {0.3334, 0.2611};
+    double const a[]     = {0.0311, 0.01555};
+    double const b[]     = {-0.048, -0.0269};
+    double const c[]     = {0.0020, 0.0007};
+    double const d[]     = {-0.0116, -0.0048};
+
+    double sq   = std::sqrt(rs__);
+    double lnrs = vmath::log(rs__);
+    double q    = 1 + beta1[i__] * sq + beta2[i__] * rs__;
+    bool hi     = rs__ >= 1;
+
+    e__  = hi ? gamma[i__] / q : a[i__] * lnrs + b[i__] + c[i__] * rs__ * lnrs + d[i__] * rs__;
+    de__ = hi ? -gamma[i__] * (0.5 * beta1[i__] / sq + beta2[i__]) / (q * q)
+              : a[i__] / rs__ + c[i__] * (lnrs + 1) + d[i__];
+}
+
+/// Perdew-Wang fit \f$ G(r_s) \f$ of the unpolarized (i = 0), fully polarized (i = 1) gas and of the spin stiffness
+/// (i = 2).
+/** Parameters of the modified version are used for the PBE correlation (as in Libxc). */
+template <int i__, bool mod__>
+inline void pw_fit(double rs__, double& g__, double& dg__)
+{
+    double const a[]  = {0.031091, 0.015545, 0.016887};
+    double const am[] = {0.0310907, 0.01554535, 0.0168869};
+    double const a1[] = {0.21370, 0.20548, 0.11125};
+    double const b1[] = {7.5957, 14.1189, 10.357};
+    double const b2[] = {3.5876, 6.1977, 3.6231};
+    double const b3[] = {1.6382, 3.3662, 0.88026};
+    double const b4[] = {0.49294, 0.62517, 0.49671};
+
+    double A  = mod__ ? am[i__] : a[i__];
+    double sq = std::sqrt(rs__);
+    double q0 = -2 * A * (1 + a1[i__] * rs__);
+    double q1 = 2 * A * (b1[i__] * sq + b2[i__] * rs__ + b3[i__] * rs__ * sq + b4[i__] * rs__ * rs__);
+    double dq = A * (b1[i__] / sq + 2 * b2[i__] + 3 * b3[i__] * sq + 4 * b4[i__] * rs__);
+    double lq = vmath::log(1 + 1 / q1);
+
+    g__  = q0 * lq;
+    dg__ = -2 * A * a1[i__] * lq - q0 * dq / (q1 * q1 + q1);
+}
+
+/// Perdew-Wang correlation energy and its derivatives with respect to \f$ r_s \f$ and \f$ \zeta \f$.
+template <bool mod__>
+inline void pw(double rs__, double z__, double& e__, double& de_drs__, double& de_dz__)
+{
+    double const fz20 = mod__ ? 1.709920934161365617563962776245 : 1.709921;
+
+    double g0, dg0, g1, dg1, g2, dg2, f, df;
+    pw_fit<0, mod__>(rs__, g0, dg0);
+    pw_fit<1, mod__>(rs__, g1, dg1);
+    pw_fit<2, mod__>(rs__, g2, dg2);
+    spin_interpolation(z__, f, df);
+
+    double z3 = z__ * z__ * z__;
+    double z4 = z3 * z__;
+
+    e__      = g0 - g2 * f * (1 - z4) / fz20 + (g1 - g0) * f * z4;
+    de_drs__ = dg0 - dg2 * f * (1 - z4) / fz20 + (dg1 - dg0) * f * z4;
+    de_dz__  = -g2 * (df * (1 - z4) - 4 * f * z3) / fz20 + (g1 - g0) * (df * z4 + 4 * f * z3);
+}
+
+/// PBE exchange enhancement of the unpolarized gas.
+/** Returns the energy per particle and derivatives of \f$ \rho e \f$ with respect to \f$ \rho \f$ and
+ *  \f$ \sigma \f$. */
+inline void pbe_x(double n__, double s__, double& e__, double& vrho__, double& vsigma__)
+{
+    double const cx    = -0.75 * std::cbrt(3 / pi);
+    double const cs    = 1 / (4 * std::pow(3 * pi * pi, 2.0 / 3));
+    double const kappa = 0.804;
+    double const mu    = 0.2195149727645171;
+
+    double n13 = vmath::cbrt(n__);
+    double n43 = n__ * n13;
+    double x   = cs * s__ / (n43 * n43);
+    double d   = kappa + mu * x;
+    double F   = 1 + kappa - kappa * kappa / d;
+    double dF  = mu * kappa * kappa / (d * d);
+
+    e__      = cx * n13 * F;
+    vrho__   = cx * n13 * (4 * F - 8 * x * dF) / 3;
+    vsigma__ = cx * cs * dF / n43;
+}
+
+/// PBE correlation energy per particle and derivatives of \f$ \rho e \f$ with respect to \f$ \rho \f$,
+/// \f$ \zeta \f$ and \f$ \sigma = |\nabla \rho|^2 \f$.
+inline void pbe_c(double n__, double z__, double s__, double& e__, double& de_dn__, double& de_dz__,
+                  double& de_ds__)
+{
+    double const beta  = 0.06672455060314922;
+    double const gamma = (1 - std::log(2.0)) / (pi * pi);
+    double const y     = beta / gamma;
+    double const ct    = pi / (16 * std::cbrt(3 * pi * pi));
+
+    /* local part */
+    double rs = wigner_seitz_radius(n__);
+    double ec, dec_drs, dec_dz;
+    pw<true>(rs, z__, ec, dec_drs, dec_dz);
+    double dec_dn = -rs * dec_drs / (3 * n__);
+
+    /* spin-scaling factor */
+    double a    = vmath::cbrt(1 + z__);
+    double b    = vmath::cbrt(1 - z__);
+    double phi  = (a * a + b * b) / 2;
+    double dphi = (1 / a - 1 / b) / 3;
+    double phi3 = phi * phi * phi;
+
+    /* t^2 */
+    double n73 = n__ * n__ * vmath::cbrt(n__);
+    double dt  = ct / (phi * phi * n73);
+    double T   = dt * s__;
+
+    double ex  = vmath::exp(-ec / (gamma * phi3));
+    double A   = y / (ex - 1);
+    double num = 1 + A * T;
+    double den = 1 + A * T + A * A * T * T;
+    double R   = y * T * num / den;
+    double H   = gamma * phi3 * vmath::log(1 + R);
+
+    double dR_dT = y * (num / den + T * (A * den - num * (A + 2 * A * A * T)) / (den * den));
+    double dR_dA = y * T * (T * den - num * (T + 2 * A * T * T)) / (den * den);
+    double dH_dT = gamma * phi3 * dR_dT / (1 + R);
+    double dH_dA = gamma * phi3 * dR_dA / (1 + R);
+
+    double dA_dec  = A * A * ex / (y * gamma * phi3);
+    double dA_dphi = -3 * ec * dA_dec / phi;
+    double dH_dphi = 3 * H / phi - 2 * T * dH_dT / phi + dH_dA * dA_dphi;
+
+    double dH_dn = -7 * T * dH_dT / (3 * n__) + dH_dA * dA_dec * dec_dn;
+    double dH_dz = dH_dphi * dphi + dH_dA * dA_dec * dec_dz;
+
+    e__     = ec + H;
+    de_dn__ = ec + H + n__ * (dec_dn + dH_dn);
+    de_dz__ = n__ * (dec_dz + dH_dz);
+    de_ds__ = n__ * dH_dT * dt;
+}
+
+/// Slater exchange.
+inline void lda_x(int size__, double const* rho__, double* v__, double* e__, double thr__)
+{
+    double const cx = -0.75 * std::cbrt(3 / pi);
+    #pragma omp simd
+    for (int i = 0; i < size__; i++) {
+        bool m    = rho__[i] > thr__;
+        double ex = cx * vmath::cbrt(m ? rho__[i] : 1.0);
+        e__[i]    = m ? ex : 0;
+        v__[i]    = m ? 4 * ex / 3 : 0;
+    }
+}
+
+/// Spin-polarized Slater exchange.
+inline void lda_x(int size__, double const* rho_up__, double const* rho_dn__, double* v_up__, double* v_dn__,
+                  double* e__, double thr__)
+{
+    double const c = -0.75 * std::cbrt(6 / pi);
+    #pragma omp simd
+    for (int i = 0; i < size__; i++) {
+        double nu = rho_up__[i];
+        double nd = rho_dn__[i];
+        bool m    = nu + nd > thr__;
+        double au = vmath::cbrt(nu);
+        double ad = vmath::cbrt(nd);
+        e__[i]    = m ? c * (nu * au + nd * ad) / (m ? nu + nd : 1.0) : 0;
+        v_up__[i] = m ? 4 * c * au / 3 : 0;
+        v_dn__[i] = m ? 4 * c * ad / 3 : 0;
+    }
+}
+
+/// Perdew-Zunger correlation.
+inline void lda_c_pz(int size__, double const* rho__, double* v__, double* e__, double thr__)
+{
+    #pragma omp simd
+    for (int i = 0; i < size__; i++) {
+        bool m    = rho__[i] > thr__;
+        double rs = wigner_seitz_radius(m ? rho__[i] : 1.0);
+        double ec, dec;
+        pz_fit<0>(rs, ec, dec);
+        e__[i] = m ? ec : 0;
+        v__[i] = m ? ec - rs * dec / 3 : 0;
+    }
+}
+
+/// Spin-polarized Perdew-Zunger correlation.
+inline void lda_c_pz(int size__, double const* rho_up__, double const* rho_dn__, double* v_up__, double* v_dn__,
+                     double* e__, double thr__)
+{
+    #pragma omp simd
+    for (int i = 0; i < size__; i++) {
+        double n  = rho_up__[i] + rho_dn__[i];
+        bool m    = n > thr__;
+        n         = m ? n : 1.0;
+        double z  = m ? vmath::clamp((rho_up__[i] - rho_dn__[i]) / n, -1.0, 1.0) : 0.0;
+        double rs = wigner_seitz_radius(n);
+        double e0, de0, e1, de1, f, df;
+        pz_fit<0>(rs, e0, de0);
+        pz_fit<1>(rs, e1, de1);
+        spin_interpolation(z, f, df);
+        double ec     = e0 + f * (e1 - e0);
+        double dec_dr = de0 + f * (de1 - de0);
+        double dec_dz = df * (e1 - e0);
+        double v      = ec - rs * dec_dr / 3;
+        e__[i]        = m ? ec : 0;
+        v_up__[i]     = m ? v + (1 - z) * dec_dz : 0;
+        v_dn__[i]     = m ? v - (1 + z) * dec_dz : 0;
+    }
+}
+
+/// Perdew-Wang correlation.
+inline void lda_c_pw(int size__, double const* rho__, double* v__, double* e__, double thr__)
+{
+    #pragma omp simd
+    for (int i = 0; i < size__; i++) {
+        bool m    = rho__[i] > thr__;
+        double rs = wigner_seitz_radius(m ? rho__[i] : 1.0);
+        double ec, dec;
+        pw_fit<0, false>(rs, ec, dec);
+        e__[i] = m ? ec : 0;
+        v__[i] = m ? ec - rs * dec / 3 : 0;
+    }
+}
+
+/// Spin-polarized Perdew-Wang correlation.
+inline void lda_c_pw(int size__, double const* rho_up__, double const* rho_dn__, double* v_up__, double* v_dn__,
+                     double* e__, double thr__)
+{
+    #pragma omp simd
+    for (int i = 0; i < size__; i++) {
+        double n  = rho_up__[i] + rho_dn__[i];
+        bool m    = n > thr__;
+        n         = m ? n : 1.0;
+        double z  = m ? vmath::clamp((rho_up__[i] - rho_dn__[i]) / n, -1.0, 1.0) : 0.0;
+        double rs = wigner_seitz_radius(n);
+        double ec, dec_dr, dec_dz;
+        pw<false>(rs, z, ec, dec_dr, dec_dz);
+        double v  = ec - rs * dec_dr / 3;
+        e__[i]    = m ? ec : 0;
+        v_up__[i] = m ? v + (1 - z) * dec_dz : 0;
+        v_dn__[i] = m ? v - (1 + z) * dec_dz : 0;
+    }
+}
+
+/// PBE exchange.
+inline void gga_x_pbe(int size__, double const* rho__, double const* sigma__, double* vrho__, double* vsigma__,
+                      double* e__, double thr__)
+{
+    #pragma omp simd
+    for (int i = 0; i < size__; i++) {
+        double n  = rho__[i];
+        bool m    = n > thr__;
+        double sg = sigma__[i] * (m ? 1 : 0);
+        double e, vrho, vsigma;
+        pbe_x(m ? n : 1.0, sg, e, vrho, vsigma);
+        e__[i]      = m ? e : 0;
+        vrho__[i]   = m ? vrho : 0;
+        vsigma__[i] = m ? vsigma : 0;
+    }
+}
+
+/// Spin-polarized PBE exchange.
+/** Exchange energy is obtained from the spin-scaling relation
+ *  \f$ E_x[\rho_{\uparrow}, \rho_{\downarrow}] = (E_x[2\rho_{\uparrow}] + E_x[2\rho_{\downarrow}]) / 2 \f$. */
+inline void gga_x_pbe(int size__, double const* rho_up__, double const* rho_dn__, double const* sigma_uu__,
+                      double const* sigma_ud__, double const* sigma_dd__, double* vrho_up__, double* vrho_dn__,
+                      double* vsigma_uu__, double* vsigma_ud__, double* vsigma_dd__, double* e__, double thr__)
+{
+    #pragma omp simd
+    for (int i = 0; i < size__; i++) {
+        double nu = 2 * rho_up__[i];
+        double nd = 2 * rho_dn__[i];
+        bool m    = nu + nd > 2 * thr__;
+        /* weights of the spin channels: one if the channel is not screened and zero otherwise */
+        double wu = (m & (nu > thr__)) ? 1 : 0;
+        double wd = (m & (nd > thr__)) ? 1 : 0;
+        double eu, vu, su, ed, vd, sd;
+        pbe_x(wu > 0 ? nu : 1.0, 4 * sigma_uu__[i] * wu, eu, vu, su);
+        pbe_x(wd > 0 ? nd : 1.0, 4 * sigma_dd__[i] * wd, ed, vd, sd);
+
+        e__[i]         = (nu * eu * wu + nd * ed * wd) / (m ? nu + nd : 1.0);
+        vrho_up__[i]   = vu * wu;
+        vrho_dn__[i]   = vd * wd;
+        vsigma_uu__[i] = 2 * su * wu;
+        vsigma_ud__[i] = 0;
+        vsigma_dd__[i] = 2 * sd * wd;
+    }
+}
+
+/// PBE correlation.
+inline void gga_c_pbe(int size__, double const* rho__, double const* sigma__, double* vrho__, double* vsigma__,
+                      double* e__, double thr__)
+{
+    #pragma omp simd
+    for (int i = 0; i < size__; i++) {
+        double n  = rho__[i];
+        bool m    = n > thr__;
+        double sg = sigma__[i] * (m ? 1 : 0);
+        double e, de_dn, de_dz, de_ds;
+        pbe_c(m ? n : 1.0, 0.0, sg, e, de_dn, de_dz, de_ds);
+        e__[i]      = m ? e : 0;
+        vrho__[i]   = m ? de_dn : 0;
+        vsigma__[i] = m ? de_ds : 0;
+    }
+}
+
+/// Spin-polarized PBE correlation.
+inline void gga_c_pbe(int size__, double const* rho_up__, double const* rho_dn__, double const* sigma_uu__,
+                      double const* sigma_ud__, double const* sigma_dd__, double* vrho_up__, double* vrho_dn__,
+                      double* vsigma_uu__, double* vsigma_ud__, double* vsigma_dd__, double* e__, double thr__)
+{
+    /* keep the spin-scaling factor and its derivative finite for the fully polarized density */
+    double const zmax = 1 - 1e-12;
+    #pragma omp simd
+    for (int i = 0; i < size__; i++) {
+        double n = rho_up__[i] + rho_dn__[i];
+        bool m   = n > thr__;
+        n        = m ? n : 1.0;
+        double z = m ? vmath::clamp((rho_up__[i] - rho_dn__[i]) / n, -zmax, zmax) : 0.0;
+        double s = (sigma_uu__[i] + 2 * sigma_ud__[i] + sigma_dd__[i]) * (m ? 1 : 0);
+        double e, de_dn, de_dz, de_ds;
+        pbe_c(n, z, s, e, de_dn, de_dz, de_ds);
+
+        e__[i]         = m ? e : 0;
+        vrho_up__[i]   = m ? de_dn + de_dz * (1 - z) / n : 0;
+        vrho_dn__[i]   = m ? de_dn - de_dz * (1 + z) / n : 0;
+        vsigma_uu__[i] = m ? de_ds : 0;
+        vsigma_ud__[i] = m ? 2 * de_ds : 0;
+        vsigma_dd__[i] = m ? de_ds : 0;
+    }
+}
+
+} // namespace xc_native
+
+} // namespace sirius
+
+#endif // __XC_NATIVE_HPP__
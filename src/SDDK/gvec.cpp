@@ -303,6 +303,29 @@ void Gvec::find_gvec_shells()
     }
 }
 
+void Gvec::find_gkvec_shells_local() const
+{
+    /* local G+k vectors sorted by length */
+    std::vector<std::pair<double, int>> tmp(this->count());
+    for (int igloc = 0; igloc < this->count(); igloc++) {
+        tmp[igloc] = std::make_pair(gkvec_cart<index_domain_t::local>(igloc).length(), igloc);
+    }
+    std::sort(tmp.begin(), tmp.end());
+
+    num_gkvec_shells_local_ = 0;
+    gkvec_shell_idx_local_.resize(this->count());
+    gkvec_shell_len_local_.clear();
+    for (int i = 0; i < this->count(); i++) {
+        /* start a new shell if the length differs from the length of the current shell */
+        if (i == 0 || tmp[i].first - gkvec_shell_len_local_.back() > 1e-10) {
+            gkvec_shell_len_local_.push_back(tmp[i].first);
+            num_gkvec_shells_local_++;
+        }
+        gkvec_shell_idx_local_[tmp[i].second] = num_gkvec_shells_local_ - 1;
+    }
+    gkvec_shells_local_found_ = true;
+}
+
 void Gvec::init_gvec_cart()
 {
     gvec_cart_  = mdarray<double, 2>(3, count());
@@ -409,6 +432,10 @@ Gvec& Gvec::operator=(Gvec&& src__)
         gvec_shell_        = std::move(src__.gvec_shell_);
         num_gvec_shells_   = std::move(src__.num_gvec_shells_);
         gvec_shell_len_    = std::move(src__.gvec_shell_len_);
+        gkvec_shells_local_found_ = src__.gkvec_shells_local_found_;
+        num_gkvec_shells_local_ = src__.num_gkvec_shells_local_;
+        gkvec_shell_len_local_  = std::move(src__.gkvec_shell_len_local_);
+        gkvec_shell_idx_local_  = std::move(src__.gkvec_shell_idx_local_);
         gvec_index_by_xy_  = std::move(src__.gvec_index_by_xy_);
         z_columns_         = std::move(src__.z_columns_);
         gvec_distr_        = std::move(src__.gvec_distr_);
@@ -477,6 +504,51 @@ int Gvec::index_by_gvec(vector3d<int> const& G__) const
     return ig;
 }
 
+std::vector<std::pair<int, bool>> Gvec::index_by_gvec(int n__, int const* gvec__, bool inverse__) const
+{
+    PROFILE("sddk::Gvec::index_by_gvec");
+
+    auto dx = gvec_index_by_xy_.dim(1);
+    auto dy = gvec_index_by_xy_.dim(2);
+
+    /* same as index_by_gvec(G) but with the check of boundaries; G-vectors may come from the host code */
+    auto index = [&](vector3d<int> const& G) -> int
+    {
+        if (G[0] < dx.begin() || G[0] > dx.end() || G[1] < dy.begin() || G[1] > dy.end()) {
+            return -1;
+        }
+        if (reduced() && G[0] == 0 && G[1] == 0 && G[2] < 0) {
+            return -1;
+        }
+        int ig0 = gvec_index_by_xy_(0, G[0], G[1]);
+        if (ig0 == -1) {
+            return -1;
+        }
+        int icol     = gvec_index_by_xy_(1, G[0], G[1]) & 0xFFFFF;
+        int col_size = gvec_index_by_xy_(1, G[0], G[1]) >> 20;
+        int z0       = G[2] - z_columns_[icol].z[0];
+        int offs     = (z0 >= 0) ? z0 : z0 + col_size;
+        if (offs < 0 || offs >= col_size || z_columns_[icol].z[offs] != G[2]) {
+            return -1;
+        }
+        return ig0 + offs;
+    };
+
+    std::vector<std::pair<int, bool>> result(n__);
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n__; i++) {
+        vector3d<int> G(gvec__[3 * i], gvec__[3 * i + 1], gvec__[3 * i + 2]);
+        int ig = index(G);
+        bool conj{false};
+        if (ig == -1 && inverse__ && reduced()) {
+            ig   = index(G * (-1));
+            conj = (ig != -1);
+        }
+        result[i] = std::make_pair(ig, conj);
+    }
+    return result;
+}
+
 void Gvec::pack(serializer& s__) const
 {
     serialize(s__, vk_);
@@ -513,6 +585,8 @@ void Gvec::unpack(serializer& s__, Gvec& gv__) const
     deserialize(s__, gv__.gvec_distr_);
     deserialize(s__, gv__.zcol_distr_);
     deserialize(s__, gv__.gvec_base_mapping_);
+    /* shells of the local G+k vectors are not serialized: they are found on demand from the local G+k vectors */
+    gv__.gkvec_shells_local_found_ = false;
 }
 
 void Gvec::send_recv(Communicator const& comm__, int source__, int dest__, Gvec& gv__) const
@@ -730,9 +804,72 @@ Gvec_shells::Gvec_shells(Gvec const& gvec__)
             }
         }
     }
+    idx_gvec = gvec_index_map(gvec_count_remapped());
     for (int ig = 0; ig < gvec_count_remapped(); ig++) {
-        idx_gvec[gvec_remapped(ig)] = ig;
+        idx_gvec.insert(gvec_remapped(ig), ig);
+    }
+}
+
+void Gvec_shells::build_stars(std::vector<matrix3d<int>> const& invRT__)
+{
+    /* rotations change only together with the lattice or the point group; atomic displacements which keep the
+       symmetry don't require a new table */
+    if (star_rot_idx_.size() && invRT__.size() == star_invRT_.size()) {
+        bool same{true};
+        for (size_t i = 0; i < invRT__.size(); i++) {
+            for (int x = 0; x < 3; x++) {
+                for (int y = 0; y < 3; y++) {
+                    same = same && (invRT__[i](x, y) == star_invRT_[i](x, y));
+                }
+            }
+        }
+        if (same) {
+            return;
+        }
+    }
+
+    PROFILE("sddk::Gvec_shells::build_stars");
+
+    star_invRT_ = invRT__;
+    int num_sym = num_star_sym();
+
+    std::vector<int> rot_idx;
+    std::vector<int> rot_gvec;
+    std::vector<bool> is_done(gvec_count_remapped(), false);
+
+    /* each shell is complete on a rank, so the star of a local G-vector is also local */
+    for (int igloc = 0; igloc < gvec_count_remapped(); igloc++) {
+        if (is_done[igloc]) {
+            continue;
+        }
+        auto G = gvec_remapped(igloc);
+        for (int i = 0; i < num_sym; i++) {
+            auto gv_rot = invRT__[i] * G;
+            int ig_rot  = index_by_gvec(gv_rot);
+            if (ig_rot == -1) {
+                ig_rot = index_by_gvec(gv_rot * (-1));
+                if (ig_rot == -1) {
+                    std::stringstream s;
+                    s << "rotated G-vector " << gv_rot << " is not found";
+                    throw std::runtime_error(s.str());
+                }
+                rot_idx.push_back(-(ig_rot + 1));
+            } else {
+                rot_idx.push_back(ig_rot);
+                is_done[ig_rot] = true;
+            }
+            for (int x : {0, 1, 2}) {
+                rot_gvec.push_back(gv_rot[x]);
+            }
+        }
     }
+
+    int num_stars = (num_sym == 0) ? 0 : static_cast<int>(rot_idx.size()) / num_sym;
+
+    star_rot_idx_ = mdarray<int, 2>(num_sym, num_stars);
+    std::copy(rot_idx.begin(), rot_idx.end(), star_rot_idx_.at(memory_t::host));
+    star_rot_gvec_ = mdarray<int, 3>(3, num_sym, num_stars);
+    std::copy(rot_gvec.begin(), rot_gvec.end(), star_rot_gvec_.at(memory_t::host));
 }
 
 } // namespace sddk
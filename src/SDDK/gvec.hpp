@@ -34,6 +34,7 @@
 #include "geometry3d.hpp"
 #include "serializer.hpp"
 #include "splindex.hpp"
+#include "gvec_index_map.hpp"
 #include "../utils/profiler.hpp"
 
 using namespace geometry3d;
@@ -163,6 +164,20 @@ class Gvec
     /// Mapping between local index of G-vector and local  G-shell index.
     std::vector<int> gvec_shell_idx_local_;
 
+    /// True if the shells of the local G+k vectors are found.
+    /** The G+k shells are only needed for the G+k vectors of k-points; they are found on the first request and
+        are invalidated when the lattice vectors change. */
+    mutable bool gkvec_shells_local_found_{false};
+
+    /// Local number of G+k shells (groups of local G+k vectors with the same length).
+    mutable int num_gkvec_shells_local_{0};
+
+    /// Lengths of G+k shells in the local index counting [0, num_gkvec_shells_local)
+    mutable std::vector<double> gkvec_shell_len_local_;
+
+    /// Mapping between local index of G+k vector and local G+k shell index.
+    mutable std::vector<int> gkvec_shell_idx_local_;
+
     mdarray<int, 3> gvec_index_by_xy_;
 
     /// Global list of non-zero z-columns.
@@ -220,6 +235,11 @@ class Gvec
      */
     void find_gvec_shells();
 
+    /// Find the shells of the local G+k vectors.
+    /** Unlike G-vector shells, the shells of G+k vectors are found by the length only and for the local set of
+        G+k vectors. They are used to compute the radial form factors once for all G+k vectors of the shell. */
+    void find_gkvec_shells_local() const;
+
     /// Compute the Cartesian coordinates.
     void init_gvec_cart();
 
@@ -332,6 +352,7 @@ class Gvec
         lattice_vectors_ = lattice_vectors__;
         init_gvec_cart();
         find_gvec_shells();
+        gkvec_shells_local_found_ = false;
         return lattice_vectors_;
     }
 
@@ -492,6 +513,13 @@ class Gvec
      *  added to the list of columns. */
     int index_by_gvec(vector3d<int> const& G__) const;
 
+    /// Return global G-vector indices for a batch of G-vectors.
+    /** G-vectors are stored as (3, n) array of Miller indices. The first element of the pair is the index of G-vector
+     *  or -1 if the G-vector is not found. If the G-vector is not found in the reduced set and inverse__ is true,
+     *  the index of -G is returned and the second element of the pair is set to true; in this case the complex
+     *  conjugate of the coefficient has to be taken. */
+    std::vector<std::pair<int, bool>> index_by_gvec(int n__, int const* gvec__, bool inverse__) const;
+
     inline bool reduced() const
     {
         return reduce_gvec_;
@@ -533,6 +561,33 @@ class Gvec
         return gvec_shell_idx_local_[igloc__];
     }
 
+    /// Return the local number of G+k shells.
+    /** The shells are found by the first call to one of the G+k shell accessors; make this first call outside of
+        OpenMP regions. */
+    inline int num_gkvec_shells_local() const
+    {
+        if (!gkvec_shells_local_found_) {
+            find_gkvec_shells_local();
+        }
+        return num_gkvec_shells_local_;
+    }
+
+    inline double gkvec_shell_len_local(int idx__) const
+    {
+        if (!gkvec_shells_local_found_) {
+            find_gkvec_shells_local();
+        }
+        return gkvec_shell_len_local_[idx__];
+    }
+
+    inline int gkvec_shell_idx_local(int igloc__) const
+    {
+        if (!gkvec_shells_local_found_) {
+            find_gkvec_shells_local();
+        }
+        return gkvec_shell_idx_local_[igloc__];
+    }
+
     friend void serialize(serializer& s__, Gvec& gv__);
     friend void deserialize(serializer& s__, Gvec& gv__);
 
@@ -749,7 +804,19 @@ class Gvec_shells
     Gvec const& gvec_;
 
     /// A mapping between G-vector and it's local index in the new distribution.
-    std::map<vector3d<int>, int> idx_gvec;
+    gvec_index_map idx_gvec;
+
+    /// Rotation matrices used to build the stars of G-vectors.
+    std::vector<matrix3d<int>> star_invRT_;
+
+    /// Local index of the rotated representative G-vector of each star for each symmetry operation.
+    /** Negative value -(ig + 1) means that the rotated vector is not stored and its inverse -G(ig) has to be
+     *  used instead (this happens for the reduced set of G-vectors). */
+    mdarray<int, 2> star_rot_idx_;
+
+    /// Rotated representative G-vector of each star for each symmetry operation.
+    /** Miller indices of the rotated vectors are needed to compute the phase factors of the symmetry operations. */
+    mdarray<int, 3> star_rot_gvec_;
 
   public:
 
@@ -782,11 +849,7 @@ class Gvec_shells
     /// Return local index of the G-vector in the remapped set.
     int index_by_gvec(vector3d<int> G__) const
     {
-        if (idx_gvec.count(G__)) {
-            return idx_gvec.at(G__);
-        } else {
-            return -1;
-        }
+        return idx_gvec.find(G__);
     }
 
     /// Index of the G-vector shell by the local G-vector index (in the remapped set).
@@ -795,6 +858,38 @@ class Gvec_shells
         return gvec_shell_remapped_(igloc__);
     }
 
+    /// Build the stars of G-vectors in the remapped set for a given list of rotation matrices.
+    /** Each rotation matrix is the \f$ {\bf R}^{-T} \f$ part of the symmetry operation acting on G-vectors. Stars
+     *  depend only on the lattice and the point group; they are built once and reused in all symmetrizations.
+     *  If the stars were already built for the same list of rotations, nothing is done. */
+    void build_stars(std::vector<matrix3d<int>> const& invRT__);
+
+    /// Number of G-vector stars in the remapped set.
+    inline int num_stars() const
+    {
+        return static_cast<int>(star_rot_idx_.size(1));
+    }
+
+    /// Number of symmetry operations used to build the stars.
+    inline int num_star_sym() const
+    {
+        return static_cast<int>(star_invRT_.size());
+    }
+
+    /// Local index of the representative G-vector of the star rotated by the symmetry operation.
+    /** Negative value -(ig + 1) means that the complex conjugate of the element ig has to be taken. */
+    inline int star_rot_idx(int isym__, int istar__) const
+    {
+        return star_rot_idx_(isym__, istar__);
+    }
+
+    /// Representative G-vector of the star rotated by the symmetry operation.
+    inline vector3d<int> star_rot_gvec(int isym__, int istar__) const
+    {
+        return vector3d<int>(star_rot_gvec_(0, isym__, istar__), star_rot_gvec_(1, isym__, istar__),
+                             star_rot_gvec_(2, isym__, istar__));
+    }
+
     template <typename T>
     std::vector<T> remap_forward(T* data__) const
     {
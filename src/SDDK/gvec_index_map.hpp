@@ -0,0 +1,152 @@
+// Copyright (c) 2013-2019 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file gvec_index_map.hpp
+ *
+ *  \brief Contains declaration and implementation of sddk::gvec_index_map class.
+ */
+
+#ifndef __GVEC_INDEX_MAP_HPP__
+#define __GVEC_INDEX_MAP_HPP__
+
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+#include "geometry3d.hpp"
+
+using namespace geometry3d;
+
+namespace sddk {
+
+/// Mapping between Miller indices of G-vectors and their integer indices.
+/** Open-addressing hash table with linear probing. Miller indices are packed into a single 64-bit key (21 bits for
+ *  each coordinate), so the lookup is a few integer operations and a short contiguous probe instead of the
+ *  pointer chasing of std::map. The table is filled once and then used read-only, so it can be accessed by many
+ *  threads at the same time. */
+class gvec_index_map
+{
+  private:
+    /// Marker of the empty slot; valid keys never have the highest bit set.
+    static inline uint64_t empty_key()
+    {
+        return ~uint64_t(0);
+    }
+
+    /// Packed Miller indices.
+    std::vector<uint64_t> keys_;
+
+    /// Stored indices.
+    std::vector<int> values_;
+
+    /// Mask of the table size (size is a power of two).
+    uint64_t mask_{0};
+
+    /// Number of stored elements.
+    int size_{0};
+
+    static inline uint64_t pack(vector3d<int> const& G__)
+    {
+        /* shift Miller indices to be non-negative */
+        const int offs = 1 << 20;
+        return (uint64_t(G__[0] + offs) << 42) | (uint64_t(G__[1] + offs) << 21) | uint64_t(G__[2] + offs);
+    }
+
+    inline uint64_t slot(uint64_t key__) const
+    {
+        /* Fibonacci hashing to spread the neighbouring keys */
+        return ((key__ * 0x9E3779B97F4A7C15ULL) >> 32) & mask_;
+    }
+
+  public:
+    gvec_index_map()
+    {
+    }
+
+    /// Create an empty map for a given number of elements.
+    gvec_index_map(int capacity__)
+    {
+        uint64_t n{16};
+        while (n < 2 * static_cast<uint64_t>(capacity__)) {
+            n <<= 1;
+        }
+        keys_   = std::vector<uint64_t>(n, empty_key());
+        values_ = std::vector<int>(n, -1);
+        mask_   = n - 1;
+    }
+
+    /// Add G-vector with its index to the map.
+    void insert(vector3d<int> const& G__, int idx__)
+    {
+        if (2 * (size_ + 1) > static_cast<int>(keys_.size())) {
+            throw std::runtime_error("gvec_index_map: capacity is exceeded");
+        }
+        auto key = pack(G__);
+        for (auto i = slot(key);; i = (i + 1) & mask_) {
+            if (keys_[i] == empty_key()) {
+                keys_[i]   = key;
+                values_[i] = idx__;
+                size_++;
+                return;
+            }
+            if (keys_[i] == key) {
+                values_[i] = idx__;
+                return;
+            }
+        }
+    }
+
+    /// Return index of the G-vector or -1 if G-vector is not in the map.
+    inline int find(vector3d<int> const& G__) const
+    {
+        if (size_ == 0) {
+            return -1;
+        }
+        auto key = pack(G__);
+        for (auto i = slot(key);; i = (i + 1) & mask_) {
+            if (keys_[i] == key) {
+                return values_[i];
+            }
+            if (keys_[i] == empty_key()) {
+                return -1;
+            }
+        }
+    }
+
+    /// Find indices of a batch of G-vectors.
+    /** G-vectors are stored as (3, n) array of Miller indices; -1 is returned for G-vectors which are not found. */
+    std::vector<int> find(int n__, int const* gvec__) const
+    {
+        std::vector<int> idx(n__);
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n__; i++) {
+            idx[i] = find(vector3d<int>(gvec__[3 * i], gvec__[3 * i + 1], gvec__[3 * i + 2]));
+        }
+        return idx;
+    }
+
+    /// Number of stored elements.
+    inline int size() const
+    {
+        return size_;
+    }
+};
+
+} // namespace sddk
+
+#endif // __GVEC_INDEX_MAP_HPP__
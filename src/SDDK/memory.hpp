@@ -29,6 +29,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <cstring>
 #include <functional>
 #include <algorithm>
@@ -469,6 +470,8 @@ class memory_pool
     std::list<memory_block_descriptor> memory_blocks_;
     /// Mapping between an allocated pointer and a subblock descriptor.
     std::map<uint8_t*, memory_subblock_descriptor> map_ptr_;
+    /// Lock for the allocation and deallocation requests coming from different threads.
+    std::unique_ptr<std::mutex> mutex_{new std::mutex};
 
   public:
 
@@ -486,6 +489,7 @@ class memory_pool
     T* allocate(size_t num_elements__)
     {
 #if defined(__USE_MEMORY_POOL)
+        std::lock_guard<std::mutex> lock(*mutex_);
         /* memory block descriptor returns an unaligned memory; here we compute the the aligment value */
         size_t align_size = std::max(size_t(64), alignof(T));
         /* size of the memory block in bytes */
@@ -554,6 +558,7 @@ class memory_pool
     void free(void* ptr__)
     {
 #if defined(__USE_MEMORY_POOL)
+        std::lock_guard<std::mutex> lock(*mutex_);
         auto ptr = reinterpret_cast<uint8_t*>(ptr__);
         /* get a descriptor of this pointer */
         auto& msb = map_ptr_.at(ptr);
@@ -581,6 +586,7 @@ class memory_pool
     /** All pointers and smart pointers, allocated by the pool are invalidated. */
     void reset()
     {
+        std::lock_guard<std::mutex> lock(*mutex_);
         for (auto it = memory_blocks_.begin(); it != memory_blocks_.end(); it++) {
             it->free_subblocks_.clear();
             it->free_subblocks_.push_back(std::make_pair(0, it->size_));
@@ -182,42 +182,46 @@ SHT::calculate_U_sigma_m(const int l, const double j, const int mj, const int mp
 }
 
 template<>
-void SHT::backward_transform<double>(int ld, double const *flm, int nr, int lmmax, double *ftp) const
+void SHT::backward_transform<double>(int ld, double const *flm, int nr, int lmmax, double *ftp, int ldtp) const
 {
     assert(lmmax <= lmmax_);
     assert(ld >= lmmax);
+    assert(ldtp >= num_points_);
     sddk::linalg(sddk::linalg_t::blas).gemm('T', 'N', num_points_, nr, lmmax, &sddk::linalg_const<double>::one(),
-        &rlm_backward_(0, 0), lmmax_, flm, ld, &sddk::linalg_const<double>::zero(), ftp, num_points_);
+        &rlm_backward_(0, 0), lmmax_, flm, ld, &sddk::linalg_const<double>::zero(), ftp, ldtp);
 }
 
 template<>
 void SHT::backward_transform<double_complex>(int ld, double_complex const *flm, int nr, int lmmax,
-                                             double_complex *ftp) const
+                                             double_complex *ftp, int ldtp) const
 {
     assert(lmmax <= lmmax_);
     assert(ld >= lmmax);
+    assert(ldtp >= num_points_);
     sddk::linalg(sddk::linalg_t::blas).gemm('T', 'N', num_points_, nr, lmmax,
         &sddk::linalg_const<double_complex>::one(), &ylm_backward_(0, 0), lmmax_, flm, ld,
-        &sddk::linalg_const<double_complex>::zero(), ftp, num_points_);
+        &sddk::linalg_const<double_complex>::zero(), ftp, ldtp);
 }
 
 template<>
-void SHT::forward_transform<double>(double const *ftp, int nr, int lmmax, int ld, double *flm) const
+void SHT::forward_transform<double>(double const *ftp, int nr, int lmmax, int ld, double *flm, int ldtp) const
 {
     assert(lmmax <= lmmax_);
     assert(ld >= lmmax);
+    assert(ldtp >= num_points_);
     sddk::linalg(sddk::linalg_t::blas).gemm('T', 'N', lmmax, nr, num_points_, &sddk::linalg_const<double>::one(),
-        &rlm_forward_(0, 0), num_points_, ftp, num_points_, &sddk::linalg_const<double>::zero(), flm, ld);
+        &rlm_forward_(0, 0), num_points_, ftp, ldtp, &sddk::linalg_const<double>::zero(), flm, ld);
 }
 
 template<>
 void SHT::forward_transform<double_complex>(double_complex const *ftp, int nr, int lmmax, int ld,
-                                            double_complex *flm) const
+                                            double_complex *flm, int ldtp) const
 {
     assert(lmmax <= lmmax_);
     assert(ld >= lmmax);
+    assert(ldtp >= num_points_);
     sddk::linalg(sddk::linalg_t::blas).gemm('T', 'N', lmmax, nr, num_points_, &sddk::linalg_const<double_complex>::one(),
-        &ylm_forward_(0, 0), num_points_, ftp, num_points_, &sddk::linalg_const<double_complex>::zero(), flm, ld);
+        &ylm_forward_(0, 0), num_points_, ftp, ldtp, &sddk::linalg_const<double_complex>::zero(), flm, ld);
 }
 
 void SHT::check() const
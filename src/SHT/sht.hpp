@@ -208,9 +208,17 @@ class SHT // TODO: better name
      *  \param [in] nr Number of radial points.
      *  \param [in] lmmax Maximum number of lm- harmonics to take into sum.
      *  \param [out] ftp Raw pointer to \f$ f(\theta, \phi, r) \f$.
+     *  \param [in] ldtp Size of leading dimension of ftp.
      */
     template <typename T>
-    void backward_transform(int ld, T const* flm, int nr, int lmmax, T* ftp) const;
+    void backward_transform(int ld, T const* flm, int nr, int lmmax, T* ftp, int ldtp) const;
+
+    /// Perform a backward transformation with the leading dimension of ftp equal to the number of points.
+    template <typename T>
+    void backward_transform(int ld, T const* flm, int nr, int lmmax, T* ftp) const
+    {
+        backward_transform(ld, flm, nr, lmmax, ftp, num_points_);
+    }
 
     /// Perform a forward transformation from spherical coordinates to spherical harmonics.
     /** \f[
@@ -223,9 +231,17 @@ class SHT // TODO: better name
      *  \param [in] lmmax Maximum number of lm- coefficients to generate.
      *  \param [in] ld Size of leading dimension of flm.
      *  \param [out] flm Raw pointer to \f$ f_{\ell m}(r) \f$.
+     *  \param [in] ldtp Size of leading dimension of ftp.
      */
     template <typename T>
-    void forward_transform(T const* ftp, int nr, int lmmax, int ld, T* flm) const;
+    void forward_transform(T const* ftp, int nr, int lmmax, int ld, T* flm, int ldtp) const;
+
+    /// Perform a forward transformation with the leading dimension of ftp equal to the number of points.
+    template <typename T>
+    void forward_transform(T const* ftp, int nr, int lmmax, int ld, T* flm) const
+    {
+        forward_transform(ftp, nr, lmmax, ld, flm, num_points_);
+    }
 
     /// Convert form Rlm to Ylm representation.
     static void convert(int lmax__, double const* f_rlm__, double_complex* f_ylm__)
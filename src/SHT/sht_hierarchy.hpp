@@ -0,0 +1,203 @@
+// Copyright (c) 2013-2017 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file sht_hierarchy.hpp
+ *
+ *  \brief Contains definition and implementation of sirius::SHT_hierarchy class.
+ */
+
+#ifndef __SHT_HIERARCHY_HPP__
+#define __SHT_HIERARCHY_HPP__
+
+#include <memory>
+#include "sht.hpp"
+
+namespace sirius {
+
+/// Radially adaptive spherical harmonics transformations inside muffin-tin spheres.
+/** Close to the nucleus the functions are nearly spherical and can be represented with a smaller number of
+ *  \f$ (\theta, \phi) \f$ points. The hierarchy consists of spherical meshes with decreasing \f$ \ell_{max} \f$.
+ *  Level \f$ i \f$ covers the inner fraction \f$ x_i \f$ of radial points (counted from the nucleus) which is not
+ *  covered by the coarser level \f$ i + 1 \f$; level 0 is the full mesh with \f$ x_0 = 1 \f$.
+ *
+ *  Real-space functions are stored with the leading dimension equal to the number of points of the full mesh;
+ *  at the radial points of the coarser levels only the first num_points(ir, nr) values are used and the
+ *  backward transformation sets the remaining values to zero. The forward transformation at these radial points
+ *  generates only the harmonics of the coarser mesh; the higher harmonics are set to zero.
+ */
+class SHT_hierarchy
+{
+  private:
+    /// Spherical meshes ordered from the finest to the coarsest.
+    std::vector<std::unique_ptr<SHT>> sht_;
+
+    /// Inner fraction of radial points covered by each level and all coarser levels.
+    std::vector<double> fraction_;
+
+  public:
+    /// Constructor.
+    /** \param [in] pu Type of processing unit.
+     *  \param [in] lmax Maximum \f$ \ell \f$ of the full mesh.
+     *  \param [in] mesh_type Type of spherical grid (0: Lebedev-Laikov, 1: uniform).
+     *  \param [in] levels List of pairs (inner fraction of radial points, \f$ \ell_{max} \f$) of the coarser
+     *                     meshes; both values must decrease along the list.
+     */
+    SHT_hierarchy(sddk::device_t pu__, int lmax__, int mesh_type__,
+                  std::vector<std::pair<double, int>> const& levels__ = {})
+    {
+        sht_.push_back(std::unique_ptr<SHT>(new SHT(pu__, lmax__, mesh_type__)));
+        fraction_.push_back(1.0);
+
+        for (auto& e : levels__) {
+            if (e.first <= 0 || e.first >= fraction_.back() || e.second < 0 || e.second >= sht_.back()->lmax()) {
+                std::stringstream s;
+                s << "wrong level of the radial hierarchy of spherical meshes" << std::endl
+                  << "  fraction of radial points : " << e.first << std::endl
+                  << "  lmax : " << e.second;
+                TERMINATE(s);
+            }
+            sht_.push_back(std::unique_ptr<SHT>(new SHT(pu__, e.second, mesh_type__)));
+            fraction_.push_back(e.first);
+        }
+    }
+
+    /// Check the transformations of all levels.
+    void check() const
+    {
+        for (auto& e : sht_) {
+            e->check();
+        }
+    }
+
+    /// Number of levels.
+    inline int num_levels() const
+    {
+        return static_cast<int>(sht_.size());
+    }
+
+    /// Spherical mesh of a given level.
+    inline SHT const& sht(int i__) const
+    {
+        return *sht_[i__];
+    }
+
+    /// First radial point of the level for the radial grid with nr points.
+    inline int ir_begin(int i__, int nr__) const
+    {
+        return (i__ + 1 < num_levels()) ? static_cast<int>(fraction_[i__ + 1] * nr__) : 0;
+    }
+
+    /// End of the radial points of the level for the radial grid with nr points.
+    inline int ir_end(int i__, int nr__) const
+    {
+        return static_cast<int>(fraction_[i__] * nr__);
+    }
+
+    /// Number of \f$ (\theta, \phi) \f$ points of the full mesh.
+    inline int num_points() const
+    {
+        return sht_[0]->num_points();
+    }
+
+    /// Number of \f$ (\theta, \phi) \f$ points at the radial point ir of the grid with nr points.
+    inline int num_points(int ir__, int nr__) const
+    {
+        int i{0};
+        while (ir__ < ir_begin(i, nr__)) {
+            i++;
+        }
+        return sht_[i]->num_points();
+    }
+
+    /// Maximum \f$ \ell \f$ of the full mesh.
+    inline int lmax() const
+    {
+        return sht_[0]->lmax();
+    }
+
+    /// Maximum number of \f$ \ell, m \f$ components of the full mesh.
+    inline int lmmax() const
+    {
+        return sht_[0]->lmmax();
+    }
+
+    /// Backward transformation from spherical harmonics to spherical coordinates.
+    /** Arguments have the same meaning as in SHT::backward_transform(); the data of num_mt consecutive
+     *  muffin-tin functions with nr radial points each is transformed.
+     */
+    template <typename T>
+    void backward_transform(int ld__, T const* flm__, int nr__, int lmmax__, T* ftp__, int num_mt__ = 1) const
+    {
+        int ntp = num_points();
+        if (num_levels() == 1) {
+            sht_[0]->backward_transform(ld__, flm__, nr__ * num_mt__, lmmax__, ftp__);
+            return;
+        }
+        for (int imt = 0; imt < num_mt__; imt++) {
+            for (int i = 0; i < num_levels(); i++) {
+                int ir0 = ir_begin(i, nr__);
+                int n   = ir_end(i, nr__) - ir0;
+                if (n == 0) {
+                    continue;
+                }
+                size_t ofs = static_cast<size_t>(imt) * nr__ + ir0;
+                sht_[i]->backward_transform(ld__, flm__ + ofs * ld__, n, std::min(lmmax__, sht_[i]->lmmax()),
+                                            ftp__ + ofs * ntp, ntp);
+                /* points of the full mesh which are not used at this level */
+                for (int ir = 0; ir < n; ir++) {
+                    std::fill(ftp__ + (ofs + ir) * ntp + sht_[i]->num_points(), ftp__ + (ofs + ir + 1) * ntp, T(0));
+                }
+            }
+        }
+    }
+
+    /// Forward transformation from spherical coordinates to spherical harmonics.
+    /** Arguments have the same meaning as in SHT::forward_transform(); the data of num_mt consecutive
+     *  muffin-tin functions with nr radial points each is transformed.
+     */
+    template <typename T>
+    void forward_transform(T const* ftp__, int nr__, int lmmax__, int ld__, T* flm__, int num_mt__ = 1) const
+    {
+        int ntp = num_points();
+        if (num_levels() == 1) {
+            sht_[0]->forward_transform(ftp__, nr__ * num_mt__, lmmax__, ld__, flm__);
+            return;
+        }
+        for (int imt = 0; imt < num_mt__; imt++) {
+            for (int i = 0; i < num_levels(); i++) {
+                int ir0 = ir_begin(i, nr__);
+                int n   = ir_end(i, nr__) - ir0;
+                if (n == 0) {
+                    continue;
+                }
+                size_t ofs = static_cast<size_t>(imt) * nr__ + ir0;
+                int lmmax  = std::min(lmmax__, sht_[i]->lmmax());
+                sht_[i]->forward_transform(ftp__ + ofs * ntp, n, lmmax, ld__, flm__ + ofs * ld__, ntp);
+                /* harmonics which are not resolved by the mesh of this level */
+                for (int ir = 0; ir < n; ir++) {
+                    std::fill(flm__ + (ofs + ir) * ld__ + lmmax, flm__ + (ofs + ir) * ld__ + lmmax__, T(0));
+                }
+            }
+        }
+    }
+};
+
+} // namespace sirius
+
+#endif // __SHT_HIERARCHY_HPP__
@@ -34,8 +34,8 @@
 
 namespace sirius {
 
-/// Symmetrize scalar function.
-/** The following operation is performed:
+/// Symmetrize scalar and vector functions in plane-wave representation.
+/** The following operation is performed for the scalar function:
     \f[
       f_{\mathrm{sym}}({\bf x}) = \frac{1}{N_{\mathrm{sym}}} \sum_{{\bf \hat P}} f({\bf \hat P x})
     \f]
@@ -73,277 +73,145 @@ namespace sirius {
                                        &=& \sum_G e^{i {\bf G} {\bf x}} e^{i {\bf R}^{-T} {\bf G} {\bf t}}
                                        \hat{f}_{\mathrm{sym}}({\bf R}^{-T} {\bf G}) \,.
     \f}
- */
-inline void symmetrize_function(Unit_cell_symmetry const& sym__, Gvec_shells const& gvec_shells__,
-                                mdarray<double_complex, 3> const& sym_phase_factors__, double_complex* f_pw__)
-{
-    PROFILE("sirius::symmetrize_function|fpw");
 
-    auto v = gvec_shells__.remap_forward(f_pw__);
+    Magnetization is symmetrized in the same pass. The following operations are performed.
 
-    std::vector<double_complex> sym_f_pw(v.size(), 0);
-    std::vector<bool> is_done(v.size(), false);
+    Fourier coefficient of symmetrized function:
+    \f[
+      \hat f_{\mathrm{sym}}({\bf G}) = \frac{1}{N_{\mathrm{sym}}} \sum_{{\bf \hat P}} e^{i {\bf R}^{-T} {\bf t}} {\bf S} \hat f ({\bf R}^{-T} {\bf G})\,.
+    \f]
 
-    double norm = 1 / double(sym__.num_mag_sym());
+    Update formula when \f$\hat f({\bf G})\f$ is known:
+    \f[
+      \hat f_{\mathrm{sym}} ({\bf R}^{-T} {\bf G}) = e^{-i {\bf R}^{-T} {\bf G} {\bf t}}
+      {\bf S}^{-1} \hat{f}_{\mathrm{sym}} ({\bf G})\,,
+    \f]
 
-    auto phase_factor = [&](int isym, vector3d<int> G)
-    {
-        return sym_phase_factors__(0, G[0], isym) *
-               sym_phase_factors__(1, G[1], isym) *
-               sym_phase_factors__(2, G[2], isym);
-    };
+    The derivation works similarly to the one for the scalar function.
 
-    PROFILE_START("sirius::symmetrize_function|fpw|local");
+    All operations are done over the precomputed stars of G-vectors (see Gvec_shells::build_stars()): the
+    symmetrized coefficient is computed once for the representative vector of each star and then scattered to all
+    members of the star. The amount of work per star is fixed by the number of symmetry operations, so the stars
+    are evenly distributed between threads.
+ */
+inline void symmetrize_pw_function(Unit_cell_symmetry const& sym__, Gvec_shells const& gvec_shells__,
+                                  mdarray<double_complex, 3> const& sym_phase_factors__, int num_mag_dims__,
+                                  double_complex* f_pw__, double_complex* fx_pw__, double_complex* fy_pw__,
+                                  double_complex* fz_pw__)
+{
+    PROFILE("sirius::symmetrize_pw_function");
 
-    #pragma omp parallel
-    {
-        int nt = omp_get_max_threads();
-        int tid = omp_get_thread_num();
-
-        for (int igloc = 0; igloc < gvec_shells__.gvec_count_remapped(); igloc++) {
-            auto G = gvec_shells__.gvec_remapped(igloc);
-
-            int igsh = gvec_shells__.gvec_shell_remapped(igloc);
-
-            /* each thread is working on full shell of G-vectors */
-            if (igsh % nt == tid && !is_done[igloc]) {
-                double_complex zsym(0, 0);
-
-                for (int i = 0; i < sym__.num_mag_sym(); i++) {
-                    auto& invRT = sym__.magnetic_group_symmetry(i).spg_op.invRT;
-                    auto gv_rot = invRT * G;
-                    double_complex phase = phase_factor(i, gv_rot);
-
-                    /* local index of a rotated G-vector */
-                    int ig_rot = gvec_shells__.index_by_gvec(gv_rot);
-
-                    if (ig_rot == -1) {
-                        gv_rot = gv_rot * (-1);
-                        ig_rot = gvec_shells__.index_by_gvec(gv_rot);
-                        assert(ig_rot >= 0 && ig_rot < (int)v.size());
-                        zsym += std::conj(v[ig_rot]) * phase;
-                    } else {
-                        assert(ig_rot >= 0 && ig_rot < (int)v.size());
-                        zsym += v[ig_rot] * phase;
-                    }
-                } /* loop over symmetries */
-
-                zsym *= norm;
-
-                for (int i = 0; i < sym__.num_mag_sym(); i++) {
-                    auto& invRT = sym__.magnetic_group_symmetry(i).spg_op.invRT;
-                    auto gv_rot = invRT * G;
-                    /* index of a rotated G-vector */
-                    int ig_rot = gvec_shells__.index_by_gvec(gv_rot);
-                    double_complex phase = std::conj(phase_factor(i, gv_rot));
-
-                    if (ig_rot == -1) {
-                        /* skip */
-                    } else {
-                        assert(ig_rot >= 0 && ig_rot < int(v.size()));
-                        sym_f_pw[ig_rot] = zsym * phase;
-                        is_done[ig_rot] = true;
-                    }
-                } /* loop over symmetries */
-            }
-        } /* loop over igloc */
+    int nsym = sym__.num_mag_sym();
+
+    if (gvec_shells__.num_star_sym() != nsym) {
+        TERMINATE("stars of G-vectors are not built for the current symmetry");
     }
-    PROFILE_STOP("sirius::symmetrize_function|fpw|local");
 
+    /* list of components: scalar function, z or (x, y, z) components of the vector function */
+    std::vector<double_complex*> f_pw({f_pw__});
+    switch (num_mag_dims__) {
+        case 1: {
+            f_pw.push_back(fz_pw__);
+            break;
+        }
+        case 3: {
+            f_pw.push_back(fx_pw__);
+            f_pw.push_back(fy_pw__);
+            f_pw.push_back(fz_pw__);
+            break;
+        }
+    }
+    int nc = static_cast<int>(f_pw.size());
 
-    gvec_shells__.remap_backward(sym_f_pw, f_pw__);
-}
+    std::vector<std::vector<double_complex>> v(nc);
+    std::vector<std::vector<double_complex>> sym_f_pw(nc);
+    for (int j = 0; j < nc; j++) {
+        v[j]        = gvec_shells__.remap_forward(f_pw[j]);
+        sym_f_pw[j] = std::vector<double_complex>(v[j].size(), 0);
+    }
 
-inline void symmetrize_vector_function(Unit_cell_symmetry const& sym__, Gvec_shells const& gvec_shells__,
-                                       mdarray<double_complex, 3> const& sym_phase_factors__, double_complex* fz_pw__)
-{
-    PROFILE("sirius::symmetrize_vector_function|vzpw");
+    double norm = 1 / double(nsym);
 
-    auto phase_factor = [&](int isym, const vector3d<int>& G) {
+    auto phase_factor = [&](int isym, vector3d<int> const& G)
+    {
         return sym_phase_factors__(0, G[0], isym) *
                sym_phase_factors__(1, G[1], isym) *
                sym_phase_factors__(2, G[2], isym);
     };
 
-    auto v = gvec_shells__.remap_forward(fz_pw__);
-
-    std::vector<double_complex> sym_f_pw(v.size(), 0);
-    std::vector<bool> is_done(v.size(), false);
-    double norm = 1 / double(sym__.num_mag_sym());
-
-    #pragma omp parallel
-    {
-        int nt = omp_get_max_threads();
-        int tid = omp_get_thread_num();
-
-        for (int igloc = 0; igloc < gvec_shells__.gvec_count_remapped(); igloc++) {
-            auto G = gvec_shells__.gvec_remapped(igloc);
+    PROFILE_START("sirius::symmetrize_pw_function|local");
 
-            int igsh = gvec_shells__.gvec_shell_remapped(igloc);
+    #pragma omp parallel for schedule(static)
+    for (int istar = 0; istar < gvec_shells__.num_stars(); istar++) {
+        std::array<double_complex, 4> zsym = {0, 0, 0, 0};
 
-            if (igsh % nt == tid && !is_done[igloc]) {
-                double_complex zsym(0, 0);
-
-                for (int i = 0; i < sym__.num_mag_sym(); i++) {
-                    auto& invRT = sym__.magnetic_group_symmetry(i).spg_op.invRT;
-                    auto& S = sym__.magnetic_group_symmetry(i).spin_rotation;
-                    double_complex phase = phase_factor(i, G) * S(2, 2);
-                    auto gv_rot = invRT * G;
-                    /* index of a rotated G-vector */
-                    int ig_rot = gvec_shells__.index_by_gvec(gv_rot);
-
-                    if (ig_rot == -1) {
-                        gv_rot = gv_rot * (-1);
-                        ig_rot = gvec_shells__.index_by_gvec(gv_rot);
-                        assert(ig_rot >= 0 && ig_rot < (int)v.size());
-                        zsym += std::conj(v[ig_rot]) * phase;
-                    } else {
-                        assert(ig_rot >= 0 && ig_rot < (int)v.size());
-                        zsym += v[ig_rot] * phase;
-                    }
-                } /* loop over symmetries */
+        /* gather */
+        for (int i = 0; i < nsym; i++) {
+            int ig_rot = gvec_shells__.star_rot_idx(i, istar);
+            bool conj  = ig_rot < 0;
+            if (conj) {
+                ig_rot = -ig_rot - 1;
+            }
+            auto phase = phase_factor(i, gvec_shells__.star_rot_gvec(i, istar));
 
-                zsym *= norm;
+            std::array<double_complex, 4> z;
+            for (int j = 0; j < nc; j++) {
+                z[j] = conj ? std::conj(v[j][ig_rot]) : v[j][ig_rot];
+            }
+            zsym[0] += z[0] * phase;
 
-                for (int i = 0; i < sym__.num_mag_sym(); i++) {
-                    auto& invRT = sym__.magnetic_group_symmetry(i).spg_op.invRT;
-                    auto& S = sym__.magnetic_group_symmetry(i).spin_rotation;
-                    auto gv_rot = invRT * G;
-                    /* index of rotated G-vector */
-                    int ig_rot = gvec_shells__.index_by_gvec(gv_rot);
-                    double_complex phase = std::conj(phase_factor(i, gv_rot)) / S(2, 2) ;
-
-                    if (ig_rot == -1) {
-                        /* skip */
-                    } else {
-                        assert(ig_rot >= 0 && ig_rot < int(v.size()));
-                        sym_f_pw[ig_rot] = zsym * phase;
-                        is_done[ig_rot] = true;
+            auto& S = sym__.magnetic_group_symmetry(i).spin_rotation;
+            switch (num_mag_dims__) {
+                case 1: {
+                    zsym[1] += z[1] * phase * S(2, 2);
+                    break;
+                }
+                case 3: {
+                    for (int k : {0, 1, 2}) {
+                        zsym[k + 1] += (S(k, 0) * z[1] + S(k, 1) * z[2] + S(k, 2) * z[3]) * phase;
                     }
-                } /* loop over symmetries */
+                    break;
+                }
             }
-        }
-    }
-
-    gvec_shells__.remap_backward(sym_f_pw, fz_pw__);
-}
-
-/// Symmetrize vector valued function.
-/** The following operations are performed.
- *
- *   Fourier coefficient of symmetrized function:
- *   \f[
- *     \hat f_{\mathrm{sym}}({\bf G}) = \frac{1}{N_{\mathrm{sym}}} \sum_{{\bf \hat P}} e^{i {\bf R}^{-T} {\bf t}} {\bf S} \hat f ({\bf R}^{-T} {\bf G})\,.
- *   \f]
- *
- *   Update formula when \f$\hat f({\bf G})\f$ is known:
- *   \f[
- *     \hat f_{\mathrm{sym}} ({\bf R}^{-T} {\bf G}) = e^{-i {\bf R}^{-T} {\bf G} {\bf t}}
- *     {\bf S}^{-1} \hat{f}_{\mathrm{sym}} ({\bf G})\,,
- *   \f]
- *
- *   The derivation works similarly to the one for symmetrize_function().
- */
-inline void symmetrize_vector_function(Unit_cell_symmetry const& sym__, Gvec_shells const& gvec_shells__,
-                                       mdarray<double_complex, 3> const& sym_phase_factors__,
-                                       double_complex* fx_pw__, double_complex* fy_pw__, double_complex* fz_pw__)
-{
-    PROFILE("sirius::symmetrize_vector_function|vpw");
+        } /* loop over symmetries */
 
-    auto vx = gvec_shells__.remap_forward(fx_pw__);
-    auto vy = gvec_shells__.remap_forward(fy_pw__);
-    auto vz = gvec_shells__.remap_forward(fz_pw__);
-
-    std::vector<double_complex> sym_fx_pw(vx.size(), 0);
-    std::vector<double_complex> sym_fy_pw(vx.size(), 0);
-    std::vector<double_complex> sym_fz_pw(vx.size(), 0);
-    std::vector<bool> is_done(vx.size(), false);
-
-    double norm = 1 / double(sym__.num_mag_sym());
-
-    auto phase_factor = [&](int isym, const vector3d<int>& G)
-    {
-        return sym_phase_factors__(0, G[0], isym) *
-               sym_phase_factors__(0, G[1], isym) *
-               sym_phase_factors__(0, G[2], isym);
-    };
-
-    auto vrot = [&](vector3d<double_complex> const& v, matrix3d<double> const& S) -> vector3d<double_complex>
-    {
-        return S * v;
-    };
-
-    #pragma omp parallel
-    {
-        int nt = omp_get_max_threads();
-        int tid = omp_get_thread_num();
-
-        for (int igloc = 0; igloc < gvec_shells__.gvec_count_remapped(); igloc++) {
-            auto G = gvec_shells__.gvec_remapped(igloc);
+        for (int j = 0; j < nc; j++) {
+            zsym[j] *= norm;
+        }
 
-            int igsh = gvec_shells__.gvec_shell_remapped(igloc);
+        /* scatter */
+        for (int i = 0; i < nsym; i++) {
+            int ig_rot = gvec_shells__.star_rot_idx(i, istar);
+            if (ig_rot < 0) {
+                continue;
+            }
+            auto phase = std::conj(phase_factor(i, gvec_shells__.star_rot_gvec(i, istar)));
 
-            if (igsh % nt == tid && !is_done[igloc]) {
-                double_complex xsym(0, 0);
-                double_complex ysym(0, 0);
-                double_complex zsym(0, 0);
+            sym_f_pw[0][ig_rot] = zsym[0] * phase;
 
-                for (int i = 0; i < sym__.num_mag_sym(); i++) {
-                    /* full space-group symmetry operation is {R|t} */
-                    auto& invRT = sym__.magnetic_group_symmetry(i).spg_op.invRT;
+            switch (num_mag_dims__) {
+                case 1: {
                     auto& S = sym__.magnetic_group_symmetry(i).spin_rotation;
-                    double_complex phase = phase_factor(i, G);
-                    auto gv_rot = invRT * G;
-                    /* index of a rotated G-vector */
-                    int ig_rot = gvec_shells__.index_by_gvec(gv_rot);
-
-                    if (ig_rot == -1) {
-                        gv_rot = gv_rot * (-1);
-                        ig_rot = gvec_shells__.index_by_gvec(gv_rot);
-                        auto v_rot = vrot({vx[ig_rot], vy[ig_rot], vz[ig_rot]}, S);
-                        assert(ig_rot >=0 && ig_rot < (int)vx.size());
-                        xsym += std::conj(v_rot[0]) * phase;
-                        ysym += std::conj(v_rot[1]) * phase;
-                        zsym += std::conj(v_rot[2]) * phase;
-                    } else {
-                        assert(ig_rot >=0 && ig_rot < (int)vx.size());
-                        auto v_rot = vrot({vx[ig_rot], vy[ig_rot], vz[ig_rot]}, S);
-                        xsym += v_rot[0] * phase;
-                        ysym += v_rot[1] * phase;
-                        zsym += v_rot[2] * phase;
-                    }
-                } /* loop over symmetries */
-
-                xsym *= norm;
-                ysym *= norm;
-                zsym *= norm;
-
-                for (int i = 0; i < sym__.num_mag_sym(); i++) {
-                    const auto& invRT = sym__.magnetic_group_symmetry(i).spg_op.invRT;
-                    const auto& invS = sym__.magnetic_group_symmetry(i).spin_rotation_inv;
-                    auto gv_rot = invRT * G;
-                    /* index of a rotated G-vector */
-                    int ig_rot = gvec_shells__.index_by_gvec(gv_rot);
-                    auto v_rot = vrot({xsym, ysym, zsym}, invS);
-                    double_complex phase = std::conj(phase_factor(i, gv_rot));
-
-                    if (ig_rot == -1) {
-                        /* skip */
-                    } else {
-                        assert(ig_rot >= 0 && ig_rot < int(vz.size()));
-                        sym_fx_pw[ig_rot] = v_rot[0] * phase;
-                        sym_fy_pw[ig_rot] = v_rot[1] * phase;
-                        sym_fz_pw[ig_rot] = v_rot[2] * phase;
-                        is_done[ig_rot] = true;
+                    sym_f_pw[1][ig_rot] = zsym[1] * phase / S(2, 2);
+                    break;
+                }
+                case 3: {
+                    auto& invS = sym__.magnetic_group_symmetry(i).spin_rotation_inv;
+                    for (int k : {0, 1, 2}) {
+                        sym_f_pw[k + 1][ig_rot] =
+                            (invS(k, 0) * zsym[1] + invS(k, 1) * zsym[2] + invS(k, 2) * zsym[3]) * phase;
                     }
-                } /* loop over symmetries */
+                    break;
+                }
             }
-        }
-    }
+        } /* loop over symmetries */
+    } /* loop over stars */
 
-    gvec_shells__.remap_backward(sym_fx_pw, fx_pw__);
-    gvec_shells__.remap_backward(sym_fy_pw, fy_pw__);
-    gvec_shells__.remap_backward(sym_fz_pw, fz_pw__);
+    PROFILE_STOP("sirius::symmetrize_pw_function|local");
+
+    for (int j = 0; j < nc; j++) {
+        gvec_shells__.remap_backward(sym_f_pw[j], f_pw[j]);
+    }
 }
 
 inline void symmetrize_function(Unit_cell_symmetry const& sym__, Communicator const& comm__, mdarray<double, 3>& frlm__)
@@ -356,6 +356,16 @@ class Atom
     inline void set_position(vector3d<double> position__)
     {
         position_ = position__;
+        num_position_changes()++;
+    }
+
+    /// Number of changes of atomic positions made by set_position() in all atoms.
+    /** Data which is cached from the atomic positions (e.g. the position hash of the unit cell) compares this
+     *  counter with the value it was built for and is rebuilt if the positions were changed in the meantime. */
+    static inline unsigned long long& num_position_changes()
+    {
+        static unsigned long long n{0};
+        return n;
     }
 
     /// Return vector field.
@@ -388,11 +398,21 @@ class Atom
         }
     }
 
-    inline void sync_radial_integrals(Communicator const& comm__, int const rank__)
+    /// Pointers to and sizes of the radial integrals which are synchronized between MPI ranks.
+    inline std::vector<std::pair<double*, int>> radial_integrals_sync_data()
     {
-        comm__.bcast(h_radial_integrals_.at(memory_t::host), (int)h_radial_integrals_.size(), rank__);
+        std::vector<std::pair<double*, int>> data = {
+            {h_radial_integrals_.at(memory_t::host), (int)h_radial_integrals_.size()}};
         if (type().parameters().num_mag_dims()) {
-            comm__.bcast(b_radial_integrals_.at(memory_t::host), (int)b_radial_integrals_.size(), rank__);
+            data.push_back({b_radial_integrals_.at(memory_t::host), (int)b_radial_integrals_.size()});
+        }
+        return data;
+    }
+
+    inline void sync_radial_integrals(Communicator const& comm__, int const rank__)
+    {
+        for (auto e : radial_integrals_sync_data()) {
+            comm__.bcast(e.first, e.second, rank__);
         }
     }
 
@@ -0,0 +1,163 @@
+// Copyright (c) 2013-2019 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file atom_position_hash.hpp
+ *
+ *  \brief Contains definition and implementation of sirius::Atom_position_hash class.
+ */
+
+#ifndef __ATOM_POSITION_HASH_HPP__
+#define __ATOM_POSITION_HASH_HPP__
+
+#include <cmath>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include "SDDK/geometry3d.hpp"
+
+using namespace geometry3d;
+
+namespace sirius {
+
+/// Periodic spatial hash of atomic positions in fractional coordinates.
+/** The unit cell is split into nc x nc x nc cells and each atom is stored in the cell of its reduced position.
+ *  A lookup checks only the cell of the query point and, if the point is closer than the tolerance to the cell
+ *  boundary, the neighbouring (periodically wrapped) cells. The distance between positions is the length of the
+ *  minimum-image difference vector in fractional coordinates, the same measure as used by the symmetry finder. */
+class Atom_position_hash
+{
+  private:
+    /// Number of cells in each direction.
+    int nc_{1};
+
+    /// Expected number of atoms.
+    int capacity_{0};
+
+    /// Search tolerance.
+    double tolerance_{0};
+
+    /// Reduced positions of atoms.
+    std::vector<vector3d<double>> positions_;
+
+    /// List of atoms in each cell.
+    std::vector<std::vector<int>> cells_;
+
+    /// Reduce a single fractional coordinate to [0, 1) interval.
+    static inline double reduce(double x__)
+    {
+        x__ -= std::floor(x__);
+        return (x__ >= 1) ? 0 : x__;
+    }
+
+    inline int cell_index(int i0__, int i1__, int i2__) const
+    {
+        auto wrap = [this](int i) { return ((i % nc_) + nc_) % nc_; };
+        return wrap(i0__) + nc_ * (wrap(i1__) + nc_ * wrap(i2__));
+    }
+
+  public:
+    /// Create an empty hash for the expected number of atoms and a given tolerance.
+    Atom_position_hash(int num_atoms__, double tolerance__)
+        : capacity_(num_atoms__)
+        , tolerance_(tolerance__)
+    {
+        /* about one atom per cell; cell must be larger than twice the tolerance, so only the nearest cells
+           have to be checked */
+        nc_ = std::max(1, static_cast<int>(std::cbrt(static_cast<double>(num_atoms__))));
+        nc_ = std::max(1, std::min(nc_, static_cast<int>(0.5 / std::max(tolerance_, 1e-12))));
+        cells_.resize(nc_ * nc_ * nc_);
+    }
+
+    /// Add atom position (in fractional coordinates) to the hash.
+    /** Atoms are expected to be added in the order of their indices. */
+    void add(vector3d<double> position__)
+    {
+        vector3d<double> p(reduce(position__[0]), reduce(position__[1]), reduce(position__[2]));
+        int ia = static_cast<int>(positions_.size());
+        positions_.push_back(p);
+        int i0 = std::min(nc_ - 1, static_cast<int>(p[0] * nc_));
+        int i1 = std::min(nc_ - 1, static_cast<int>(p[1] * nc_));
+        int i2 = std::min(nc_ - 1, static_cast<int>(p[2] * nc_));
+        cells_[cell_index(i0, i1, i2)].push_back(ia);
+    }
+
+    /// Distance between two positions taking into account periodic images.
+    static inline double distance(vector3d<double> const& a__, vector3d<double> const& b__)
+    {
+        auto diff = a__ - b__;
+        for (int x : {0, 1, 2}) {
+            double dl = std::abs(reduce(diff[x]));
+            diff[x]   = std::min(dl, 1 - dl);
+        }
+        return diff.length();
+    }
+
+    /// Find the atom closer than the tolerance to a given position.
+    /** Returns the lowest index of such atom or -1 if there is no atom within the tolerance. */
+    int find(vector3d<double> position__) const
+    {
+        vector3d<double> p(reduce(position__[0]), reduce(position__[1]), reduce(position__[2]));
+
+        /* range of cells to check in each direction */
+        std::array<std::vector<int>, 3> idx;
+        for (int x : {0, 1, 2}) {
+            int i = std::min(nc_ - 1, static_cast<int>(p[x] * nc_));
+            idx[x].push_back(i);
+            if (p[x] * nc_ - i < tolerance_ * nc_) {
+                idx[x].push_back((i - 1 + nc_) % nc_);
+            }
+            if (i + 1 - p[x] * nc_ < tolerance_ * nc_) {
+                idx[x].push_back((i + 1) % nc_);
+            }
+            /* for small number of cells the neighbours can coincide */
+            std::sort(idx[x].begin(), idx[x].end());
+            idx[x].erase(std::unique(idx[x].begin(), idx[x].end()), idx[x].end());
+        }
+
+        int ja{-1};
+        for (int i0 : idx[0]) {
+            for (int i1 : idx[1]) {
+                for (int i2 : idx[2]) {
+                    for (int ia : cells_[cell_index(i0, i1, i2)]) {
+                        if ((ja == -1 || ia < ja) && distance(p, positions_[ia]) < tolerance_) {
+                            ja = ia;
+                        }
+                    }
+                }
+            }
+        }
+        return ja;
+    }
+
+    /// Number of atoms in the hash.
+    inline int size() const
+    {
+        return static_cast<int>(positions_.size());
+    }
+
+    /// Expected number of atoms for which the number of cells was chosen.
+    inline int capacity() const
+    {
+        return capacity_;
+    }
+};
+
+} // namespace sirius
+
+#endif // __ATOM_POSITION_HASH_HPP__
@@ -151,6 +151,12 @@ class Atom_symmetry_class
 
     inline void sync_radial_integrals(Communicator const& comm__, int const rank__);
 
+    /// Pointers to and sizes of the radial functions which are synchronized between MPI ranks.
+    inline std::vector<std::pair<double*, int>> radial_functions_sync_data();
+
+    /// Pointers to and sizes of the radial integrals which are synchronized between MPI ranks.
+    inline std::vector<std::pair<double*, int>> radial_integrals_sync_data();
+
     inline void sync_core_charge_density(Communicator const& comm__, int const rank__);
 
     /// Check if local orbitals are linearly independent
@@ -709,16 +715,32 @@ inline void Atom_symmetry_class::find_enu(relativity_t rel__)
         }
     }
 
+    int nrs = static_cast<int>(rs_with_auto_enu.size());
+    /* channels are searched in batches by the vectorized radial integrator; keep all threads busy first */
+    int nb     = std::max(1, std::min(4, nrs / omp_get_max_threads()));
+    int nbatch = utils::num_blocks(nrs, nb);
+
     #pragma omp parallel for
-    for (size_t i = 0; i < rs_with_auto_enu.size(); i++) {
-        auto   rsd     = rs_with_auto_enu[i];
-        double new_enu = Enu_finder(rel__, atom_type_.zn(), rsd->n, rsd->l, atom_type_.radial_grid(), spherical_potential_, rsd->enu).enu();
-        /* update linearization energy only if its change is above a threshold */
-        if (std::abs(new_enu - rsd->enu) > atom_type_.parameters().settings().auto_enu_tol_) {
-            rsd->enu           = new_enu;
-            rsd->new_enu_found = true;
-        } else {
-            rsd->new_enu_found = false;
+    for (int ib = 0; ib < nbatch; ib++) {
+        std::vector<int> n;
+        std::vector<int> l;
+        std::vector<double> enu;
+        for (int i = ib * nb; i < std::min(nrs, (ib + 1) * nb); i++) {
+            n.push_back(rs_with_auto_enu[i]->n);
+            l.push_back(rs_with_auto_enu[i]->l);
+            enu.push_back(rs_with_auto_enu[i]->enu);
+        }
+        Enu_finder ef(rel__, atom_type_.zn(), n, l, atom_type_.radial_grid(), spherical_potential_, enu);
+        for (int i = ib * nb; i < std::min(nrs, (ib + 1) * nb); i++) {
+            auto rsd       = rs_with_auto_enu[i];
+            double new_enu = ef.enu(i - ib * nb);
+            /* update linearization energy only if its change is above a threshold */
+            if (std::abs(new_enu - rsd->enu) > atom_type_.parameters().settings().auto_enu_tol_) {
+                rsd->enu           = new_enu;
+                rsd->new_enu_found = true;
+            } else {
+                rsd->new_enu_found = false;
+            }
         }
     }
 }
@@ -760,22 +782,37 @@ inline void Atom_symmetry_class::generate_radial_functions(relativity_t rel__)
     //** STOP();
 }
 
-inline void Atom_symmetry_class::sync_radial_functions(Communicator const& comm__, int const rank__)
+inline std::vector<std::pair<double*, int>> Atom_symmetry_class::radial_functions_sync_data()
 {
     /* don't broadcast Hamiltonian radial functions, because they are used locally */
-    int size = (int)(radial_functions_.size(0) * radial_functions_.size(1));
-    comm__.bcast(radial_functions_.at(memory_t::host), size, rank__);
-    comm__.bcast(aw_surface_derivatives_.at(memory_t::host), (int)aw_surface_derivatives_.size(), rank__);
+    return {{radial_functions_.at(memory_t::host), (int)(radial_functions_.size(0) * radial_functions_.size(1))},
+            {aw_surface_derivatives_.at(memory_t::host), (int)aw_surface_derivatives_.size()}};
     // TODO: sync enu to pass to Exciting / Elk
 }
 
-inline void Atom_symmetry_class::sync_radial_integrals(Communicator const& comm__, int const rank__)
+inline std::vector<std::pair<double*, int>> Atom_symmetry_class::radial_integrals_sync_data()
 {
-    comm__.bcast(h_spherical_integrals_.at(memory_t::host), (int)h_spherical_integrals_.size(), rank__);
-    comm__.bcast(o_radial_integrals_.at(memory_t::host), (int)o_radial_integrals_.size(), rank__);
-    comm__.bcast(so_radial_integrals_.at(memory_t::host), (int)so_radial_integrals_.size(), rank__);
+    std::vector<std::pair<double*, int>> data = {
+        {h_spherical_integrals_.at(memory_t::host), (int)h_spherical_integrals_.size()},
+        {o_radial_integrals_.at(memory_t::host), (int)o_radial_integrals_.size()},
+        {so_radial_integrals_.at(memory_t::host), (int)so_radial_integrals_.size()}};
     if (atom_type_.parameters().valence_relativity() == relativity_t::iora) {
-        comm__.bcast(o1_radial_integrals_.at(memory_t::host), (int)o1_radial_integrals_.size(), rank__);
+        data.push_back({o1_radial_integrals_.at(memory_t::host), (int)o1_radial_integrals_.size()});
+    }
+    return data;
+}
+
+inline void Atom_symmetry_class::sync_radial_functions(Communicator const& comm__, int const rank__)
+{
+    for (auto e : radial_functions_sync_data()) {
+        comm__.bcast(e.first, e.second, rank__);
+    }
+}
+
+inline void Atom_symmetry_class::sync_radial_integrals(Communicator const& comm__, int const rank__)
+{
+    for (auto e : radial_integrals_sync_data()) {
+        comm__.bcast(e.first, e.second, rank__);
     }
 }
 
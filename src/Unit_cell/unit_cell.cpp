@@ -1,3 +1,4 @@
+#include <tuple>
 #include "unit_cell.hpp"
 
 namespace sirius {
@@ -287,11 +288,147 @@ json Unit_cell::serialize(bool cart_pos__) const
     return dict;
 }
 
+void Unit_cell::find_nn_candidates(double radius__)
+{
+    PROFILE("sirius::Unit_cell::find_nn_candidates");
+
+    int na = num_atoms();
+
+    auto inv_lv = inverse(lattice_vectors_);
+
+    /* Split the unit cell into n0 x n1 x n2 linked cells. Height of the unit cell along the direction k is
+       h_k = 1 / |b_k|, where b_k is the k-th row of the inverse matrix of lattice vectors; the fractional coordinate
+       s_k of a vector x is s_k = b_k x, so all atoms within the radius R have |ds_k| <= R / h_k. */
+    vector3d<double> h;
+    vector3d<int> nc;
+    for (int k : {0, 1, 2}) {
+        h[k]  = 1.0 / vector3d<double>(inv_lv(k, 0), inv_lv(k, 1), inv_lv(k, 2)).length();
+        /* cells are about one third of the radius */
+        nc[k] = std::max(1, static_cast<int>(3 * h[k] / radius__));
+    }
+    /* don't make more cells than atoms */
+    while (nc[0] * nc[1] * nc[2] > std::max(1, na)) {
+        int k = (nc[0] >= nc[1] && nc[0] >= nc[2]) ? 0 : ((nc[1] >= nc[2]) ? 1 : 2);
+        nc[k]--;
+    }
+    /* range of cell offsets to check */
+    vector3d<int> dc;
+    for (int k : {0, 1, 2}) {
+        dc[k] = static_cast<int>(radius__ * nc[k] / h[k]) + 1;
+    }
+    /* the longest diagonal of a single cell */
+    double diag{0};
+    for (int s1 : {-1, 1}) {
+        for (int s2 : {-1, 1}) {
+            auto d = lattice_vectors_ * vector3d<double>(1.0 / nc[0], s1 * 1.0 / nc[1], s2 * 1.0 / nc[2]);
+            diag   = std::max(diag, d.length());
+        }
+    }
+
+    /* reduced positions, their lattice shifts and cell indices of atoms */
+    std::vector<vector3d<double>> pos(na);
+    std::vector<vector3d<int>> shift(na);
+    std::vector<vector3d<int>> cell(na);
+    block_data_descriptor atoms_in_cell(nc[0] * nc[1] * nc[2]);
+    std::vector<int> cell_atoms(na);
+    auto cell_idx = [&](vector3d<int> c) { return c[0] + nc[0] * (c[1] + nc[1] * c[2]); };
+
+    for (int ia = 0; ia < na; ia++) {
+        auto p = atom(ia).position();
+        for (int k : {0, 1, 2}) {
+            shift[ia][k] = static_cast<int>(std::floor(p[k]));
+            pos[ia][k]   = p[k] - shift[ia][k];
+            cell[ia][k]  = std::min(nc[k] - 1, static_cast<int>(pos[ia][k] * nc[k]));
+        }
+        atoms_in_cell.counts[cell_idx(cell[ia])]++;
+    }
+    atoms_in_cell.calc_offsets();
+    {
+        std::vector<int> n(atoms_in_cell.counts.size(), 0);
+        for (int ia = 0; ia < na; ia++) {
+            int ic = cell_idx(cell[ia]);
+            cell_atoms[atoms_in_cell.offsets[ic] + n[ic]++] = ia;
+        }
+    }
+
+    nn_candidates_.clear();
+    nn_candidates_.resize(na);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int ia = 0; ia < na; ia++) {
+        auto iapos = lattice_vectors_ * pos[ia];
+        for (int d0 = -dc[0]; d0 <= dc[0]; d0++) {
+            for (int d1 = -dc[1]; d1 <= dc[1]; d1++) {
+                for (int d2 = -dc[2]; d2 <= dc[2]; d2++) {
+                    vector3d<int> d(d0, d1, d2);
+                    /* skip cells which are too far */
+                    auto dcell = lattice_vectors_ *
+                                 vector3d<double>(double(d0) / nc[0], double(d1) / nc[1], double(d2) / nc[2]);
+                    if (dcell.length() - diag > radius__) {
+                        continue;
+                    }
+                    /* cell index and lattice translation */
+                    vector3d<int> c;
+                    vector3d<int> T;
+                    for (int k : {0, 1, 2}) {
+                        int j = cell[ia][k] + d[k];
+                        T[k]  = (j >= 0) ? j / nc[k] : -((-j - 1) / nc[k]) - 1;
+                        c[k]  = j - T[k] * nc[k];
+                    }
+                    int ic = cell_idx(c);
+                    for (int i = 0; i < atoms_in_cell.counts[ic]; i++) {
+                        int ja = cell_atoms[atoms_in_cell.offsets[ic] + i];
+                        auto v = lattice_vectors_ * (pos[ja] + vector3d<double>(T[0], T[1], T[2])) - iapos;
+                        /* small margin for the round-off errors; final distances are computed by the caller */
+                        if (v.length() <= radius__ + 1e-10) {
+                            nearest_neighbour_descriptor nnd;
+                            nnd.atom_id = ja;
+                            /* translation with respect to the original (not reduced) atomic positions */
+                            for (int x : {0, 1, 2}) {
+                                nnd.translation[x] = T[x] - shift[ja][x] + shift[ia][x];
+                            }
+                            nnd.distance = v.length();
+                            nn_candidates_[ia].push_back(nnd);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    nn_candidates_radius_          = radius__;
+    nn_candidates_lattice_vectors_ = lattice_vectors_;
+    nn_candidates_positions_.resize(na);
+    for (int ia = 0; ia < na; ia++) {
+        nn_candidates_positions_[ia] = get_cartesian_coordinates(atom(ia).position());
+    }
+}
+
 void Unit_cell::find_nearest_neighbours(double cluster_radius)
 {
     PROFILE("sirius::Unit_cell::find_nearest_neighbours");
 
-    auto max_frac_coord = find_translations(cluster_radius, lattice_vectors_);
+    /* check if the list of candidates can be reused */
+    bool rebuild = (static_cast<int>(nn_candidates_.size()) != num_atoms());
+    for (int i : {0, 1, 2}) {
+        for (int j : {0, 1, 2}) {
+            if (nn_candidates_lattice_vectors_(i, j) != lattice_vectors_(i, j)) {
+                rebuild = true;
+            }
+        }
+    }
+    if (!rebuild) {
+        double dmax{0};
+        for (int ia = 0; ia < num_atoms(); ia++) {
+            auto d = get_cartesian_coordinates(atom(ia).position()) - nn_candidates_positions_[ia];
+            dmax   = std::max(dmax, d.length());
+        }
+        /* distance between two atoms can't change by more than twice the maximum displacement */
+        rebuild = (cluster_radius + 2 * dmax > nn_candidates_radius_);
+    }
+    if (rebuild) {
+        find_nn_candidates(cluster_radius + parameters_.settings().nn_skin_);
+    }
 
     nearest_neighbours_.clear();
     nearest_neighbours_.resize(num_atoms());
@@ -302,42 +439,25 @@ void Unit_cell::find_nearest_neighbours(double cluster_radius)
 
         std::vector<nearest_neighbour_descriptor> nn;
 
-        std::vector<std::pair<double, int>> nn_sort;
+        for (auto nnd : nn_candidates_[ia]) {
+            auto vt    = get_cartesian_coordinates<int>(nnd.translation);
+            auto japos = get_cartesian_coordinates(atom(nnd.atom_id).position());
 
-        for (int i0 = -max_frac_coord[0]; i0 <= max_frac_coord[0]; i0++) {
-            for (int i1 = -max_frac_coord[1]; i1 <= max_frac_coord[1]; i1++) {
-                for (int i2 = -max_frac_coord[2]; i2 <= max_frac_coord[2]; i2++) {
-                    nearest_neighbour_descriptor nnd;
-                    nnd.translation[0] = i0;
-                    nnd.translation[1] = i1;
-                    nnd.translation[2] = i2;
+            vector3d<double> v = japos + vt - iapos;
 
-                    auto vt = get_cartesian_coordinates<int>(nnd.translation);
+            nnd.distance = v.length();
 
-                    for (int ja = 0; ja < num_atoms(); ja++) {
-                        nnd.atom_id = ja;
-
-                        auto japos = get_cartesian_coordinates(atom(ja).position());
-
-                        vector3d<double> v = japos + vt - iapos;
-
-                        nnd.distance = v.length();
-
-                        if (nnd.distance <= cluster_radius) {
-                            nn.push_back(nnd);
-
-                            nn_sort.push_back(std::pair<double, int>(nnd.distance, (int)nn.size() - 1));
-                        }
-                    }
-                }
+            if (nnd.distance <= cluster_radius) {
+                nn.push_back(nnd);
             }
         }
 
-        std::sort(nn_sort.begin(), nn_sort.end());
-        nearest_neighbours_[ia].resize(nn.size());
-        for (int i = 0; i < (int)nn.size(); i++) {
-            nearest_neighbours_[ia][i] = nn[nn_sort[i].second];
-        }
+        /* sort by distance; equal distances are ordered by translation and atom index */
+        std::sort(nn.begin(), nn.end(), [](nearest_neighbour_descriptor const& a, nearest_neighbour_descriptor const& b)
+        {
+            return std::tie(a.distance, a.translation, a.atom_id) < std::tie(b.distance, b.translation, b.atom_id);
+        });
+        nearest_neighbours_[ia] = std::move(nn);
     }
 
     if (parameters_.control().print_neighbors_ && comm_.rank() == 0) {
@@ -413,6 +533,51 @@ bool Unit_cell::is_point_in_mt(vector3d<double> vc, int& ja, int& jr, double& dr
     return false;
 }
 
+/// Synchronize the data of objects distributed between MPI ranks with a single MPI_Allgatherv.
+/** The object i is owned by the rank spl__.local_rank(i) and its data is described by the list of
+    (pointer, size) pairs returned by data__(i). The sizes must be the same on all ranks. Each rank packs the
+    data of its objects into a contiguous buffer, the buffers are gathered and unpacked on all ranks. */
+template <typename F>
+static void sync_packed(Communicator const& comm__, splindex<splindex_t::block> const& spl__, int n__, F&& data__)
+{
+    std::vector<int> counts(comm__.size(), 0);
+    for (int i = 0; i < n__; i++) {
+        for (auto e : data__(i)) {
+            counts[spl__.local_rank(i)] += e.second;
+        }
+    }
+    std::vector<int> displs(comm__.size(), 0);
+    for (int r = 1; r < comm__.size(); r++) {
+        displs[r] = displs[r - 1] + counts[r - 1];
+    }
+
+    std::vector<double> buf(displs.back() + counts.back());
+    /* current position in the buffer for each rank */
+    auto pos = displs;
+    for (int i = 0; i < n__; i++) {
+        int r = spl__.local_rank(i);
+        for (auto e : data__(i)) {
+            if (r == comm__.rank()) {
+                std::copy(e.first, e.first + e.second, buf.data() + pos[r]);
+            }
+            pos[r] += e.second;
+        }
+    }
+
+    comm__.allgather(buf.data(), counts.data(), displs.data());
+
+    pos = displs;
+    for (int i = 0; i < n__; i++) {
+        int r = spl__.local_rank(i);
+        for (auto e : data__(i)) {
+            if (r != comm__.rank()) {
+                std::copy(buf.data() + pos[r], buf.data() + pos[r] + e.second, e.first);
+            }
+            pos[r] += e.second;
+        }
+    }
+}
+
 void Unit_cell::generate_radial_functions()
 {
     PROFILE("sirius::Unit_cell::generate_radial_functions");
@@ -422,10 +587,8 @@ void Unit_cell::generate_radial_functions()
         atom_symmetry_class(ic).generate_radial_functions(parameters_.valence_relativity());
     }
 
-    for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
-        int rank = spl_num_atom_symmetry_classes().local_rank(ic);
-        atom_symmetry_class(ic).sync_radial_functions(comm_, rank);
-    }
+    sync_packed(comm_, spl_num_atom_symmetry_classes(), num_atom_symmetry_classes(),
+                [this](int ic) { return atom_symmetry_class(ic).radial_functions_sync_data(); });
 
     if (parameters_.control().verbosity_ >= 1) {
         pstdout pout(comm_);
@@ -456,20 +619,15 @@ void Unit_cell::generate_radial_integrals()
         atom_symmetry_class(ic).generate_radial_integrals(parameters_.valence_relativity());
     }
 
-    for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
-        int rank = spl_num_atom_symmetry_classes().local_rank(ic);
-        atom_symmetry_class(ic).sync_radial_integrals(comm_, rank);
-    }
+    sync_packed(comm_, spl_num_atom_symmetry_classes(), num_atom_symmetry_classes(),
+                [this](int ic) { return atom_symmetry_class(ic).radial_integrals_sync_data(); });
 
     for (int ialoc = 0; ialoc < spl_num_atoms_.local_size(); ialoc++) {
         int ia = spl_num_atoms_[ialoc];
         atom(ia).generate_radial_integrals(parameters_.processing_unit(), Communicator::self());
     }
 
-    for (int ia = 0; ia < num_atoms(); ia++) {
-        int rank = spl_num_atoms().local_rank(ia);
-        atom(ia).sync_radial_integrals(comm_, rank);
-    }
+    sync_packed(comm_, spl_num_atoms(), num_atoms(), [this](int ia) { return atom(ia).radial_integrals_sync_data(); });
 }
 
 std::string Unit_cell::chemical_formula()
@@ -685,6 +843,9 @@ void Unit_cell::update()
 {
     PROFILE("sirius::Unit_cell::update");
 
+    /* atoms may have moved */
+    atom_position_hash_.reset();
+
     auto v0 = lattice_vector(0);
     auto v1 = lattice_vector(1);
     auto v2 = lattice_vector(2);
@@ -834,11 +995,23 @@ void Unit_cell::set_lattice_vectors(vector3d<double> a0__, vector3d<double> a1__
 
 int Unit_cell::atom_id_by_position(vector3d<double> position__)
 {
-    for (int ia = 0; ia < num_atoms(); ia++) {
-        auto vd = atom(ia).position() - position__;
-        if (vd.length() < 1e-10) {
-            return ia;
-        }
+    /* rebuild the hash when the number of atoms has grown much above the expected one or when the atoms were
+       moved after the hash was built */
+    if (!atom_position_hash_ || num_atoms() > 2 * atom_position_hash_->capacity() ||
+        atom_position_hash_version_ != Atom::num_position_changes()) {
+        atom_position_hash_ = std::unique_ptr<Atom_position_hash>(
+            new Atom_position_hash(std::max(64, 2 * num_atoms()), 1e-10));
+        atom_position_hash_version_ = Atom::num_position_changes();
+    }
+    /* add the new atoms */
+    for (int ia = atom_position_hash_->size(); ia < num_atoms(); ia++) {
+        atom_position_hash_->add(atom(ia).position());
+    }
+
+    /* the hash finds periodic images; the position must match exactly */
+    int ia = atom_position_hash_->find(position__);
+    if (ia >= 0 && (atom(ia).position() - position__).length() < 1e-10) {
+        return ia;
     }
     return -1;
 }
@@ -145,6 +145,20 @@ class Unit_cell
     /// List of nearest neighbours for each atom.
     std::vector<std::vector<nearest_neighbour_descriptor>> nearest_neighbours_;
 
+    /// Candidate neighbours (Verlet list) for each atom found within the radius nn_candidates_radius_.
+    /** Distances in this list are not used. The list is reused by find_nearest_neighbours() as long as the atoms
+     *  have not moved further than the half of the skin distance. */
+    std::vector<std::vector<nearest_neighbour_descriptor>> nn_candidates_;
+
+    /// Radius of the candidate list (cluster radius plus skin distance).
+    double nn_candidates_radius_{-1};
+
+    /// Cartesian coordinates of atoms at the time when the candidate list was built.
+    std::vector<vector3d<double>> nn_candidates_positions_;
+
+    /// Lattice vectors at the time when the candidate list was built.
+    matrix3d<double> nn_candidates_lattice_vectors_;
+
     /// Minimum muffin-tin radius.
     double min_mt_radius_{0};
 
@@ -156,6 +170,14 @@ class Unit_cell
 
     std::unique_ptr<Unit_cell_symmetry> symmetry_;
 
+    /// Spatial hash of atomic positions used by atom_id_by_position().
+    /** The hash is extended when new atoms are added and dropped in update() or if any atom was moved by
+     *  Atom::set_position() since the hash was built. */
+    std::unique_ptr<Atom_position_hash> atom_position_hash_;
+
+    /// Value of Atom::num_position_changes() for which the position hash was built.
+    unsigned long long atom_position_hash_version_{0};
+
     /// Atomic coordinates in GPU-friendly ordering packed in arrays for each atom type.
     std::vector<mdarray<double, 2>> atom_coord_;
 
@@ -260,6 +282,10 @@ class Unit_cell
     /// Set lattice vectors.
     void set_lattice_vectors(vector3d<double> a0__, vector3d<double> a1__, vector3d<double> a2__);
 
+    /// Find all atoms and their periodic images within a given radius using the linked cells.
+    /** The result is stored in nn_candidates_. */
+    void find_nn_candidates(double radius__);
+
     /// Find the cluster of nearest neighbours around each atom
     void find_nearest_neighbours(double cluster_radius);
 
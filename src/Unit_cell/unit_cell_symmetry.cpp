@@ -130,6 +130,12 @@ Unit_cell_symmetry::Unit_cell_symmetry(matrix3d<double> const& lattice_vectors__
 
     PROFILE_START("sirius::Unit_cell_symmetry|equiv");
     sym_table_ = mdarray<int, 2>(num_atoms_, num_spg_sym());
+    /* spatial hash of atomic positions; remember that the atomic positions are not necessarily in [0,1) interval
+       and the reduction of coordinates is required */
+    Atom_position_hash atom_hash(num_atoms_, tolerance_);
+    for (int ia = 0; ia < num_atoms_; ia++) {
+        atom_hash.add(vector3d<double>(positions__(0, ia), positions__(1, ia), positions__(2, ia)));
+    }
     /* loop over spatial symmetries */
     #pragma omp parallel for schedule(static)
     for (int isym = 0; isym < num_spg_sym(); isym++) {
@@ -140,39 +146,24 @@ Unit_cell_symmetry::Unit_cell_symmetry(matrix3d<double> const& lattice_vectors__
             vector3d<double> pos(positions__(0, ia), positions__(1, ia), positions__(2, ia));
             /* apply crystal symmetry */
             auto v = reduce_coordinates(R * pos + t);
-            auto distance = [](const vector3d<double>& a, const vector3d<double>& b)
-            {
-                auto diff = a - b;
-                for (int x: {0, 1, 2}) {
-                    double dl = std::abs(diff[x]);
-                    diff[x] = std::min(dl, 1 - dl);
-                }
-                return diff.length();
-            };
-
-            double d0{1e10};
-            double j0{-1};
-            vector3d<double> p0;
-
-            int ja{-1};
-            /* check for equivalent atom; remember that the atomic positions are not necessarily in [0,1) interval
-               and the reduction of coordinates is required */
-            for (int k = 0; k < num_atoms_; k++) {
-                vector3d<double> pos1(positions__(0, k), positions__(1, k), positions__(2, k));
-                /* find the distance between original and trasformed atoms */
-                double dist = distance(v.first, reduce_coordinates(pos1).first);
-                if (dist < tolerance_) {
-                    ja = k;
-                    break;
-                }
-                if (dist < d0) {
-                    d0 = dist;
-                    j0 = k;
-                    p0 = pos1;
-                }
-            }
+
+            /* check for equivalent atom */
+            int ja = atom_hash.find(v.first);
 
             if (ja == -1) {
+                /* find the nearest atom for the error message */
+                double d0{1e10};
+                int j0{-1};
+                vector3d<double> p0;
+                for (int k = 0; k < num_atoms_; k++) {
+                    vector3d<double> pos1(positions__(0, k), positions__(1, k), positions__(2, k));
+                    double dist = Atom_position_hash::distance(v.first, reduce_coordinates(pos1).first);
+                    if (dist < d0) {
+                        d0 = dist;
+                        j0 = k;
+                        p0 = pos1;
+                    }
+                }
                 std::stringstream s;
                 s << "[sirius::Unit_cell_symmetry] equivalent atom was not found\n"
                   << "  initial atom: " << ia << " (type: " << types_[ia] << ", position : " << pos
@@ -202,7 +193,8 @@ Unit_cell_symmetry::Unit_cell_symmetry(matrix3d<double> const& lattice_vectors__
             auto Rspin = space_group_symmetry(jsym).rotation;
 
             int n{0};
-            /* check if all atoms transfrom under spatial and spin symmetries */
+            /* check if all atoms transfrom under spatial and spin symmetries; stop at the first atom which
+               does not transform */
             for (int ia = 0; ia < num_atoms_; ia++) {
                 int ja = sym_table_(ia, isym);
 
@@ -213,6 +205,8 @@ Unit_cell_symmetry::Unit_cell_symmetry(matrix3d<double> const& lattice_vectors__
 
                 if (vd.length() < 1e-10) {
                     n++;
+                } else {
+                    break;
                 }
             }
             /* if all atoms transform under spin rotaion, add it to a list */
@@ -32,6 +32,7 @@ extern "C" {
 }
 
 #include "Symmetry/rotation.hpp"
+#include "atom_position_hash.hpp"
 #include "utils/profiler.hpp"
 
 using namespace geometry3d;
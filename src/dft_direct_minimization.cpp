@@ -0,0 +1,567 @@
+// Copyright (c) 2013-2018 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file dft_direct_minimization.cpp
+ *
+ *  \brief Direct minimization of the total energy with respect to the wave-functions.
+ */
+
+#include "dft_ground_state.hpp"
+#include "SDDK/wf_inner.hpp"
+#include "SDDK/wf_trans.hpp"
+#include "utils/profiler.hpp"
+
+namespace sirius {
+
+/// Direct minimization of the Kohn-Sham total energy with respect to the wave-functions.
+/** Wave-functions are updated along the geodesics of the orbital transformation (OT) method:
+ *  \f[
+ *    C(t) = C_0 \cos(t U) + D U^{-1} \sin(t U), \quad U = (D^{H} S D)^{1/2}
+ *  \f]
+ *  where \f$ D \f$ is a search direction which satisfies \f$ C_0^{H} S D = 0 \f$. Such update keeps the wave-functions
+ *  S-orthonormal without explicit orthogonalization. The reference point \f$ C_0 \f$ of the transformation is
+ *  moved to the new wave-functions after each step, so the gradient with respect to the OT variables is simply the
+ *  projected gradient of the energy. The search direction is found by the preconditioned non-linear conjugate
+ *  gradient method (Polak-Ribiere) and the step is found by the quadratic line search.
+ *
+ *  Only the occupied bands are optimized and the occupancies stay fixed, so the method is restricted to the systems
+ *  with integer occupancies (insulators). Minimization of the smeared free energy of metals requires the ensemble-DFT
+ *  gradient with respect to the occupancies and is not implemented; such systems must be solved by the SCF loop.
+ *
+ *  All inner products of the gradients (Polak-Ribiere coefficient, slope of the line search and the residual norm)
+ *  use the same metric in which each band is weighted by its occupancy.
+ */
+template <typename T>
+class Direct_minimization
+{
+  private:
+    /// Wave-functions and derivatives of the energy for a single k-point and spin block.
+    struct block_t
+    {
+        /// Pointer to the k-point.
+        K_point* kp{nullptr};
+        /// Index of spin channel (0 or 1 in the collinear case and 2 in the non-collinear case).
+        int ispn{0};
+        /// Number of optimized bands.
+        int num_bands{0};
+        /// Wave-functions at the reference point of the line search.
+        std::unique_ptr<Wave_functions> c0;
+        /// Wave-functions at the last evaluated point.
+        std::unique_ptr<Wave_functions> c;
+        /// Hamiltonian applied to the wave-functions at the last evaluated point.
+        std::unique_ptr<Wave_functions> hc;
+        /// S operator applied to the wave-functions at the last evaluated point.
+        std::unique_ptr<Wave_functions> sc;
+        /// Gradient of the energy.
+        std::unique_ptr<Wave_functions> g;
+        /// Gradient of the energy from the previous iteration.
+        std::unique_ptr<Wave_functions> g_old;
+        /// Preconditioned and projected gradient.
+        std::unique_ptr<Wave_functions> kg;
+        /// Search direction.
+        std::unique_ptr<Wave_functions> d;
+        /// S operator applied to the search direction.
+        std::unique_ptr<Wave_functions> sd;
+        /// Subspace Hamiltonian at the last evaluated point.
+        dmatrix<T> lambda;
+        /// Eigen-vectors of the \f$ D^{H} S D \f$ matrix.
+        dmatrix<T> z;
+        /// Square roots of the eigen-values of the \f$ D^{H} S D \f$ matrix.
+        std::vector<double> w;
+        /// Diagonal of the Hamiltonian used by the preconditioner.
+        mdarray<double, 2> h_diag;
+        /// Diagonal of the S operator used by the preconditioner.
+        mdarray<double, 2> o_diag;
+
+        /// Index of spin channel of the band energies and occupancies.
+        inline int ispn_band() const
+        {
+            return (ispn == 2) ? 0 : ispn;
+        }
+
+        /// Index of spin component in the work wave-functions.
+        inline int isc() const
+        {
+            return (ispn == 2) ? 2 : 0;
+        }
+    };
+
+    DFT_ground_state& dft_;
+
+    Simulation_context& ctx_;
+
+    K_point_set& kset_;
+
+    /// List of k-point and spin blocks of this MPI rank.
+    std::vector<block_t> blocks_;
+
+    /// Hamiltonian at the last evaluated point.
+    std::unique_ptr<Hamiltonian0> H0_;
+
+    /// Copy wave-functions between the k-point and the work array.
+    void copy(block_t& b__, Wave_functions& src__, Wave_functions& dest__, bool to_kp__)
+    {
+        int num_sc = (b__.ispn == 2) ? 2 : 1;
+        for (int is = 0; is < num_sc; is++) {
+            int s = (b__.ispn == 2) ? is : b__.ispn;
+            if (to_kp__) {
+                dest__.copy_from(device_t::CPU, b__.num_bands, src__, is, 0, s, 0);
+            } else {
+                dest__.copy_from(device_t::CPU, b__.num_bands, src__, s, 0, is, 0);
+            }
+        }
+    }
+
+    /// Sum of the real parts of the band inner products weighted with the band weights.
+    template <typename F>
+    double dot(Wave_functions& a__, Wave_functions& b__, int n__, F&& weight__) const
+    {
+        double s{0};
+        for (int is = 0; is < a__.num_sc(); is++) {
+            auto& pa = a__.pw_coeffs(is);
+            auto& pb = b__.pw_coeffs(is);
+            #pragma omp parallel for schedule(static) reduction(+:s)
+            for (int i = 0; i < n__; i++) {
+                double si{0};
+                for (int ig = 0; ig < pa.num_rows_loc(); ig++) {
+                    si += std::real(std::conj(pa.prime(ig, i)) * pb.prime(ig, i));
+                }
+                if (a__.gkvec().reduced()) {
+                    si *= 2;
+                    if (a__.comm().rank() == 0) {
+                        si -= std::real(std::conj(pa.prime(0, i)) * pb.prime(0, i));
+                    }
+                }
+                s += weight__(i) * si;
+            }
+        }
+        return s;
+    }
+
+    /// Sum of the real parts of the band inner products weighted with the band occupancies.
+    /** This is the metric of the energy gradient: \f$ \partial E / \partial C_i^{*} = f_i g_i \f$. */
+    double dot_occ(block_t const& b__, Wave_functions& x__, Wave_functions& y__) const
+    {
+        return dot(x__, y__, b__.num_bands, [&](int i){return b__.kp->band_occupancy(i, b__.ispn_band());});
+    }
+
+    /// Project wave-functions to the tangent space at the reference point: \f$ X \rightarrow X - C_0 (SC_0)^{H} X \f$
+    void project(block_t& b__, Wave_functions& x__)
+    {
+        int n = b__.num_bands;
+        dmatrix<T> m(n, n);
+        inner<T>(memory_t::host, linalg_t::blas, b__.isc(), *b__.sc, 0, n, x__, 0, n, m, 0, 0);
+        transform<T>(memory_t::host, linalg_t::blas, b__.isc(), -1.0, {b__.c0.get()}, 0, n, m, 0, 0, 1.0, {&x__},
+                     0, n);
+    }
+
+    /// Regenerate density and potential from the current wave-functions and compute the total energy.
+    /** Hamiltonian and S operators are applied to the wave-functions and the diagonal elements of the subspace
+     *  Hamiltonian are stored as band energies. */
+    double evaluate()
+    {
+        PROFILE("sirius::Direct_minimization::evaluate");
+
+        auto& density   = dft_.density();
+        auto& potential = dft_.potential();
+
+        density.generate(kset_, ctx_.use_symmetry(), true, true);
+        potential.generate(density);
+        if (ctx_.use_symmetry()) {
+            potential.symmetrize();
+        }
+        potential.fft_transform(1);
+
+        H0_ = std::unique_ptr<Hamiltonian0>(new Hamiltonian0(potential));
+
+        for (auto& b : blocks_) {
+            int n = b.num_bands;
+
+            auto Hk = (*H0_)(*b.kp);
+            Hk.template apply_h_s<T>(spin_range(b.ispn), 0, n, *b.c, b.hc.get(), b.sc.get());
+            inner<T>(memory_t::host, linalg_t::blas, b.isc(), *b.c, 0, n, *b.hc, 0, n, b.lambda, 0, 0);
+            for (int i = 0; i < n; i++) {
+                b.kp->band_energy(i, b.ispn_band(), std::real(b.lambda(i, i)));
+            }
+            auto hod = Hk.template get_h_o_diag_pw<T, 3>();
+            b.h_diag = std::move(hod.first);
+            b.o_diag = std::move(hod.second);
+        }
+        kset_.sync_band_energies();
+
+        return dft_.total_energy();
+    }
+
+    /// Set the wave-functions to the point t of the geodesic line.
+    void set_point(double t__)
+    {
+        for (auto& b : blocks_) {
+            int n = b.num_bands;
+
+            dmatrix<T> mc(n, n);
+            dmatrix<T> ms(n, n);
+            dmatrix<T> tmp(n, n);
+            /* cos(tU) */
+            for (int i = 0; i < n; i++) {
+                for (int j = 0; j < n; j++) {
+                    tmp(j, i) = b.z(j, i) * std::cos(t__ * b.w[i]);
+                }
+            }
+            linalg(linalg_t::blas).gemm('N', 'C', n, n, n, &linalg_const<T>::one(), tmp.at(memory_t::host), tmp.ld(),
+                b.z.at(memory_t::host), b.z.ld(), &linalg_const<T>::zero(), mc.at(memory_t::host), mc.ld());
+            /* U^{-1} sin(tU) */
+            for (int i = 0; i < n; i++) {
+                double s = (b.w[i] > 1e-12) ? std::sin(t__ * b.w[i]) / b.w[i] : t__;
+                for (int j = 0; j < n; j++) {
+                    tmp(j, i) = b.z(j, i) * s;
+                }
+            }
+            linalg(linalg_t::blas).gemm('N', 'C', n, n, n, &linalg_const<T>::one(), tmp.at(memory_t::host), tmp.ld(),
+                b.z.at(memory_t::host), b.z.ld(), &linalg_const<T>::zero(), ms.at(memory_t::host), ms.ld());
+
+            transform<T>(memory_t::host, linalg_t::blas, b.isc(), 1.0, {b.c0.get()}, 0, n, mc, 0, 0, 0.0,
+                         {b.c.get()}, 0, n);
+            transform<T>(memory_t::host, linalg_t::blas, b.isc(), 1.0, {b.d.get()}, 0, n, ms, 0, 0, 1.0,
+                         {b.c.get()}, 0, n);
+            copy(b, *b.c, b.kp->spinor_wave_functions(), true);
+        }
+    }
+
+    /// Compute the gradient and the preconditioned gradient at the reference point.
+    /** Returns the squared norm of the residuals of the occupied bands. */
+    double gradient()
+    {
+        PROFILE("sirius::Direct_minimization::gradient");
+
+        double rnorm{0};
+        for (auto& b : blocks_) {
+            int n    = b.num_bands;
+            double w = b.kp->weight();
+
+            /* g = w (HC - SC Lambda) */
+            for (int is = 0; is < b.g->num_sc(); is++) {
+                b.g->copy_from(device_t::CPU, n, *b.hc, is, 0, is, 0);
+            }
+            transform<T>(memory_t::host, linalg_t::blas, b.isc(), -1.0, {b.sc.get()}, 0, n, b.lambda, 0, 0, 1.0,
+                         {b.g.get()}, 0, n);
+            for (int is = 0; is < b.g->num_sc(); is++) {
+                int s = (b.ispn == 2) ? is : b.ispn;
+                #pragma omp parallel for schedule(static)
+                for (int i = 0; i < n; i++) {
+                    double eval = std::real(b.lambda(i, i));
+                    for (int ig = 0; ig < b.g->pw_coeffs(is).num_rows_loc(); ig++) {
+                        b.g->pw_coeffs(is).prime(ig, i) *= w;
+                        /* same preconditioner as in the Davidson solver */
+                        double p = b.h_diag(ig, s) - b.o_diag(ig, s) * eval;
+                        p        = 0.5 * (1 + p + std::sqrt(1 + (p - 1) * (p - 1)));
+                        b.kg->pw_coeffs(is).prime(ig, i) = b.g->pw_coeffs(is).prime(ig, i) / p;
+                    }
+                }
+            }
+            project(b, *b.kg);
+
+            rnorm += dot(*b.g, *b.g, n, [&](int i){return b.kp->band_occupancy(i, b.ispn_band()) /
+                                                           ctx_.max_occupancy() / std::pow(w, 2);});
+        }
+        ctx_.comm().allreduce(&rnorm, 1);
+        return rnorm;
+    }
+
+    /// Find the step along the geodesic line which lowers the energy.
+    /** Returns true and the new energy if the step was found. */
+    bool line_search(double e0__, double slope__, double& step__, double& e__)
+    {
+        PROFILE("sirius::Direct_minimization::line_search");
+
+        /* decompose D^H S D */
+        for (auto& b : blocks_) {
+            int n = b.num_bands;
+
+            auto Hk = (*H0_)(*b.kp);
+            Hk.template apply_h_s<T>(spin_range(b.ispn), 0, n, *b.d, nullptr, b.sd.get());
+
+            dmatrix<T> u2(n, n);
+            inner<T>(memory_t::host, linalg_t::blas, b.isc(), *b.d, 0, n, *b.sd, 0, n, u2, 0, 0);
+            b.w.resize(n);
+            if (Eigensolver_lapack().solve(n, u2, b.w.data(), b.z)) {
+                TERMINATE("error in diagonalziation");
+            }
+            for (int i = 0; i < n; i++) {
+                b.w[i] = std::sqrt(std::max(b.w[i], 0.0));
+            }
+        }
+
+        /* try the step and fit the parabola E(t) = e0 + slope * t + a * t^2 */
+        double t1 = step__;
+        set_point(t1);
+        double e1 = evaluate();
+        double a  = (e1 - e0__ - slope__ * t1) / std::pow(t1, 2);
+        if (a > 0) {
+            double t2 = std::min(-slope__ / (2 * a), 4 * t1);
+            set_point(t2);
+            double e2 = evaluate();
+            if (e2 < e1 && e2 < e0__) {
+                step__ = t2;
+                e__    = e2;
+                return true;
+            }
+            if (e1 < e0__) {
+                set_point(t1);
+                e__    = evaluate();
+                step__ = t1;
+                return true;
+            }
+        } else {
+            if (e1 < e0__) {
+                step__ = t1;
+                e__    = e1;
+                return true;
+            }
+        }
+        /* backtracking */
+        double t = t1;
+        for (int i = 0; i < 8; i++) {
+            t /= 4;
+            set_point(t);
+            double e = evaluate();
+            if (e < e0__) {
+                step__ = t;
+                e__    = e;
+                return true;
+            }
+        }
+        /* restore the reference point */
+        set_point(0);
+        e__ = evaluate();
+        return false;
+    }
+
+  public:
+    Direct_minimization(DFT_ground_state& dft__)
+        : dft_(dft__)
+        , ctx_(dft__.k_point_set().ctx())
+        , kset_(dft__.k_point_set())
+    {
+    }
+
+    json find(double energy_tol__, double residual_tol__, int num_iter__)
+    {
+        PROFILE("sirius::Direct_minimization::find");
+
+        auto tstart = std::chrono::high_resolution_clock::now();
+
+        /* start from the wave-functions of the initial potential */
+        {
+            Hamiltonian0 H0(dft_.potential());
+            Band(ctx_).solve(kset_, H0, true);
+        }
+        kset_.find_band_occupancies();
+
+        /* the occupancies are kept fixed; fractional occupancies would require the minimization of the free energy */
+        int metal{0};
+        for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+            auto kp = kset_[kset_.spl_num_kpoints(ikloc)];
+            for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+                for (int j = 0; j < ctx_.num_bands(); j++) {
+                    double f = kp->band_occupancy(j, ispn) / ctx_.max_occupancy();
+                    if (f > 1e-8 && f < 1 - 1e-8) {
+                        metal = 1;
+                    }
+                }
+            }
+        }
+        ctx_.comm().template allreduce<int, mpi_op_t::max>(&metal, 1);
+        if (metal) {
+            TERMINATE("direct minimization is implemented only for the systems with integer occupancies (insulators)");
+        }
+
+        bool nc_mag = (ctx_.num_mag_dims() == 3);
+        int num_sc  = nc_mag ? 2 : 1;
+
+        auto& mp = ctx_.mem_pool(memory_t::host);
+
+        blocks_.clear();
+        for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+            auto kp = kset_[kset_.spl_num_kpoints(ikloc)];
+            for (int ispn_step = 0; ispn_step < (nc_mag ? 1 : ctx_.num_spins()); ispn_step++) {
+                block_t b;
+                b.kp        = kp;
+                b.ispn      = nc_mag ? 2 : ispn_step;
+                b.num_bands = kp->num_occupied_bands(b.ispn_band());
+                if (b.num_bands == 0) {
+                    continue;
+                }
+                int n = b.num_bands;
+                for (auto wf : {&b.c0, &b.c, &b.hc, &b.sc, &b.g, &b.g_old, &b.kg, &b.d, &b.sd}) {
+                    wf->reset(new Wave_functions(mp, kp->gkvec_partition(), n, memory_t::host, num_sc));
+                }
+                b.lambda = dmatrix<T>(n, n);
+                b.z      = dmatrix<T>(n, n);
+                copy(b, kp->spinor_wave_functions(), *b.c, false);
+                copy(b, kp->spinor_wave_functions(), *b.c0, false);
+                blocks_.push_back(std::move(b));
+            }
+        }
+
+        double etot = evaluate();
+
+        std::vector<double> etot_hist;
+        std::vector<double> rnorm_hist;
+
+        double step{0.2};
+        double kg_g_old{0};
+        bool restart{true};
+        int num_iter{-1};
+        double eold{etot};
+
+        for (int iter = 0; iter < num_iter__; iter++) {
+            PROFILE("sirius::Direct_minimization::find|iteration");
+
+            double rnorm = std::sqrt(gradient());
+
+            etot_hist.push_back(etot);
+            rnorm_hist.push_back(rnorm);
+
+            if (ctx_.comm().rank() == 0 && ctx_.control().verbosity_ >= 1) {
+                std::printf("iteration : %3i, energy : %18.12f, energy difference : %18.12E, residual : %18.12E\n",
+                            iter, etot, etot - eold, rnorm);
+            }
+            if (iter > 0 && std::abs(etot - eold) < energy_tol__ && rnorm < residual_tol__) {
+                if (ctx_.comm().rank() == 0 && ctx_.control().verbosity_ >= 1) {
+                    std::printf("\n");
+                    std::printf("converged after %i iterations!\n", iter);
+                }
+                num_iter = iter;
+                break;
+            }
+
+            /* Polak-Ribiere coefficient */
+            std::array<double, 2> pr{0, 0};
+            for (auto& b : blocks_) {
+                pr[0] += dot_occ(b, *b.kg, *b.g);
+                pr[1] += dot_occ(b, *b.kg, *b.g_old);
+            }
+            ctx_.comm().allreduce(pr.data(), 2);
+            double beta = restart ? 0 : std::max(0.0, (pr[0] - pr[1]) / kg_g_old);
+
+            double slope{0};
+            for (auto& b : blocks_) {
+                int n = b.num_bands;
+                if (beta != 0) {
+                    project(b, *b.d);
+                }
+                for (int is = 0; is < b.d->num_sc(); is++) {
+                    #pragma omp parallel for schedule(static)
+                    for (int i = 0; i < n; i++) {
+                        for (int ig = 0; ig < b.d->pw_coeffs(is).num_rows_loc(); ig++) {
+                            auto d = (beta != 0) ? beta * b.d->pw_coeffs(is).prime(ig, i) : double_complex(0, 0);
+                            b.d->pw_coeffs(is).prime(ig, i) = d - b.kg->pw_coeffs(is).prime(ig, i);
+                        }
+                    }
+                    b.g_old->copy_from(device_t::CPU, n, *b.g, is, 0, is, 0);
+                }
+                slope += 2 * dot_occ(b, *b.g, *b.d);
+            }
+            ctx_.comm().allreduce(&slope, 1);
+            kg_g_old = pr[0];
+
+            /* restart with the steepest descent if this is not a descent direction */
+            if (slope >= 0 && beta != 0) {
+                slope = 0;
+                for (auto& b : blocks_) {
+                    for (int is = 0; is < b.d->num_sc(); is++) {
+                        b.d->copy_from(device_t::CPU, b.num_bands, *b.kg, is, 0, is, 0);
+                        b.d->scale(memory_t::host, is, 0, b.num_bands, -1);
+                    }
+                    slope += 2 * dot_occ(b, *b.g, *b.d);
+                }
+                ctx_.comm().allreduce(&slope, 1);
+            }
+            if (slope >= 0) {
+                ctx_.message(1, __function_name__, "%s", "search direction is not a descent direction\n");
+                break;
+            }
+
+            eold = etot;
+            if (!line_search(eold, slope, step, etot)) {
+                if (restart) {
+                    ctx_.message(1, __function_name__, "%s", "line search has failed\n");
+                    break;
+                }
+                /* try again from the steepest descent direction */
+                restart = true;
+                step    = 0.2;
+                continue;
+            }
+            restart = false;
+
+            /* new reference point of the orbital transformation */
+            for (auto& b : blocks_) {
+                for (int is = 0; is < b.c->num_sc(); is++) {
+                    b.c0->copy_from(device_t::CPU, b.num_bands, *b.c, is, 0, is, 0);
+                }
+            }
+        }
+
+        /* get the band energies and the empty states in the final potential */
+        ctx_.iterative_solver_tolerance(ctx_.settings().itsol_tol_min_);
+        {
+            Hamiltonian0 H0(dft_.potential());
+            Band(ctx_).solve(kset_, H0, true);
+        }
+        kset_.find_band_occupancies();
+
+        auto tstop = std::chrono::high_resolution_clock::now();
+
+        json dict = dft_.serialize();
+        dict["scf_time"]     = std::chrono::duration_cast<std::chrono::duration<double>>(tstop - tstart).count();
+        dict["etot_history"] = etot_hist;
+        dict["residual_history"] = rnorm_hist;
+        if (num_iter >= 0) {
+            dict["converged"]          = true;
+            dict["num_scf_iterations"] = num_iter;
+        } else {
+            dict["converged"] = false;
+        }
+        return dict;
+    }
+};
+
+json DFT_ground_state::find_direct(double energy_tol__, double residual_tol__, int num_iter__)
+{
+    PROFILE("sirius::DFT_ground_state::find_direct");
+
+    if (ctx_.full_potential()) {
+        TERMINATE("direct minimization is implemented only for the pseudopotential case");
+    }
+    if (ctx_.hubbard_correction()) {
+        TERMINATE("direct minimization is not implemented for the Hubbard correction");
+    }
+    if (ctx_.processing_unit() != device_t::CPU) {
+        TERMINATE("direct minimization is implemented only for the CPU");
+    }
+
+    if (ctx_.gamma_point() && (ctx_.so_correction() == false)) {
+        return Direct_minimization<double>(*this).find(energy_tol__, residual_tol__, num_iter__);
+    } else {
+        return Direct_minimization<double_complex>(*this).find(energy_tol__, residual_tol__, num_iter__);
+    }
+}
+
+} // namespace sirius
@@ -105,6 +105,8 @@ json DFT_ground_state::serialize()
     dict["num_atoms"]               = ctx_.unit_cell().num_atoms();
     dict["energy"]                  = json::object();
     dict["energy"]["total"]         = total_energy();
+    dict["energy"]["free"]          = free_energy();
+    dict["energy"]["entropy_sum"]   = kset_.entropy_sum();
     dict["energy"]["enuc"]          = energy_enuc(ctx_, potential_);
     dict["energy"]["core_eval_sum"] = core_eval_sum(ctx_.unit_cell());
     dict["energy"]["vha"]           = energy_vha(potential_);
@@ -212,6 +214,9 @@ json DFT_ground_state::find(double rms_tol, double energy_tol, double initial_to
             std::printf("| SCF iteration %3i out of %3i |\n", iter, num_dft_iter);
             std::printf("+------------------------------+\n");
         }
+        /* redistribute k-points if the measured load imbalance is too large */
+        kset_.rebalance();
+
         Hamiltonian0 H0(potential_);
         /* find new wave-functions */
         Band(ctx_).solve(kset_, H0, true);
@@ -468,6 +473,9 @@ void DFT_ground_state::print_info()
         }
 
         std::printf("Total energy              : %18.8f (Ha), %18.8f (Ry)\n", etot, etot * 2);
+        std::printf("smearing (-TS)            : %18.8f\n", kset_.entropy_sum());
+        std::printf("Free energy               : %18.8f (Ha), %18.8f (Ry)\n", etot + kset_.entropy_sum(),
+                    (etot + kset_.entropy_sum()) * 2);
 
         std::printf("\n");
         std::printf("band gap (eV) : %18.8f\n", gap);
@@ -129,6 +129,12 @@ class DFT_ground_state
 
     double total_energy() const;
 
+    /// Free energy: total energy plus the smearing contribution -TS.
+    inline double free_energy() const
+    {
+        return total_energy() + kset_.entropy_sum();
+    }
+
     /// Generate initial densty, potential and a subspace of wave-functions.
     void initial_state();
 
@@ -138,6 +144,11 @@ class DFT_ground_state
     /// Run the SCF ground state calculation and find a total energy minimum.
     json find(double density_tol, double energy_tol, double initial_tolerance, int num_dft_iter, bool write_state);
 
+    /// Find a total energy minimum by the direct minimization with respect to the wave-functions.
+    /** Only insulators (integer occupancies) are supported; the ensemble-DFT minimization of the free energy of
+     *  metals is not implemented. Implemented in dft_direct_minimization.cpp */
+    json find_direct(double energy_tol__, double residual_tol__, int num_iter__);
+
     /// Print the basic information (total energy, charges, moments, etc.).
     void print_info();
 
@@ -1,11 +1,18 @@
 #include "energy.hpp"
+#include "Geometry/ewald_spme.hpp"
 
 namespace sirius {
-double ewald_energy(const Simulation_context& ctx, const Gvec& gvec, const Unit_cell& unit_cell)
+double ewald_energy(Simulation_context& ctx, const Gvec& gvec, const Unit_cell& unit_cell)
 {
     double alpha{ctx.ewald_lambda()};
     double ewald_g{0};
 
+    /* particle-mesh approximation of the structure factor is defined on the default set of G-vectors */
+    std::unique_ptr<Ewald_spme> spme;
+    if (ctx.settings().ewald_spme_ && &gvec == &ctx.gvec()) {
+        spme = std::unique_ptr<Ewald_spme>(new Ewald_spme(ctx, ctx.settings().ewald_spme_order_));
+    }
+
     #pragma omp parallel for reduction(+ : ewald_g)
     for (int igloc = 0; igloc < gvec.count(); igloc++) {
         int ig = gvec.offset() + igloc;
@@ -15,13 +22,18 @@ double ewald_energy(const Simulation_context& ctx, const Gvec& gvec, const Unit_
 
         double g2 = std::pow(gvec.gvec_len(ig), 2);
 
-        double_complex rho(0, 0);
-
-        for (int ia = 0; ia < unit_cell.num_atoms(); ia++) {
-            rho += ctx.gvec_phase_factor(gvec.gvec(ig), ia) * static_cast<double>(unit_cell.atom(ia).zn());
+        double rho2{0};
+        if (spme) {
+            rho2 = spme->structure_factor_sq(igloc);
+        } else {
+            double_complex rho(0, 0);
+            for (int ia = 0; ia < unit_cell.num_atoms(); ia++) {
+                rho += ctx.gvec_phase_factor(gvec.gvec(ig), ia) * static_cast<double>(unit_cell.atom(ia).zn());
+            }
+            rho2 = std::norm(rho);
         }
 
-        ewald_g += std::pow(std::abs(rho), 2) * std::exp(-g2 / 4 / alpha) / g2;
+        ewald_g += rho2 * std::exp(-g2 / 4 / alpha) / g2;
     }
 
     ctx.comm().allreduce(&ewald_g, 1);
@@ -86,7 +86,11 @@ namespace sirius {
  *      \frac{N_{el}^2}{4 \lambda}
  *  \f]
  */
-double ewald_energy(const Simulation_context& ctx, const Gvec& gvec, const Unit_cell& unit_cell);
+/*
+ *  If <tt>settings.ewald_spme</tt> is set, the structure factor of the G-space sum is computed with the smooth
+ *  particle-mesh Ewald method (see sirius::Ewald_spme).
+ */
+double ewald_energy(Simulation_context& ctx, const Gvec& gvec, const Unit_cell& unit_cell);
 
 /// Returns exchange correlation potential.
 double energy_vxc(Density const& density, Potential const& potential);
@@ -42,57 +42,35 @@ void Field4D::symmetrize(Periodic_function<double>* f__, Periodic_function<doubl
 
     auto& remap_gvec = ctx_.remap_gvec();
 
-    if (ctx_.control().print_hash_) {
-        auto h = f__->hash_f_pw();
-        if (ctx_.comm().rank() == 0) {
-            utils::print_hash("f_unsymmetrized(G)", h);
-        }
-    }
-
-    symmetrize_function(ctx_.unit_cell().symmetry(), remap_gvec, ctx_.sym_phase_factors(), &f__->f_pw_local(0));
-
-    if (ctx_.control().print_hash_) {
-        auto h = f__->hash_f_pw();
-        if (ctx_.comm().rank() == 0) {
-            utils::print_hash("f_symmetrized(G)", h);
-        }
-    }
-
-    /* symmetrize PW components */
-    switch (ctx_.num_mag_dims()) {
-        case 1: {
-            symmetrize_vector_function(ctx_.unit_cell().symmetry(), remap_gvec, ctx_.sym_phase_factors(),
-                                       &gz__->f_pw_local(0));
-            break;
-        }
-        case 3: {
-            if (ctx_.control().print_hash_) {
-                auto h1 = gx__->hash_f_pw();
-                auto h2 = gy__->hash_f_pw();
-                auto h3 = gz__->hash_f_pw();
-                if (ctx_.comm().rank() == 0) {
-                    utils::print_hash("fx_unsymmetrized(G)", h1);
-                    utils::print_hash("fy_unsymmetrized(G)", h2);
-                    utils::print_hash("fz_unsymmetrized(G)", h3);
-                }
+    auto print_hash = [&](std::string label)
+    {
+        if (ctx_.control().print_hash_) {
+            auto h = f__->hash_f_pw();
+            if (ctx_.comm().rank() == 0) {
+                utils::print_hash("f_" + label + "(G)", h);
             }
-
-            symmetrize_vector_function(ctx_.unit_cell().symmetry(), remap_gvec, ctx_.sym_phase_factors(),
-                                       &gx__->f_pw_local(0), &gy__->f_pw_local(0), &gz__->f_pw_local(0));
-
-            if (ctx_.control().print_hash_) {
+            if (ctx_.num_mag_dims() == 3) {
                 auto h1 = gx__->hash_f_pw();
                 auto h2 = gy__->hash_f_pw();
                 auto h3 = gz__->hash_f_pw();
                 if (ctx_.comm().rank() == 0) {
-                    utils::print_hash("fx_symmetrized(G)", h1);
-                    utils::print_hash("fy_symmetrized(G)", h2);
-                    utils::print_hash("fz_symmetrized(G)", h3);
+                    utils::print_hash("fx_" + label + "(G)", h1);
+                    utils::print_hash("fy_" + label + "(G)", h2);
+                    utils::print_hash("fz_" + label + "(G)", h3);
                 }
             }
-            break;
         }
-    }
+    };
+
+    print_hash("unsymmetrized");
+
+    /* symmetrize PW components of the scalar and vector parts in one pass */
+    symmetrize_pw_function(ctx_.unit_cell().symmetry(), remap_gvec, ctx_.sym_phase_factors(), ctx_.num_mag_dims(),
+                           &f__->f_pw_local(0), (ctx_.num_mag_dims() == 3) ? &gx__->f_pw_local(0) : nullptr,
+                           (ctx_.num_mag_dims() == 3) ? &gy__->f_pw_local(0) : nullptr,
+                           ctx_.num_mag_dims() ? &gz__->f_pw_local(0) : nullptr);
+
+    print_hash("symmetrized");
 
     if (ctx_.full_potential()) {
         /* symmetrize MT components */
@@ -834,6 +834,45 @@ call sirius_find_ground_state_aux(gs_handler,density_tol_ptr,energy_tol_ptr,nite
 &save_state_ptr)
 end subroutine sirius_find_ground_state
 
+!> @brief Find the ground state by the direct minimization of the total energy.
+!> @param [in] gs_handler Handler of the ground state.
+!> @param [in] energy_tol Tolerance in total energy difference.
+!> @param [in] residual_tol Tolerance on the norm of the energy gradient.
+!> @param [in] niter Maximum number of iterations.
+subroutine sirius_find_ground_state_direct(gs_handler,energy_tol,residual_tol,niter)
+implicit none
+type(C_PTR), intent(in) :: gs_handler
+real(C_DOUBLE), optional, target, intent(in) :: energy_tol
+real(C_DOUBLE), optional, target, intent(in) :: residual_tol
+integer(C_INT), optional, target, intent(in) :: niter
+type(C_PTR) :: energy_tol_ptr
+type(C_PTR) :: residual_tol_ptr
+type(C_PTR) :: niter_ptr
+interface
+subroutine sirius_find_ground_state_direct_aux(gs_handler,energy_tol,residual_tol,&
+&niter)&
+&bind(C, name="sirius_find_ground_state_direct")
+use, intrinsic :: ISO_C_BINDING
+type(C_PTR), intent(in) :: gs_handler
+type(C_PTR), value :: energy_tol
+type(C_PTR), value :: residual_tol
+type(C_PTR), value :: niter
+end subroutine
+end interface
+
+energy_tol_ptr = C_NULL_PTR
+if (present(energy_tol)) energy_tol_ptr = C_LOC(energy_tol)
+
+residual_tol_ptr = C_NULL_PTR
+if (present(residual_tol)) residual_tol_ptr = C_LOC(residual_tol)
+
+niter_ptr = C_NULL_PTR
+if (present(niter)) niter_ptr = C_LOC(niter)
+
+call sirius_find_ground_state_direct_aux(gs_handler,energy_tol_ptr,residual_tol_ptr,&
+&niter_ptr)
+end subroutine sirius_find_ground_state_direct
+
 !> @brief Update a ground state object after change of atomic coordinates or lattice vectors.
 !> @param [in] gs_handler Ground-state handler.
 subroutine sirius_update_ground_state(gs_handler)
@@ -1832,6 +1871,9 @@ call sirius_get_wave_functions_aux(ks_handler,ik,ispn,npw,gvec_k,evc,ld1,ld2)
 end subroutine sirius_get_wave_functions
 
 !> @brief Get value of the radial integral.
+!> @details Tables of the "aug_dj" and "beta_dj" integrals are created on the first request (and recreated
+!> after they are released in the low-memory mode). The creation is collective: the first call with
+!> such a label must be made by all MPI ranks of the simulation context outside of OpenMP regions.
 !> @param [in] handler Simulation context handler.
 !> @param [in] atom_type Label of the atom type.
 !> @param [in] label Label of the radial integral.
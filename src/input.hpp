@@ -403,12 +403,29 @@ struct Control_input
     bool use_second_variation_{true};
 
     /// Control the usage of the GPU memory.
-    /** Possible values are: "low", "medium" and "high". */
+    /** Possible values are: "low", "medium" and "high". In the "low" mode the auxiliary radial integrals
+        (derivatives of radial integrals and integrals of atomic wave-functions) are also released after use, and
+        the FFT drivers and gradient buffers of the GGA terms are released after each XC potential update. */
     std::string memory_usage_{"high"};
 
     /// Number of atoms in the beta-projectors chunk.
     int beta_chunk_size_{256};
 
+    /// Distribution of k-points between MPI ranks ("block" or "cost").
+    /** In the "block" mode each rank gets the same number of k-points. In the "cost" mode k-points are split in
+     *  contiguous chunks of approximately equal estimated cost (number of G+k vectors times number of bands). */
+    std::string kpoints_distribution_{"block"};
+
+    /// Threshold for the k-point load imbalance which triggers the redistribution between SCF iterations.
+    /** Imbalance is measured as the ratio of the maximum and average time of the band solver minus one.
+     *  Negative value switches off the redistribution. */
+    double kpoints_rebalance_threshold_{-1};
+
+    /// Number of k-points which are solved concurrently on each MPI rank.
+    /** Each k-point is solved by its own team of OpenMP threads with separate FFT buffers. This is used only in the
+     *  pseudopotential case on the CPU when a single MPI rank is assigned to a k-point. */
+    int num_kpoint_teams_{1};
+
     void read(json const& parser)
     {
         if (parser.count("control")) {
@@ -435,9 +452,12 @@ struct Control_input
             print_neighbors_     = section.value("print_neighbors", print_neighbors_);
             memory_usage_        = section.value("memory_usage", memory_usage_);
             beta_chunk_size_     = section.value("beta_chunk_size", beta_chunk_size_);
+            kpoints_distribution_ = section.value("kpoints_distribution", kpoints_distribution_);
+            kpoints_rebalance_threshold_ = section.value("kpoints_rebalance_threshold", kpoints_rebalance_threshold_);
+            num_kpoint_teams_    = section.value("num_kpoint_teams", num_kpoint_teams_);
 
             auto strings = {&std_evp_solver_name_, &gen_evp_solver_name_, &fft_mode_, &processing_unit_,
-                            &memory_usage_};
+                            &memory_usage_, &kpoints_distribution_};
             for (auto s : strings) {
                 std::transform(s->begin(), s->end(), s->begin(), ::tolower);
             }
@@ -447,6 +467,10 @@ struct Control_input
             if (std::find(kw.begin(), kw.end(), memory_usage_) == kw.end()) {
                 throw std::runtime_error("wrong memory_usage input");
             }
+            kw = {"block", "cost"};
+            if (std::find(kw.begin(), kw.end(), kpoints_distribution_) == kw.end()) {
+                throw std::runtime_error("wrong kpoints_distribution input");
+            }
         }
     }
 };
@@ -474,7 +498,10 @@ struct Parameters_input
     /// Number of first-variational states.
     int num_fv_states_{-1};
 
-    /// Width of Gaussian smearing function in the units of [Ha].
+    /// Type of smearing function of the band occupancies.
+    std::string smearing_{"gaussian"};
+
+    /// Width of the smearing function in the units of [Ha].
     double smearing_width_{0.01};
 
     /// Cutoff for plane-waves (for density and potential expansion) in the units of [a.u.^-1].
@@ -574,6 +601,9 @@ struct Parameters_input
             std::transform(valence_relativity_.begin(), valence_relativity_.end(), valence_relativity_.begin(),
                            ::tolower);
 
+            smearing_ = section.value("smearing", smearing_);
+            std::transform(smearing_.begin(), smearing_.end(), smearing_.begin(), ::tolower);
+
             num_fv_states_  = section.value("num_fv_states", num_fv_states_);
             smearing_width_ = section.value("smearing_width", smearing_width_);
             pw_cutoff_      = section.value("pw_cutoff", pw_cutoff_);
@@ -674,6 +704,58 @@ struct Settings_input
     /** 0 is Lebedev-Laikov coverage, 1 is unifrom coverage */
     int sht_coverage_{0};
 
+    /// Inner fraction of radial points of muffin-tin spheres which use the reduced spherical mesh.
+    /** Close to the nucleus the density is nearly spherical and the XC potential is computed on the spherical
+        mesh for sht_inner_lmax_ instead of the full one. Zero disables the reduced mesh. */
+    double sht_inner_fraction_{0};
+
+    /// Maximum \f$ \ell \f$ of the reduced spherical mesh; negative value selects half of the full \f$ \ell_{max} \f$.
+    int sht_inner_lmax_{-1};
+
+    /// Use the built-in implementations of the Slater, PZ, PW and PBE functionals instead of Libxc.
+    bool xc_native_{false};
+
+    /// Density below which the built-in XC kernels return zero.
+    double xc_dens_threshold_{1e-12};
+
+    /// Skin distance (in a.u.) of the list of candidate nearest neighbours.
+    /** The list of candidates is not rebuilt until some atom moves further than half of this distance. */
+    double nn_skin_{1.0};
+
+    /// Use smooth particle-mesh Ewald summation for the G-space part of the ion-ion interaction.
+    /** The ionic structure factor is obtained from the B-spline interpolation of point charges on the
+        fine-grained FFT grid instead of the explicit sum over atoms for each G-vector. */
+    bool ewald_spme_{false};
+
+    /// Order of the cardinal B-splines used in the particle-mesh Ewald summation.
+    int ewald_spme_order_{8};
+
+    /// Maximum size (in Mb) of the per-rank cache of atomic phase factors.
+    /** Phase factors \f$ e^{i{\bf G}{\bf r}_{\alpha}} \f$ for the local set of G-vectors are stored for all atoms
+        if they fit in this limit; otherwise they are generated on the fly. Zero disables the cache. The cache is
+        not used if control.memory_usage is "low". */
+    int phase_factors_cache_size_{256};
+
+    /// Tolerance (in fractional coordinates) for the detection of moved atoms.
+    /** On the update of the simulation context the phase factors are recomputed only for the atoms
+        which moved further than this value. */
+    double atom_pos_tol_{1e-12};
+
+    /// Number of incremental updates of the phase factors of atom types after which they are summed from scratch.
+    /** Incremental updates subtract the old and add the new contributions of the moved atoms and accumulate the
+        rounding errors over a long run; periodic summation over all atoms removes them. */
+    int phase_factors_t_rebuild_{20};
+
+    /// Skin distance (in a.u.) of the lists of real-space grid points around atoms.
+    /** Grid points are searched in the sphere of radius \f$ R + \delta \f$; the list is rebuilt only for the atoms
+        which moved further than the skin distance \f$ \delta \f$. Zero disables the reuse of the lists. */
+    double grid_skin_{0.5};
+
+    /// Directory of the on-disk cache of radial integrals.
+    /** Tables of radial integrals are stored in this directory and reused by the runs with the same species data,
+        q-grids and version of the code. Empty string disables the cache. */
+    std::string radial_cache_dir_{""};
+
     void read(json const& parser)
     {
         if (parser.count("settings")) {
@@ -691,7 +773,19 @@ struct Settings_input
             itsol_tol_ratio_  = section.value("itsol_tol_ratio", itsol_tol_ratio_);
             itsol_tol_scale_  = section.value("itsol_tol_scale", itsol_tol_scale_);
             sht_coverage_     = section.value("sht_coverage", sht_coverage_);
+            sht_inner_fraction_ = section.value("sht_inner_fraction", sht_inner_fraction_);
+            sht_inner_lmax_   = section.value("sht_inner_lmax", sht_inner_lmax_);
+            xc_native_        = section.value("xc_native", xc_native_);
+            xc_dens_threshold_ = section.value("xc_dens_threshold", xc_dens_threshold_);
             min_occupancy_    = section.value("min_occupancy", min_occupancy_);
+            nn_skin_          = section.value("nn_skin", nn_skin_);
+            ewald_spme_       = section.value("ewald_spme", ewald_spme_);
+            ewald_spme_order_ = section.value("ewald_spme_order", ewald_spme_order_);
+            phase_factors_cache_size_ = section.value("phase_factors_cache_size", phase_factors_cache_size_);
+            atom_pos_tol_     = section.value("atom_pos_tol", atom_pos_tol_);
+            phase_factors_t_rebuild_ = section.value("phase_factors_t_rebuild", phase_factors_t_rebuild_);
+            grid_skin_        = section.value("grid_skin", grid_skin_);
+            radial_cache_dir_ = section.value("radial_cache_dir", radial_cache_dir_);
         }
     }
 };
@@ -270,18 +270,19 @@ class Periodic_function : public Smooth_periodic_function<T>
         std::vector<double_complex> v(gvec_.num_gvec());
         h5f__.read("f_pw", reinterpret_cast<double*>(v.data()), static_cast<int>(v.size() * 2));
 
-        std::map<vector3d<int>, int> local_gvec_mapping;
+        gvec_index_map local_gvec_mapping(gvec_.count());
 
         for (int igloc = 0; igloc < gvec_.count(); igloc++) {
-            int  ig               = gvec_.offset() + igloc;
-            auto G                = gvec_.gvec(ig);
-            local_gvec_mapping[G] = igloc;
+            int ig = gvec_.offset() + igloc;
+            local_gvec_mapping.insert(gvec_.gvec(ig), igloc);
         }
 
+        auto igloc = local_gvec_mapping.find(gvec_.num_gvec(), &gvec__(0, 0));
+
+        #pragma omp parallel for schedule(static)
         for (int ig = 0; ig < gvec_.num_gvec(); ig++) {
-            vector3d<int> G(&gvec__(0, ig));
-            if (local_gvec_mapping.count(G) != 0) {
-                this->f_pw_local_[local_gvec_mapping[G]] = v[ig];
+            if (igloc[ig] >= 0) {
+                this->f_pw_local_[igloc[ig]] = v[ig];
             }
         }
 
@@ -1,50 +1,334 @@
-#include "radial_integrals.hpp"
+#include <cstdio>
 #include <omp.h>
+#include "radial_integrals.hpp"
+#include "sirius_version.hpp"
+#include "SDDK/linalg.hpp"
 
 namespace sirius {
 
-template <bool jl_deriv>
-void Radial_integrals_atomic_wf<jl_deriv>::generate()
+/// Hash of the radial data of all atom types.
+static uint64_t species_hash(Unit_cell const& unit_cell__, uint64_t h)
 {
-    PROFILE("sirius::Radial_integrals|atomic_wfs");
+    auto hash_vec = [&h](std::vector<double> const& v) {
+        int n = static_cast<int>(v.size());
+        h     = utils::hash(&n, sizeof(int), h);
+        if (n) {
+            h = utils::hash(v.data(), n * sizeof(double), h);
+        }
+    };
 
-    /* spherical Bessel functions jl(qx) */
-    sddk::mdarray<Spherical_Bessel_functions, 1> jl(nq());
+    for (int iat = 0; iat < unit_cell__.num_atom_types(); iat++) {
+        auto& atom_type = unit_cell__.atom_type(iat);
 
-    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+        std::vector<double> v{static_cast<double>(atom_type.zn()), static_cast<double>(atom_type.num_mt_points())};
+        for (int ir = 0; ir < atom_type.radial_grid().num_points(); ir++) {
+            v.push_back(atom_type.radial_grid(ir));
+        }
+        hash_vec(v);
 
-        auto& atom_type = unit_cell_.atom_type(iat);
+        for (int i = 0; i < atom_type.num_beta_radial_functions(); i++) {
+            h = utils::hash(&atom_type.indexr(i).l, sizeof(int), h);
+            hash_vec(atom_type.beta_radial_function(i).values());
+        }
+        if (atom_type.augment()) {
+            int nbrf = atom_type.mt_radial_basis_size();
+            for (int l = 0; l <= 2 * atom_type.indexr().lmax(); l++) {
+                for (int idxrf2 = 0; idxrf2 < nbrf; idxrf2++) {
+                    for (int idxrf1 = 0; idxrf1 <= idxrf2; idxrf1++) {
+                        hash_vec(atom_type.q_radial_function(idxrf1, idxrf2, l).values());
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < static_cast<int>(atom_type.indexr_wfs().size()); i++) {
+            h = utils::hash(&atom_type.indexr_wfs(i).l, sizeof(int), h);
+            hash_vec(std::get<3>(atom_type.ps_atomic_wf(i)).values());
+        }
+        for (int i = 0; i < static_cast<int>(atom_type.indexr_hub().size()); i++) {
+            h = utils::hash(&atom_type.indexr_hub(i).l, sizeof(int), h);
+            hash_vec(atom_type.hubbard_radial_function(i).values());
+        }
+        hash_vec(atom_type.ps_core_charge_density());
+        hash_vec(atom_type.ps_total_charge_density());
+        hash_vec(atom_type.local_potential());
+    }
+    return h;
+}
 
-        int nwf = (hubbard_) ? atom_type.indexr_hub().size() : atom_type.indexr_wfs().size();
-        if (!nwf) {
-            continue;
+template <int N>
+void Radial_integrals_base<N>::load_or_generate(std::string const& label__, uint64_t extra_hash__,
+                                                std::function<void()> generate__)
+{
+    auto& dir = unit_cell_.parameters().settings().radial_cache_dir_;
+    if (dir.empty()) {
+        generate__();
+        pack_coefs();
+        return;
+    }
+
+    PROFILE("sirius::Radial_integrals|cache");
+
+    auto& comm = unit_cell_.comm();
+
+    /* key of the table */
+    std::stringstream s;
+    s << label__ << " " << major_version() << "." << minor_version() << "." << revision() << " " << git_hash() << " "
+      << nq();
+    auto key = s.str();
+    uint64_t h = utils::hash(key.data(), key.size());
+    h = utils::hash(&qmax_, sizeof(double), h);
+    h = utils::hash(&extra_hash__, sizeof(uint64_t), h);
+    for (int i = 0; i < N; i++) {
+        int d = static_cast<int>(values_.size(i));
+        h     = utils::hash(&d, sizeof(int), h);
+    }
+    h = species_hash(unit_cell_, h);
+
+    char hstr[20];
+    std::snprintf(hstr, sizeof(hstr), "%016llx", static_cast<unsigned long long>(h));
+    std::string fname = dir + "/ri_" + label__ + "_" + hstr + ".h5";
+
+    int nsp = static_cast<int>(values_.size());
+
+    /* flags of the initialized splines and the values of splines on the q-grid */
+    std::vector<int> flg(nsp, 0);
+    mdarray<double, 2> val;
+
+    /* only rank 0 reads the table; a failed read (corrupted or partially written file) must not leave the other
+       ranks waiting in the broadcast, so the table is then generated collectively */
+    int found{0};
+    if (comm.rank() == 0 && utils::file_exists(fname)) {
+        try {
+            HDF5_tree fin(fname, hdf5_access_t::read_only);
+            std::vector<int> dims(2);
+            fin.read("dims", dims);
+            if (dims[0] == nq() && dims[1] == nsp) {
+                fin.read("flags", flg);
+                val = mdarray<double, 2>(nq(), nsp);
+                fin.read("values", val);
+                found = 1;
+            }
+        } catch (std::exception const& e) {
+            std::stringstream msg;
+            msg << "failed to read radial integrals from " << fname << "; the table is generated" << std::endl
+                << e.what();
+            WARNING(msg);
+            found = 0;
+            std::fill(flg.begin(), flg.end(), 0);
         }
+    }
+    comm.bcast(&found, 1, 0);
 
-        /* create jl(qx) */
+    if (found) {
+        comm.bcast(flg.data(), nsp, 0);
+        if (comm.rank() != 0) {
+            val = mdarray<double, 2>(nq(), nsp);
+        }
+        comm.bcast(val.at(memory_t::host), nq() * nsp, 0);
         #pragma omp parallel for
-        for (int iq = 0; iq < nq(); iq++) {
-            jl(iq) = Spherical_Bessel_functions(atom_type.lmax_ps_atomic_wf(), atom_type.radial_grid(), grid_q_[iq]);
+        for (int i = 0; i < nsp; i++) {
+            if (flg[i]) {
+                values_[i] = Spline<double>(grid_q_);
+                for (int iq = 0; iq < nq(); iq++) {
+                    values_[i](iq) = val(iq, i);
+                }
+                values_[i].interpolate();
+            }
         }
+        pack_coefs();
+        return;
+    }
 
-        /* loop over all pseudo wave-functions */
-        for (int i = 0; i < nwf; i++) {
-            values_(i, iat) = Spline<double>(grid_q_);
+    generate__();
+    pack_coefs();
+
+    /* the table is not stored if the cache directory is not writable */
+    if (comm.rank() == 0 && access(dir.c_str(), W_OK) == 0) {
+        val = mdarray<double, 2>(nq(), nsp);
+        val.zero();
+        for (int i = 0; i < nsp; i++) {
+            if (values_[i].num_points() == nq()) {
+                flg[i] = 1;
+                for (int iq = 0; iq < nq(); iq++) {
+                    val(iq, i) = values_[i](iq);
+                }
+            }
+        }
+        /* write to a temporary file first; concurrent jobs may store the same table */
+        std::string tmp = fname + "." + std::to_string(getpid()) + ".tmp";
+        try {
+            {
+                HDF5_tree fout(tmp, hdf5_access_t::truncate);
+                fout.write("dims", std::vector<int>({nq(), nsp}));
+                fout.write("flags", flg);
+                fout.write("values", val);
+            }
+            if (std::rename(tmp.c_str(), fname.c_str())) {
+                std::remove(tmp.c_str());
+            }
+        } catch (std::exception const& e) {
+            /* the cache is optional; the generated table is already in use */
+            std::stringstream msg;
+            msg << "failed to store radial integrals in " << fname << std::endl << e.what();
+            WARNING(msg);
+            std::remove(tmp.c_str());
+        }
+    }
+}
+
+template <int N>
+void Radial_integrals_base<N>::pack_coefs()
+{
+    int nsp = static_cast<int>(values_.size());
+    if (!nsp) {
+        return;
+    }
+
+    coefs_ = sddk::mdarray<double, 3>(nsp, 4, nq());
+    coefs_.zero();
+    #pragma omp parallel for
+    for (int iq = 0; iq < nq(); iq++) {
+        for (int k = 0; k < 4; k++) {
+            for (int i = 0; i < nsp; i++) {
+                if (values_[i].num_points() == nq()) {
+                    coefs_(i, k, iq) = values_[i].coeffs()(iq, k);
+                }
+            }
+        }
+    }
+}
 
-            int l = (hubbard_) ? atom_type.indexr_hub(i).l : atom_type.indexr_wfs(i).l;
-            auto& rwf = (hubbard_) ? atom_type.hubbard_radial_function(i) : std::get<3>(atom_type.ps_atomic_wf(i));
+/// Compute integrals of radial functions with spherical Bessel functions.
+/** Integrals \f$ \int f_i(r) j_{\ell_i}(qr) r^m dr \f$ (or the same integrals with
+    \f$ \partial j_{\ell}(qr) / \partial q \f$) are computed for the local set of q-points as a product of the
+    \f$ (N_r \times N_q) \f$ table of Bessel functions and the \f$ (N_r \times N_f) \f$ matrix of spline
+    inner-product weights of the radial functions (see Spline::inner_weights()). The result is identical to the
+    explicit inner products of splines. The values are then gathered from all ranks and the splines in q are
+    interpolated. */
+template <bool jl_deriv>
+static void integrate_jl(Unit_cell const& unit_cell__, Radial_grid<double> const& rgrid__,
+                         Radial_grid<double> const& grid_q__, splindex<splindex_t::block> const& spl_q__,
+                         std::vector<int> const& l__, std::vector<Spline<double> const*> const& f__, int m__,
+                         int num_points__, std::vector<Spline<double>*> const& result__)
+{
+    int nf = static_cast<int>(f__.size());
+    if (!nf) {
+        return;
+    }
+    int nr   = rgrid__.num_points();
+    int nq   = spl_q__.local_size();
+    int lmax = *std::max_element(l__.begin(), l__.end());
+
+    /* group radial functions by l */
+    std::vector<std::vector<int>> idx(lmax + 1);
+    std::vector<int> col(nf);
+    for (int i = 0; i < nf; i++) {
+        col[i] = static_cast<int>(idx[l__[i]].size());
+        idx[l__[i]].push_back(i);
+    }
 
-            #pragma omp parallel for
-            for (int iq = 0; iq < nq(); iq++) {
+    /* weights of inner products */
+    std::vector<mdarray<double, 2>> w(lmax + 1);
+    for (int l = 0; l <= lmax; l++) {
+        if (idx[l].size()) {
+            w[l] = mdarray<double, 2>(nr, idx[l].size());
+        }
+    }
+    #pragma omp parallel for
+    for (int i = 0; i < nf; i++) {
+        auto wi = f__[i]->inner_weights(m__, num_points__);
+        std::copy(wi.begin(), wi.end(), &w[l__[i]](0, col[i]));
+    }
+
+    /* Bessel functions or their derivatives for the local q-points */
+    std::vector<mdarray<double, 2>> jl(lmax + 1);
+    for (int l = 0; l <= lmax; l++) {
+        if (idx[l].size()) {
+            jl[l] = mdarray<double, 2>(nr, nq);
+        }
+    }
+    #pragma omp parallel for
+    for (int iq_loc = 0; iq_loc < nq; iq_loc++) {
+        double q = grid_q__[spl_q__[iq_loc]];
+        Spherical_Bessel_functions sbf(lmax + 1, rgrid__, q);
+        for (int l = 0; l <= lmax; l++) {
+            if (!idx[l].size()) {
+                continue;
+            }
+            for (int ir = 0; ir < nr; ir++) {
                 if (jl_deriv) {
-                    auto s              = jl(iq).deriv_q(l);
-                    values_(i, iat)(iq) = sirius::inner(s, rwf, 1);
+                    /* d j_l(qr) / dq = (l / q) j_l(qr) - r j_{l+1}(qr) */
+                    if (q != 0) {
+                        jl[l](ir, iq_loc) = (l / q) * sbf[l](ir) - rgrid__[ir] * sbf[l + 1](ir);
+                    } else {
+                        jl[l](ir, iq_loc) = (l == 1) ? rgrid__[ir] / 3 : 0;
+                    }
                 } else {
-                    values_(i, iat)(iq) = sirius::inner(jl(iq)[l], rwf, 1);
+                    jl[l](ir, iq_loc) = sbf[l](ir);
                 }
             }
+        }
+    }
+
+    /* integrals for the local q-points */
+    for (int l = 0; l <= lmax; l++) {
+        int n = static_cast<int>(idx[l].size());
+        if (!n || !nq) {
+            continue;
+        }
+        mdarray<double, 2> res(nq, n);
+        linalg(linalg_t::blas).gemm('T', 'N', nq, n, nr, &linalg_const<double>::one(), jl[l].at(memory_t::host),
+                                    jl[l].ld(), w[l].at(memory_t::host), w[l].ld(), &linalg_const<double>::zero(),
+                                    res.at(memory_t::host), res.ld());
+        for (int j = 0; j < n; j++) {
+            for (int iq_loc = 0; iq_loc < nq; iq_loc++) {
+                (*result__[idx[l][j]])(spl_q__[iq_loc]) = res(iq_loc, j);
+            }
+        }
+    }
+
+    for (int i = 0; i < nf; i++) {
+        unit_cell__.comm().allgather(&(*result__[i])(0), spl_q__.global_offset(), spl_q__.local_size());
+    }
+    #pragma omp parallel for
+    for (int i = 0; i < nf; i++) {
+        result__[i]->interpolate();
+    }
+}
+
+/// Weights of the spline integral over the given radial grid.
+static std::vector<double> integral_weights(Radial_grid<double> const& rgrid__, int m__)
+{
+    Spline<double> one(rgrid__, [](double) { return 1.0; });
+    return one.inner_weights(m__, rgrid__.num_points());
+}
+
+template <bool jl_deriv>
+void Radial_integrals_atomic_wf<jl_deriv>::generate()
+{
+    PROFILE("sirius::Radial_integrals|atomic_wfs");
+
+    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+
+        auto& atom_type = unit_cell_.atom_type(iat);
+
+        int nwf = (hubbard_) ? atom_type.indexr_hub().size() : atom_type.indexr_wfs().size();
+
+        std::vector<int> l(nwf);
+        std::vector<Spline<double> const*> f(nwf);
+        std::vector<Spline<double>*> result(nwf);
+
+        /* loop over all pseudo wave-functions */
+        for (int i = 0; i < nwf; i++) {
+            values_(i, iat) = Spline<double>(grid_q_);
 
-            values_(i, iat).interpolate();
+            l[i]      = (hubbard_) ? atom_type.indexr_hub(i).l : atom_type.indexr_wfs(i).l;
+            f[i]      = (hubbard_) ? &atom_type.hubbard_radial_function(i) : &std::get<3>(atom_type.ps_atomic_wf(i));
+            result[i] = &values_(i, iat);
         }
+
+        integrate_jl<jl_deriv>(unit_cell_, atom_type.radial_grid(), grid_q_, spl_q_, l, f, 1,
+                               atom_type.radial_grid().num_points(), result);
     }
 }
 
@@ -72,46 +356,29 @@ void Radial_integrals_aug<jl_deriv>::generate()
             }
         }
 
-        #pragma omp parallel for
-        for (int iq_loc = 0; iq_loc < spl_q_.local_size(); iq_loc++) {
-            int iq = spl_q_[iq_loc];
+        std::vector<int> l;
+        std::vector<Spline<double> const*> f;
+        std::vector<Spline<double>*> result;
 
-            Spherical_Bessel_functions jl(2 * lmax_beta, atom_type.radial_grid(), grid_q_[iq]);
+        for (int l3 = 0; l3 <= 2 * lmax_beta; l3++) {
+            for (int idxrf2 = 0; idxrf2 < nbrf; idxrf2++) {
+                int l2 = atom_type.indexr(idxrf2).l;
+                for (int idxrf1 = 0; idxrf1 <= idxrf2; idxrf1++) {
+                    int l1 = atom_type.indexr(idxrf1).l;
 
-            for (int l3 = 0; l3 <= 2 * lmax_beta; l3++) {
-                for (int idxrf2 = 0; idxrf2 < nbrf; idxrf2++) {
-                    int l2 = atom_type.indexr(idxrf2).l;
-                    for (int idxrf1 = 0; idxrf1 <= idxrf2; idxrf1++) {
-                        int l1 = atom_type.indexr(idxrf1).l;
-
-                        int idx = idxrf2 * (idxrf2 + 1) / 2 + idxrf1;
-
-                        if (l3 >= std::abs(l1 - l2) && l3 <= (l1 + l2) && (l1 + l2 + l3) % 2 == 0) {
-                            if (jl_deriv) {
-                                auto s = jl.deriv_q(l3);
-                                values_(idx, l3, iat)(iq) =
-                                    sirius::inner(s, atom_type.q_radial_function(idxrf1, idxrf2, l3), 0);
-                            } else {
-                                values_(idx, l3, iat)(iq) =
-                                    sirius::inner(jl[l3], atom_type.q_radial_function(idxrf1, idxrf2, l3), 0);
-                            }
-                        }
+                    int idx = idxrf2 * (idxrf2 + 1) / 2 + idxrf1;
+
+                    if (l3 >= std::abs(l1 - l2) && l3 <= (l1 + l2) && (l1 + l2 + l3) % 2 == 0) {
+                        l.push_back(l3);
+                        f.push_back(&atom_type.q_radial_function(idxrf1, idxrf2, l3));
+                        result.push_back(&values_(idx, l3, iat));
                     }
                 }
             }
         }
-        for (int l = 0; l <= 2 * lmax_beta; l++) {
-            for (int idx = 0; idx < nbrf * (nbrf + 1) / 2; idx++) {
-                unit_cell_.comm().allgather(&values_(idx, l, iat)(0), spl_q_.global_offset(), spl_q_.local_size());
-            }
-        }
 
-        #pragma omp parallel for
-        for (int l = 0; l <= 2 * lmax_beta; l++) {
-            for (int idx = 0; idx < nbrf * (nbrf + 1) / 2; idx++) {
-                values_(idx, l, iat).interpolate();
-            }
-        }
+        integrate_jl<jl_deriv>(unit_cell_, atom_type.radial_grid(), grid_q_, spl_q_, l, f, 0,
+                               atom_type.radial_grid().num_points(), result);
     }
 }
 
@@ -129,16 +396,11 @@ void Radial_integrals_rho_pseudo::generate()
         values_(iat) = Spline<double>(grid_q_);
 
         Spline<double> rho(atom_type.radial_grid(), atom_type.ps_total_charge_density());
+        /* integrals are divided by 4 Pi */
+        rho.scale(1.0 / fourpi);
 
-        #pragma omp parallel for
-        for (int iq_loc = 0; iq_loc < spl_q_.local_size(); iq_loc++) {
-            int iq = spl_q_[iq_loc];
-            Spherical_Bessel_functions jl(0, atom_type.radial_grid(), grid_q_[iq]);
-
-            values_(iat)(iq) = sirius::inner(jl[0], rho, 0, atom_type.num_mt_points()) / fourpi;
-        }
-        unit_cell_.comm().allgather(&values_(iat)(0), spl_q_.global_offset(), spl_q_.local_size());
-        values_(iat).interpolate();
+        integrate_jl<false>(unit_cell_, atom_type.radial_grid(), grid_q_, spl_q_, {0}, {&rho}, 0,
+                            atom_type.num_mt_points(), {&values_(iat)});
     }
 }
 
@@ -158,20 +420,8 @@ void Radial_integrals_rho_core_pseudo<jl_deriv>::generate()
 
         Spline<double> ps_core(atom_type.radial_grid(), atom_type.ps_core_charge_density());
 
-        #pragma omp parallel for
-        for (int iq_loc = 0; iq_loc < spl_q_.local_size(); iq_loc++) {
-            int iq = spl_q_[iq_loc];
-            Spherical_Bessel_functions jl(0, atom_type.radial_grid(), grid_q_[iq]);
-
-            if (jl_deriv) {
-                auto s           = jl.deriv_q(0);
-                values_(iat)(iq) = sirius::inner(s, ps_core, 2, atom_type.num_mt_points());
-            } else {
-                values_(iat)(iq) = sirius::inner(jl[0], ps_core, 2, atom_type.num_mt_points());
-            }
-        }
-        unit_cell_.comm().allgather(&values_(iat)(0), spl_q_.global_offset(), spl_q_.local_size());
-        values_(iat).interpolate();
+        integrate_jl<jl_deriv>(unit_cell_, atom_type.radial_grid(), grid_q_, spl_q_, {0}, {&ps_core}, 2,
+                               atom_type.num_mt_points(), {&values_(iat)});
     }
 }
 
@@ -184,35 +434,22 @@ void Radial_integrals_beta<jl_deriv>::generate()
         auto& atom_type = unit_cell_.atom_type(iat);
         int nrb = atom_type.num_beta_radial_functions();
 
-        if (!nrb) {
-            continue;
-        }
+        std::vector<int> l(nrb);
+        std::vector<Spline<double> const*> f(nrb);
+        std::vector<Spline<double>*> result(nrb);
 
+        /* compute \int j_l(q * r) beta_l(r) r^2 dr or \int d (j_l(q*r) / dq) beta_l(r) r^2  */
+        /* remeber that beta(r) are defined as miltiplied by r */
         for (int idxrf = 0; idxrf < nrb; idxrf++) {
             values_(idxrf, iat) = Spline<double>(grid_q_);
-        }
 
-        #pragma omp parallel for
-        for (int iq_loc = 0; iq_loc < spl_q_.local_size(); iq_loc++) {
-            int iq = spl_q_[iq_loc];
-            Spherical_Bessel_functions jl(unit_cell_.lmax(), atom_type.radial_grid(), grid_q_[iq]);
-            for (int idxrf = 0; idxrf < nrb; idxrf++) {
-                int l  = atom_type.indexr(idxrf).l;
-                /* compute \int j_l(q * r) beta_l(r) r^2 dr or \int d (j_l(q*r) / dq) beta_l(r) r^2  */
-                /* remeber that beta(r) are defined as miltiplied by r */
-                if (jl_deriv) {
-                    auto s  = jl.deriv_q(l);
-                    values_(idxrf, iat)(iq) = sirius::inner(s, atom_type.beta_radial_function(idxrf), 1);
-                } else {
-                    values_(idxrf, iat)(iq) = sirius::inner(jl[l], atom_type.beta_radial_function(idxrf), 1);
-                }
-            }
+            l[idxrf]      = atom_type.indexr(idxrf).l;
+            f[idxrf]      = &atom_type.beta_radial_function(idxrf);
+            result[idxrf] = &values_(idxrf, iat);
         }
 
-        for (int idxrf = 0; idxrf < nrb; idxrf++) {
-            unit_cell_.comm().allgather(&values_(idxrf, iat)(0), spl_q_.global_offset(), spl_q_.local_size());
-            values_(idxrf, iat).interpolate();
-        }
+        integrate_jl<jl_deriv>(unit_cell_, atom_type.radial_grid(), grid_q_, spl_q_, l, f, 1,
+                               atom_type.radial_grid().num_points(), result);
     }
 }
 
@@ -224,35 +461,24 @@ void Radial_integrals_beta_jl::generate()
         auto& atom_type = unit_cell_.atom_type(iat);
         int nrb         = atom_type.num_beta_radial_functions();
 
-        if (!nrb) {
-            continue;
-        }
+        std::vector<int> l;
+        std::vector<Spline<double> const*> f;
+        std::vector<Spline<double>*> result;
 
+        /* compute \int j_{l'}(q * r) beta_l(r) r^2 * r * dr */
+        /* remeber that beta(r) are defined as miltiplied by r */
         for (int idxrf = 0; idxrf < nrb; idxrf++) {
-            for (int l = 0; l <= lmax_; l++) {
-                values_(idxrf, l, iat) = Spline<double>(grid_q_);
-            }
-        }
+            for (int l1 = 0; l1 <= lmax_; l1++) {
+                values_(idxrf, l1, iat) = Spline<double>(grid_q_);
 
-        #pragma omp parallel for
-        for (int iq = 0; iq < grid_q_.num_points(); iq++) {
-            Spherical_Bessel_functions jl(lmax_, atom_type.radial_grid(), grid_q_[iq]);
-            for (int idxrf = 0; idxrf < nrb; idxrf++) {
-                // int nr = atom_type.pp_desc().num_beta_radial_points[idxrf];
-                for (int l = 0; l <= lmax_; l++) {
-                    /* compute \int j_{l'}(q * r) beta_l(r) r^2 * r * dr */
-                    /* remeber that beta(r) are defined as miltiplied by r */
-                    values_(idxrf, l, iat)(iq) = sirius::inner(jl[l], atom_type.beta_radial_function(idxrf), 2);
-                }
+                l.push_back(l1);
+                f.push_back(&atom_type.beta_radial_function(idxrf));
+                result.push_back(&values_(idxrf, l1, iat));
             }
         }
 
-        #pragma omp parallel for
-        for (int idxrf = 0; idxrf < nrb; idxrf++) {
-            for (int l = 0; l <= lmax_; l++) {
-                values_(idxrf, l, iat).interpolate();
-            }
-        }
+        integrate_jl<false>(unit_cell_, atom_type.radial_grid(), grid_q_, spl_q_, l, f, 2,
+                            atom_type.radial_grid().num_points(), result);
     }
 }
 
@@ -287,39 +513,45 @@ void Radial_integrals_vloc<jl_deriv>::generate()
 
         auto rg = atom_type.radial_grid().segment(np);
 
+        /* weights of the spline integral and the q-independent part of the integrand */
+        auto w = integral_weights(rg, 0);
+        std::vector<double> v(rg.num_points());
+        for (int ir = 0; ir < rg.num_points(); ir++) {
+            double x = rg[ir];
+            v[ir]    = w[ir] * (x * vloc[ir] + atom_type.zn() * std::erf(x));
+        }
+
         #pragma omp parallel for
         for (int iq_loc = 0; iq_loc < spl_q_.local_size(); iq_loc++) {
-            int iq = spl_q_[iq_loc];
-            Spline<double> s(rg);
+            int iq   = spl_q_[iq_loc];
             double g = grid_q_[iq];
+            double val{0};
 
             if (jl_deriv) { /* integral with derivative of j0(q*r) over q */
                 for (int ir = 0; ir < rg.num_points(); ir++) {
                     double x = rg[ir];
-                    s(ir) = (x * vloc[ir] + atom_type.zn() * std::erf(x)) * (std::sin(g * x) - g * x * std::cos(g * x));
+                    val += v[ir] * (std::sin(g * x) - g * x * std::cos(g * x));
                 }
             } else {           /* integral with j0(q*r) */
                 if (iq == 0) { /* q=0 case */
                     if (unit_cell_.parameters().parameters_input().enable_esm_ &&
                         unit_cell_.parameters().parameters_input().esm_bc_ != "pbc") {
                         for (int ir = 0; ir < rg.num_points(); ir++) {
-                            double x = rg[ir];
-                            s(ir)    = (x * vloc[ir] + atom_type.zn() * std::erf(x)) * x;
+                            val += v[ir] * rg[ir];
                         }
                     } else {
                         for (int ir = 0; ir < rg.num_points(); ir++) {
                             double x = rg[ir];
-                            s(ir)    = (x * vloc[ir] + atom_type.zn()) * x;
+                            val += w[ir] * (x * vloc[ir] + atom_type.zn()) * x;
                         }
                     }
                 } else {
                     for (int ir = 0; ir < rg.num_points(); ir++) {
-                        double x = rg[ir];
-                        s(ir)    = (x * vloc[ir] + atom_type.zn() * std::erf(x)) * std::sin(g * x);
+                        val += v[ir] * std::sin(g * rg[ir]);
                     }
                 }
             }
-            values_(iat)(iq) = s.interpolate().integrate(0);
+            values_(iat)(iq) = val;
         }
         unit_cell_.comm().allgather(&values_(iat)(0), spl_q_.global_offset(), spl_q_.local_size());
         values_(iat).interpolate();
@@ -334,26 +566,36 @@ void Radial_integrals_rho_free_atom::generate()
         auto& atom_type = unit_cell_.atom_type(iat);
         values_(iat)    = Spline<double>(grid_q_);
 
+        auto& rg = atom_type.free_atom_radial_grid();
+        /* weights of the spline integrals with r^2 (q = 0) and r prefactors */
+        auto w2 = integral_weights(rg, 2);
+        auto w1 = integral_weights(rg, 1);
+
         #pragma omp parallel for
-        for (int iq = 0; iq < grid_q_.num_points(); iq++) {
+        for (int iq_loc = 0; iq_loc < spl_q_.local_size(); iq_loc++) {
+            int iq   = spl_q_[iq_loc];
             double g = grid_q_[iq];
-            Spline<double> s(unit_cell_.atom_type(iat).free_atom_radial_grid());
+            double val{0};
             if (iq == 0) {
-                for (int ir = 0; ir < s.num_points(); ir++) {
-                    s(ir) = atom_type.free_atom_density(ir);
+                for (int ir = 0; ir < rg.num_points(); ir++) {
+                    val += w2[ir] * atom_type.free_atom_density(ir);
                 }
-                values_(iat)(iq) = s.interpolate().integrate(2);
             } else {
-                for (int ir = 0; ir < s.num_points(); ir++) {
-                    s(ir) = atom_type.free_atom_density(ir) * std::sin(g * atom_type.free_atom_radial_grid(ir));
+                for (int ir = 0; ir < rg.num_points(); ir++) {
+                    val += w1[ir] * atom_type.free_atom_density(ir) * std::sin(g * rg[ir]);
                 }
-                values_(iat)(iq) = s.interpolate().integrate(1);
             }
+            values_(iat)(iq) = val;
         }
+        unit_cell_.comm().allgather(&values_(iat)(0), spl_q_.global_offset(), spl_q_.local_size());
         values_(iat).interpolate();
     }
 }
 
+template class Radial_integrals_base<1>;
+template class Radial_integrals_base<2>;
+template class Radial_integrals_base<3>;
+
 template class Radial_integrals_atomic_wf<true>;
 template class Radial_integrals_atomic_wf<false>;
 
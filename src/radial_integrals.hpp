@@ -25,6 +25,7 @@
 #ifndef __RADIAL_INTEGRALS_HPP__
 #define __RADIAL_INTEGRALS_HPP__
 
+#include <functional>
 #include "Unit_cell/unit_cell.hpp"
 #include "sbessel.hpp"
 
@@ -49,6 +50,60 @@ class Radial_integrals_base
 
     double qmax_{0};
 
+    /// Cubic coefficients of all splines interleaved by the q-interval.
+    /** coefs_(i, k, iq) is the k-th coefficient of the i-th spline of values_ (in the order of storage) on the
+        interval \f$ [q_{iq}, q_{iq+1}) \f$. All coefficients required to evaluate a block of splines at a given
+        q-point are stored contiguously, which is not the case for the column-major coefficients of Spline. */
+    sddk::mdarray<double, 3> coefs_;
+
+    /// Fill the interleaved table of spline coefficients.
+    void pack_coefs();
+
+    /// Linear index of the spline in values_.
+    template <typename... Args>
+    inline int offset(Args... args) const
+    {
+        return static_cast<int>(&values_(args...) - &values_[0]);
+    }
+
+    /// Value of the i-th spline for the given iq and dq.
+    inline double value_packed(int i__, std::pair<int, double> idx__) const
+    {
+        int iq    = idx__.first;
+        double dq = idx__.second;
+        return coefs_(i__, 0, iq) + dq * (coefs_(i__, 1, iq) + dq * (coefs_(i__, 2, iq) + dq * coefs_(i__, 3, iq)));
+    }
+
+    /// Evaluate a block of consecutive splines for a set of q-points.
+    /** The block consists of n splines of values_ starting from the given linear index. On output
+        result[i + ld * j] contains the value of the spline (offset + i) for the q-point q[j]. */
+    inline void eval_block(int offset__, int n__, int nq__, double const* q__, double* result__, int ld__) const
+    {
+        if (!n__) {
+            return;
+        }
+        #pragma omp parallel for schedule(static) if (nq__ > 64)
+        for (int j = 0; j < nq__; j++) {
+            auto idx         = iqdq(q__[j]);
+            double dq        = idx.second;
+            double const* c0 = &coefs_(offset__, 0, idx.first);
+            double const* c1 = &coefs_(offset__, 1, idx.first);
+            double const* c2 = &coefs_(offset__, 2, idx.first);
+            double const* c3 = &coefs_(offset__, 3, idx.first);
+            double* r        = result__ + static_cast<size_t>(ld__) * j;
+            #pragma omp simd
+            for (int i = 0; i < n__; i++) {
+                r[i] = c0[i] + dq * (c1[i] + dq * (c2[i] + dq * c3[i]));
+            }
+        }
+    }
+
+    /// Load radial integrals from the on-disk cache or generate and store them.
+    /** The cache is used if settings().radial_cache_dir_ is set. The name of the file contains a hash of the label
+        of radial integrals, the q-grid, the data of all atom types, the extra hash provided by the caller and the
+        version of the code. The file is read by the root rank and the values are broadcast to other ranks. */
+    void load_or_generate(std::string const& label__, uint64_t extra_hash__, std::function<void()> generate__);
+
   public:
     /// Constructor.
     Radial_integrals_base(Unit_cell const& unit_cell__, double const qmax__, int const np__)
@@ -87,8 +142,7 @@ class Radial_integrals_base
     template <typename... Args>
     inline double value(Args... args, double q__) const
     {
-        auto idx = iqdq(q__);
-        return values_(args...)(idx.first, idx.second);
+        return value_packed(offset(args...), iqdq(q__));
     }
 
     inline int nq() const
@@ -130,7 +184,8 @@ class Radial_integrals_atomic_wf : public Radial_integrals_base<2>
 
         values_ = sddk::mdarray<Spline<double>, 2>(nrf_max_, unit_cell_.num_atom_types());
 
-        generate();
+        std::string label = std::string("atomic_wf") + (jl_deriv ? "_djl" : "") + (hubbard_ ? "_hub" : "");
+        load_or_generate(label, 0, [this]() { generate(); });
     }
 
     /// retrieve a given orbital from an atom type
@@ -142,13 +197,27 @@ class Radial_integrals_atomic_wf : public Radial_integrals_base<2>
     /// Get all values for a given atom type and q-point.
     inline sddk::mdarray<double, 1> values(int iat__, double q__) const
     {
-        auto idx        = iqdq(q__);
         auto& atom_type = unit_cell_.atom_type(iat__);
         int nrf         = (hubbard_) ? atom_type.indexr_hub().size() : atom_type.indexr_wfs().size();
 
         sddk::mdarray<double, 1> val(nrf);
-        for (int i = 0; i < nrf; i++) {
-            val(i) = values_(i, iat__)(idx.first, idx.second);
+        if (nrf) {
+            eval_block(offset(0, iat__), nrf, 1, &q__, val.at(memory_t::host), nrf);
+        }
+        return val;
+    }
+
+    /// Get all values for a given atom type and a set of q-points.
+    /** On output val(i, j) contains the i-th radial integral for the q-point q[j]. */
+    inline sddk::mdarray<double, 2> values(int iat__, std::vector<double> const& q__) const
+    {
+        auto& atom_type = unit_cell_.atom_type(iat__);
+        int nrf         = (hubbard_) ? atom_type.indexr_hub().size() : atom_type.indexr_wfs().size();
+        int nq          = static_cast<int>(q__.size());
+
+        sddk::mdarray<double, 2> val(nrf, nq);
+        if (nrf && nq) {
+            eval_block(offset(0, iat__), nrf, nq, q__.data(), val.at(memory_t::host), nrf);
         }
         return val;
     }
@@ -170,25 +239,43 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
 
         values_ = sddk::mdarray<Spline<double>, 3>(nmax * (nmax + 1) / 2, 2 * lmax + 1, unit_cell_.num_atom_types());
 
-        generate();
+        load_or_generate(jl_deriv ? "aug_djl" : "aug", 0, [this]() { generate(); });
     }
 
     inline sddk::mdarray<double, 2> values(int iat__, double q__) const
     {
-        auto idx = iqdq(q__);
-
         auto& atom_type = unit_cell_.atom_type(iat__);
         int lmax        = atom_type.indexr().lmax();
         int nbrf        = atom_type.mt_radial_basis_size();
+        int n           = nbrf * (nbrf + 1) / 2;
 
-        sddk::mdarray<double, 2> val(nbrf * (nbrf + 1) / 2, 2 * lmax + 1);
+        sddk::mdarray<double, 2> val(n, 2 * lmax + 1);
+        if (!n) {
+            return val;
+        }
         for (int l = 0; l <= 2 * lmax; l++) {
-            for (int i = 0; i < nbrf * (nbrf + 1) / 2; i++) {
-                val(i, l) = values_(i, l, iat__)(idx.first, idx.second);
-            }
+            eval_block(offset(0, l, iat__), n, 1, &q__, &val(0, l), n);
         }
         return val;
     }
+
+    /// Get all values for a given atom type and a set of q-points.
+    /** On output val(i, l, j) contains the radial integral for the q-point q[j]. The first two dimensions of the
+        output array must be at least nbrf * (nbrf + 1) / 2 and 2 * lmax + 1 of the atom type. */
+    inline void values(int iat__, int nq__, double const* q__, sddk::mdarray<double, 3>& val__) const
+    {
+        auto& atom_type = unit_cell_.atom_type(iat__);
+        int lmax        = atom_type.indexr().lmax();
+        int nbrf        = atom_type.mt_radial_basis_size();
+        int ld          = static_cast<int>(val__.size(0) * val__.size(1));
+
+        if (!nbrf || !nq__) {
+            return;
+        }
+        for (int l = 0; l <= 2 * lmax; l++) {
+            eval_block(offset(0, l, iat__), nbrf * (nbrf + 1) / 2, nq__, q__, &val__(0, l, 0), ld);
+        }
+    }
 };
 
 
@@ -202,7 +289,7 @@ class Radial_integrals_rho_pseudo : public Radial_integrals_base<1>
         : Radial_integrals_base<1>(unit_cell__, qmax__, np__)
     {
         values_ = mdarray<Spline<double>, 1>(unit_cell_.num_atom_types());
-        generate();
+        load_or_generate("rho_pseudo", 0, [this]() { generate(); });
 
         if (unit_cell_.parameters().control().print_checksum_ && unit_cell_.comm().rank() == 0) {
             double cs{0};
@@ -228,7 +315,7 @@ class Radial_integrals_rho_core_pseudo : public Radial_integrals_base<1>
         : Radial_integrals_base<1>(unit_cell__, qmax__, np__)
     {
         values_ = mdarray<Spline<double>, 1>(unit_cell_.num_atom_types());
-        generate();
+        load_or_generate(jl_deriv ? "rho_core_pseudo_djl" : "rho_core_pseudo", 0, [this]() { generate(); });
     }
 };
 
@@ -245,17 +332,29 @@ class Radial_integrals_beta : public Radial_integrals_base<2>
     {
         /* create space for <j_l(qr)|beta> or <d j_l(qr) / dq|beta> radial integrals */
         values_ = mdarray<Spline<double>, 2>(unit_cell_.max_mt_radial_basis_size(), unit_cell_.num_atom_types());
-        generate();
+        load_or_generate(jl_deriv ? "beta_djl" : "beta", 0, [this]() { generate(); });
     }
 
     /// Get all values for a given atom type and q-point.
     inline mdarray<double, 1> values(int iat__, double q__) const
     {
-        auto idx        = iqdq(q__);
-        auto& atom_type = unit_cell_.atom_type(iat__);
-        mdarray<double, 1> val(atom_type.mt_radial_basis_size());
-        for (int i = 0; i < atom_type.mt_radial_basis_size(); i++) {
-            val(i) = values_(i, iat__)(idx.first, idx.second);
+        int nrf = unit_cell_.atom_type(iat__).mt_radial_basis_size();
+        mdarray<double, 1> val(nrf);
+        if (nrf) {
+            eval_block(offset(0, iat__), nrf, 1, &q__, val.at(memory_t::host), nrf);
+        }
+        return val;
+    }
+
+    /// Get all values for a given atom type and a set of q-points.
+    /** On output val(i, j) contains the i-th radial integral for the q-point q[j]. */
+    inline mdarray<double, 2> values(int iat__, std::vector<double> const& q__) const
+    {
+        int nrf = unit_cell_.atom_type(iat__).mt_radial_basis_size();
+        int nq  = static_cast<int>(q__.size());
+        mdarray<double, 2> val(nrf, nq);
+        if (nrf && nq) {
+            eval_block(offset(0, iat__), nrf, nq, q__.data(), val.at(memory_t::host), nrf);
         }
         return val;
     }
@@ -277,7 +376,7 @@ class Radial_integrals_beta_jl : public Radial_integrals_base<3>
         /* create space for <j_l(qr)|beta> radial integrals */
         values_ = mdarray<Spline<double>, 3>(unit_cell_.max_mt_radial_basis_size(), lmax_ + 1,
                                              unit_cell_.num_atom_types());
-        generate();
+        load_or_generate("beta_jl", 0, [this]() { generate(); });
     }
 };
 
@@ -288,12 +387,22 @@ class Radial_integrals_vloc : public Radial_integrals_base<1>
   private:
     void generate();
 
+    /// Hash of the boundary conditions of ESM which change the q=0 value of the integral.
+    inline uint64_t esm_hash() const
+    {
+        auto& inp = unit_cell_.parameters().parameters_input();
+        if (!inp.enable_esm_ || inp.esm_bc_ == "pbc") {
+            return 0;
+        }
+        return utils::hash(inp.esm_bc_.data(), inp.esm_bc_.size());
+    }
+
   public:
     Radial_integrals_vloc(Unit_cell const& unit_cell__, double qmax__, int np__)
         : Radial_integrals_base<1>(unit_cell__, qmax__, np__)
     {
         values_ = mdarray<Spline<double>, 1>(unit_cell_.num_atom_types());
-        generate();
+        load_or_generate(jl_deriv ? "vloc_djl" : "vloc", esm_hash(), [this]() { generate(); });
     }
 
     /// Special implementation to recover the true radial integral value.
@@ -313,17 +422,17 @@ class Radial_integrals_vloc : public Radial_integrals_base<1>
             if (jl_deriv) {
                 if (!unit_cell_.parameters().parameters_input().enable_esm_ ||
                     unit_cell_.parameters().parameters_input().esm_bc_ == "pbc") {
-                    return values_(iat__)(idx.first, idx.second) / q2 / q__ -
+                    return value_packed(iat__, idx) / q2 / q__ -
                            atom_type.zn() * std::exp(-q2 / 4) * (4 + q2) / 2 / q2 / q2;
                 } else {
-                    return values_(iat__)(idx.first, idx.second) / q2 / q__;
+                    return value_packed(iat__, idx) / q2 / q__;
                 }
             } else {
                 if (!unit_cell_.parameters().parameters_input().enable_esm_ ||
                     unit_cell_.parameters().parameters_input().esm_bc_ == "pbc") {
-                    return values_(iat__)(idx.first, idx.second) / q__ - atom_type.zn() * std::exp(-q2 / 4) / q2;
+                    return value_packed(iat__, idx) / q__ - atom_type.zn() * std::exp(-q2 / 4) / q2;
                 } else {
-                    return values_(iat__)(idx.first, idx.second) / q__;
+                    return value_packed(iat__, idx) / q__;
                 }
             }
         }
@@ -336,12 +445,26 @@ class Radial_integrals_rho_free_atom : public Radial_integrals_base<1>
   private:
     void generate();
 
+    /// Hash of the free atom densities.
+    inline uint64_t free_atom_hash() const
+    {
+        uint64_t h{5381};
+        for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+            auto& atom_type = unit_cell_.atom_type(iat);
+            for (int ir = 0; ir < atom_type.free_atom_radial_grid().num_points(); ir++) {
+                double v[] = {atom_type.free_atom_radial_grid(ir), atom_type.free_atom_density(ir)};
+                h = utils::hash(v, sizeof(v), h);
+            }
+        }
+        return h;
+    }
+
   public:
     Radial_integrals_rho_free_atom(Unit_cell const& unit_cell__, double qmax__, int np__)
         : Radial_integrals_base<1>(unit_cell__, qmax__, np__)
     {
         values_ = mdarray<Spline<double>, 1>(unit_cell_.num_atom_types());
-        generate();
+        load_or_generate("rho_free_atom", free_atom_hash(), [this]() { generate(); });
     }
 
     /// Special implementation to recover the true radial integral value.
@@ -351,7 +474,7 @@ class Radial_integrals_rho_free_atom : public Radial_integrals_base<1>
         if (std::abs(q__) < 1e-12) {
             return values_(iat__)(0);
         } else {
-            return values_(iat__)(idx.first, idx.second) / q__;
+            return value_packed(iat__, idx) / q__;
         }
     }
 };
@@ -457,6 +457,154 @@ class Radial_solver
         return nn;
     }
 
+    /// Integrate the homogeneous radial equation forward for a batch of trial energies and orbital quantum numbers.
+    /** All channels are integrated in lockstep on the same radial grid and potential, so the innermost loop runs
+     *  over the channels and is vectorized. The arithmetic of each channel is the same as in
+     *  integrate_forward_rk4() with zero inhomogeneous terms and without the overflow prevention. Only the number
+     *  of nodes and the values of \f$ p(R) \f$ and \f$ p'(R) \f$ at the last point of the grid are returned. */
+    template <relativity_t rel>
+    void integrate_forward_rk4_batch(int nb__, double const* enu__, int const* l__, int* nn__, double* p_R__,
+                                     double* dpdr_R__) const
+    {
+        static_assert(rel != relativity_t::dirac, "Dirac equation is not supported by the batched integrator");
+
+        /* number of mesh points */
+        int nr = num_points();
+
+        double sq_alpha_half = (rel == relativity_t::none) ? 0 : 0.5 / std::pow(speed_of_light, 2);
+
+        auto rel_mass = [sq_alpha_half](double enu__, double v__) -> double {
+            switch (rel) {
+                case relativity_t::koelling_harmon: {
+                    return 1.0 + sq_alpha_half * (enu__ - v__);
+                }
+                case relativity_t::zora: {
+                    return 1.0 - sq_alpha_half * v__;
+                }
+                case relativity_t::iora: {
+                    double m0 = 1.0 - sq_alpha_half * v__;
+                    return m0 / (1 - sq_alpha_half * enu__ / m0);
+                }
+                default: {
+                    return 1.0;
+                }
+            }
+        };
+
+        std::vector<double> ll_half(nb__);
+        std::vector<double> p(nb__);
+        std::vector<double> q(nb__);
+
+        /* here and below var0 means var(x), var2 means var(x+h) and var1 means var(x+h/2) */
+        double x2    = radial_grid_[0];
+        double xinv2 = radial_grid_.x_inv(0);
+        double v2    = ve_(0) - zn_ / x2;
+
+        /* r->0 asymptotics */
+        for (int b = 0; b < nb__; b++) {
+            ll_half[b] = l__[b] * (l__[b] + 1) / 2.0;
+            if (l__[b] == 0) {
+                p[b] = 2 * zn_ * x2;
+                q[b] = -std::pow(zn_, 2) * x2;
+            } else {
+                p[b] = std::pow(x2, l__[b] + 1);
+                q[b] = std::pow(x2, l__[b]) * l__[b] / 2;
+            }
+            nn__[b] = 0;
+        }
+
+        for (int i = 0; i < nr - 1; i++) {
+            /* copy previous values */
+            double x0    = x2;
+            double xinv0 = xinv2;
+            double v0    = v2;
+            /* radial grid step */
+            double h = radial_grid_.dx(i);
+            /* mid-point */
+            double h_half = h / 2;
+            double x1     = x0 + h_half;
+            double xinv1  = 1.0 / x1;
+            double v1     = ve_(i, h_half) - zn_ * xinv1;
+            /* next point */
+            x2    = radial_grid_[i + 1];
+            xinv2 = radial_grid_.x_inv(i + 1);
+            v2    = ve_(i + 1) - zn_ * xinv2;
+
+            double x0sq = std::pow(x0, 2);
+            double x1sq = std::pow(x1, 2);
+            double x2sq = std::pow(x2, 2);
+
+            #pragma omp simd
+            for (int b = 0; b < nb__; b++) {
+                double enu = enu__[b];
+                double M0  = rel_mass(enu, v0);
+                double M1  = rel_mass(enu, v1);
+                double M2  = rel_mass(enu, v2);
+                double p0  = p[b];
+                double q0  = q[b];
+
+                /* factors of p in the equation for q' */
+                double f0, f1, f2;
+                if (rel == relativity_t::iora) {
+                    double m0 = 1 - sq_alpha_half * v0;
+                    double m1 = 1 - sq_alpha_half * v1;
+                    double m2 = 1 - sq_alpha_half * v2;
+
+                    double a0 = ll_half[b] / m0 / x0sq;
+                    double a1 = ll_half[b] / m1 / x1sq;
+                    double a2 = ll_half[b] / m2 / x2sq;
+
+                    f0 = v0 - enu + a0 - sq_alpha_half * a0 * enu / m0;
+                    f1 = v1 - enu + a1 - sq_alpha_half * a1 * enu / m1;
+                    f2 = v2 - enu + a2 - sq_alpha_half * a2 * enu / m2;
+                } else {
+                    f0 = v0 - enu + ll_half[b] / M0 / x0sq;
+                    f1 = v1 - enu + ll_half[b] / M1 / x1sq;
+                    f2 = v2 - enu + ll_half[b] / M2 / x2sq;
+                }
+
+                /* k0 = F(Y(x), x) */
+                double pk0 = 2 * M0 * q0 + p0 * xinv0;
+                double qk0 = f0 * p0 - q0 * xinv0;
+
+                /* k1 = F(Y(x) + k0 * h/2, x + h/2) */
+                double pk1 = 2 * M1 * (q0 + qk0 * h_half) + (p0 + pk0 * h_half) * xinv1;
+                double qk1 = f1 * (p0 + pk0 * h_half) - (q0 + qk0 * h_half) * xinv1;
+
+                /* k2 = F(Y(x) + k1 * h/2, x + h/2) */
+                double pk2 = 2 * M1 * (q0 + qk1 * h_half) + (p0 + pk1 * h_half) * xinv1;
+                double qk2 = f1 * (p0 + pk1 * h_half) - (q0 + qk1 * h_half) * xinv1;
+
+                /* k3 = F(Y(x) + k2 * h, x + h) */
+                double pk3 = 2 * M2 * (q0 + qk2 * h) + (p0 + pk2 * h) * xinv2;
+                double qk3 = f2 * (p0 + pk2 * h) - (q0 + qk2 * h) * xinv2;
+
+                /* Y(x + h) = Y(x) + h * (k0 + 2 * k1 + 2 * k2 + k3) / 6 */
+                double p2 = p0 + (pk0 + 2 * (pk1 + pk2) + pk3) * h / 6.0;
+                double q2 = q0 + (qk0 + 2 * (qk1 + qk2) + qk3) * h / 6.0;
+
+                /* rescale the solution; this doesn't change the number of nodes and the logarithmic derivative */
+                if (std::abs(p2) > 1e4) {
+                    p2 /= 1e4;
+                    q2 /= 1e4;
+                    p0 /= 1e4;
+                }
+                if (p0 * p2 < 0.0) {
+                    nn__[b]++;
+                }
+                p[b] = p2;
+                q[b] = q2;
+            }
+        }
+
+        /* P' = 2MQ + \frac{P}{r} at the last point */
+        double V = ve_(nr - 1) - zn_ * radial_grid_.x_inv(nr - 1);
+        for (int b = 0; b < nb__; b++) {
+            p_R__[b]    = p[b];
+            dpdr_R__[b] = 2 * rel_mass(enu__[b], V) * q[b] + p[b] * radial_grid_.x_inv(nr - 1);
+        }
+    }
+
     //== inline double extrapolate_to_zero(int istep, double y, double* x, double* work) const
     //== {
     //==     double dy = y;
@@ -1050,179 +1198,79 @@ class Bound_state : public Radial_solver
 class Enu_finder : public Radial_solver
 {
   private:
-    int n_;
+    /// Principal quantum numbers of the channels.
+    std::vector<int> n_;
 
-    int l_;
+    /// Orbital quantum numbers of the channels.
+    std::vector<int> l_;
 
-    double enu_;
+    std::vector<double> enu_;
 
-    double etop_;
-    double ebot_;
+    std::vector<double> etop_;
+    std::vector<double> ebot_;
 
-    void find_enu(relativity_t rel__, double enu_start__)
+    /// Integrate the radial equation for a batch of channels at their current trial energies.
+    void integrate(relativity_t rel__, std::vector<int> const& l__, std::vector<double> const& enu__,
+                   std::vector<int>& nn__, std::vector<double>& dpdr__) const
     {
-        int np = num_points();
-
-        Spline<double> chi_p(radial_grid());
-        Spline<double> chi_q(radial_grid());
-
-        std::vector<double> p(np);
-        std::vector<double> q(np);
-        std::vector<double> dpdr(np);
-        std::vector<double> dqdr(np);
-
-        double enu = enu_start__;
-        double de  = 0.001;
-        bool found = false;
-        int nndp   = 0;
-
-        /* We want to find enu such that the wave-function at the muffin-tin boundary is zero
-         * and the number of nodes inside muffin-tin is equal to n-l-1. This will be the top
-         * of the band. */
-        for (int i = 0; i < 1000; i++) {
-            int nnd{0};
-
-            switch (rel__) {
-                case relativity_t::none: {
-                    nnd = integrate_forward_rk4<relativity_t::none, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                case relativity_t::koelling_harmon: {
-                    nnd = integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu, l_, 0, chi_p, chi_q, p, dpdr,
-                                                                                      q, dqdr);
-                    break;
-                }
-                case relativity_t::zora: {
-                    nnd = integrate_forward_rk4<relativity_t::zora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                case relativity_t::iora: {
-                    nnd = integrate_forward_rk4<relativity_t::iora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                default: {
-                    throw std::runtime_error("not implemented");
-                }
-            }
-            nnd -= (n_ - l_ - 1);
-
-            enu = (nnd > 0) ? enu - de : enu + de;
-
-            if (i) {
-                de = (nnd != nndp) ? de * 0.5 : de * 1.25;
-            }
-            if (std::abs(de) < 1e-10) {
-                found = true;
+        int nb = static_cast<int>(l__.size());
+        std::vector<double> p(nb);
+        switch (rel__) {
+            case relativity_t::none: {
+                integrate_forward_rk4_batch<relativity_t::none>(nb, enu__.data(), l__.data(), nn__.data(), p.data(),
+                                                                dpdr__.data());
                 break;
             }
-            nndp = nnd;
-        }
-        etop_ = (!found) ? enu_start__ : enu;
-
-        auto surface_deriv = [this, &dpdr, &p]() {
-            if (true) {
-                /* return  p'(R) */
-                return dpdr.back();
-            } else {
-                /* return R*u'(R) */
-                return dpdr.back() - p.back() / radial_grid_.last();
+            case relativity_t::koelling_harmon: {
+                integrate_forward_rk4_batch<relativity_t::koelling_harmon>(nb, enu__.data(), l__.data(), nn__.data(),
+                                                                           p.data(), dpdr__.data());
+                break;
             }
-        };
-
-        double sd = surface_deriv();
-
-        /* Now we go down in energy and serach for enu such that the wave-function derivative is zero
-         * at the muffin-tin boundary. This will be the bottom of the band. */
-        de = 1e-4;
-        for (int i = 0; i < 100; i++) {
-            de *= 1.1;
-            enu -= de;
-            switch (rel__) {
-                case relativity_t::none: {
-                    integrate_forward_rk4<relativity_t::none, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                case relativity_t::koelling_harmon: {
-                    integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q,
-                                                                                dqdr);
-                    break;
-                }
-                case relativity_t::zora: {
-                    integrate_forward_rk4<relativity_t::zora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                case relativity_t::iora: {
-                    integrate_forward_rk4<relativity_t::iora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                default: {
-                    throw std::runtime_error("not implemented");
-                }
+            case relativity_t::zora: {
+                integrate_forward_rk4_batch<relativity_t::zora>(nb, enu__.data(), l__.data(), nn__.data(), p.data(),
+                                                                dpdr__.data());
+                break;
             }
-            if (surface_deriv() * sd <= 0) {
+            case relativity_t::iora: {
+                integrate_forward_rk4_batch<relativity_t::iora>(nb, enu__.data(), l__.data(), nn__.data(), p.data(),
+                                                                dpdr__.data());
                 break;
             }
+            default: {
+                throw std::runtime_error("not implemented");
+            }
         }
+    }
 
-        /* refine bottom energy */
-        double e1 = enu;
-        double e0 = enu + de;
+    /// Write the solution for a given energy to a file.
+    void dump_solution(relativity_t rel__, int l__, double enu__) const
+    {
+        int np = num_points();
 
-        for (int i = 0; i < 100; i++) {
-            enu = (e1 + e0) / 2.0;
-            switch (rel__) {
-                case relativity_t::none: {
-                    integrate_forward_rk4<relativity_t::none, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                case relativity_t::koelling_harmon: {
-                    integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q,
-                                                                                dqdr);
-                    break;
-                }
-                case relativity_t::zora: {
-                    integrate_forward_rk4<relativity_t::zora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                case relativity_t::iora: {
-                    integrate_forward_rk4<relativity_t::iora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                default: {
-                   throw std::runtime_error("not implemented"); 
-                }
-            }
-            /* derivative at the boundary */
-            if (std::abs(surface_deriv()) < 1e-10) {
-                break;
-            }
+        Spline<double> chi_p(radial_grid());
+        Spline<double> chi_q(radial_grid());
 
-            if (surface_deriv() * sd > 0) {
-                e0 = enu;
-            } else {
-                e1 = enu;
-            }
-        }
+        std::vector<double> p(np);
+        std::vector<double> q(np);
+        std::vector<double> dpdr(np);
+        std::vector<double> dqdr(np);
 
-        ebot_ = enu;
-        /* last check */
-        int nn{0};
         switch (rel__) {
             case relativity_t::none: {
-                nn = integrate_forward_rk4<relativity_t::none, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+                integrate_forward_rk4<relativity_t::none, false>(enu__, l__, 0, chi_p, chi_q, p, dpdr, q, dqdr);
                 break;
             }
             case relativity_t::koelling_harmon: {
-                nn = integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q,
-                                                                                 dqdr);
+                integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu__, l__, 0, chi_p, chi_q, p, dpdr, q,
+                                                                            dqdr);
                 break;
             }
             case relativity_t::zora: {
-                nn = integrate_forward_rk4<relativity_t::zora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+                integrate_forward_rk4<relativity_t::zora, false>(enu__, l__, 0, chi_p, chi_q, p, dpdr, q, dqdr);
                 break;
             }
             case relativity_t::iora: {
-                nn = integrate_forward_rk4<relativity_t::iora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+                integrate_forward_rk4<relativity_t::iora, false>(enu__, l__, 0, chi_p, chi_q, p, dpdr, q, dqdr);
                 break;
             }
             default: {
@@ -1230,25 +1278,142 @@ class Enu_finder : public Radial_solver
             }
         }
 
-        if (nn != n_ - l_ - 1) {
-            FILE* fout = fopen("p.dat", "w");
-            for (int ir = 0; ir < np; ir++) {
-                double x = radial_grid(ir);
-                fprintf(fout, "%16.8f %16.8f %16.8f\n", x, p[ir], q[ir]);
-            }
-            fclose(fout);
+        FILE* fout = fopen("p.dat", "w");
+        for (int ir = 0; ir < np; ir++) {
+            double x = radial_grid(ir);
+            fprintf(fout, "%16.8f %16.8f %16.8f\n", x, p[ir], q[ir]);
+        }
+        fclose(fout);
+    }
 
-            // printf("n: %i, l: %i, nn: %i", n_, l_, nn);
-            std::stringstream s;
-            s << "wrong number of nodes: " << nn << " instead of " << n_ - l_ - 1 << std::endl
-              << "n: " << n_ << ", l: " << l_ << std::endl
-              << "etop: " << etop_ << " ebot: " << ebot_ << std::endl
-              << "initial surface derivative: " << sd;
+    /// Search for the top and bottom of the band for all channels.
+    /** Each channel follows its own sequence of trial energies. On every round the channels which are still
+     *  searching are integrated together by a single call to the batched radial integrator. */
+    void find_enu(relativity_t rel__, std::vector<double> const& enu_start__)
+    {
+        int nch = static_cast<int>(n_.size());
+
+        /* stage of the search: 0 - top of the band, 1 - bracketing of the bottom of the band,
+                                2 - refinement of the bottom of the band, 3 - final check, 4 - done */
+        struct state_t
+        {
+            int stage{0};
+            int iter{0};
+            double enu;
+            double de{0.001};
+            int nndp{0};
+            double sd{0};
+            double e0{0};
+            double e1{0};
+        };
+        std::vector<state_t> st(nch);
 
-            throw std::runtime_error(s.str());
+        enu_.resize(nch);
+        etop_.resize(nch);
+        ebot_.resize(nch);
+        for (int j = 0; j < nch; j++) {
+            st[j].enu = enu_start__[j];
         }
 
-        enu_ = (ebot_ + etop_) / 2.0;
+        while (true) {
+            /* channels which are still searching */
+            std::vector<int> idx;
+            std::vector<int> l;
+            std::vector<double> e;
+            for (int j = 0; j < nch; j++) {
+                if (st[j].stage != 4) {
+                    idx.push_back(j);
+                    l.push_back(l_[j]);
+                    e.push_back(st[j].enu);
+                }
+            }
+            if (idx.empty()) {
+                break;
+            }
+            std::vector<int> nn(idx.size());
+            std::vector<double> dpdr(idx.size());
+            integrate(rel__, l, e, nn, dpdr);
+
+            for (size_t k = 0; k < idx.size(); k++) {
+                auto& s = st[idx[k]];
+                int j   = idx[k];
+                switch (s.stage) {
+                    /* We want to find enu such that the wave-function at the muffin-tin boundary is zero
+                     * and the number of nodes inside muffin-tin is equal to n-l-1. This will be the top
+                     * of the band. */
+                    case 0: {
+                        int nnd = nn[k] - (n_[j] - l_[j] - 1);
+                        s.enu   = (nnd > 0) ? s.enu - s.de : s.enu + s.de;
+                        if (s.iter) {
+                            s.de = (nnd != s.nndp) ? s.de * 0.5 : s.de * 1.25;
+                        }
+                        /* surface derivative p'(R) */
+                        s.sd      = dpdr[k];
+                        bool done = std::abs(s.de) < 1e-10;
+                        s.nndp    = nnd;
+                        if (done || ++s.iter == 1000) {
+                            etop_[j] = (!done) ? enu_start__[j] : s.enu;
+                            /* Now we go down in energy and serach for enu such that the wave-function derivative
+                             * is zero at the muffin-tin boundary. This will be the bottom of the band. */
+                            s.de = 1e-4;
+                            s.de *= 1.1;
+                            s.enu -= s.de;
+                            s.iter  = 0;
+                            s.stage = 1;
+                        }
+                        break;
+                    }
+                    case 1: {
+                        if (dpdr[k] * s.sd <= 0 || ++s.iter == 100) {
+                            /* refine bottom energy */
+                            s.e1    = s.enu;
+                            s.e0    = s.enu + s.de;
+                            s.enu   = (s.e1 + s.e0) / 2.0;
+                            s.iter  = 0;
+                            s.stage = 2;
+                        } else {
+                            s.de *= 1.1;
+                            s.enu -= s.de;
+                        }
+                        break;
+                    }
+                    case 2: {
+                        /* derivative at the boundary */
+                        bool done = std::abs(dpdr[k]) < 1e-10;
+                        if (!done) {
+                            if (dpdr[k] * s.sd > 0) {
+                                s.e0 = s.enu;
+                            } else {
+                                s.e1 = s.enu;
+                            }
+                        }
+                        if (done || ++s.iter == 100) {
+                            ebot_[j] = s.enu;
+                            s.stage  = 3;
+                        } else {
+                            s.enu = (s.e1 + s.e0) / 2.0;
+                        }
+                        break;
+                    }
+                    /* last check */
+                    case 3: {
+                        if (nn[k] != n_[j] - l_[j] - 1) {
+                            dump_solution(rel__, l_[j], s.enu);
+                            std::stringstream s1;
+                            s1 << "wrong number of nodes: " << nn[k] << " instead of " << n_[j] - l_[j] - 1 << std::endl
+                               << "n: " << n_[j] << ", l: " << l_[j] << std::endl
+                               << "etop: " << etop_[j] << " ebot: " << ebot_[j] << std::endl
+                               << "initial surface derivative: " << s.sd;
+
+                            throw std::runtime_error(s1.str());
+                        }
+                        enu_[j] = (ebot_[j] + etop_[j]) / 2.0;
+                        s.stage = 4;
+                        break;
+                    }
+                }
+            }
+        }
     }
 
   public:
@@ -1256,26 +1421,37 @@ class Enu_finder : public Radial_solver
     Enu_finder(relativity_t rel__, int zn__, int n__, int l__, Radial_grid<double> const& radial_grid__,
                std::vector<double> const& v__, double enu_start__)
         : Radial_solver(zn__, v__, radial_grid__)
+        , n_({n__})
+        , l_({l__})
+    {
+        assert(l__ < n__);
+        find_enu(rel__, {enu_start__});
+    }
+
+    /// Constructor for a batch of channels in the same potential.
+    Enu_finder(relativity_t rel__, int zn__, std::vector<int> const& n__, std::vector<int> const& l__,
+               Radial_grid<double> const& radial_grid__, std::vector<double> const& v__,
+               std::vector<double> const& enu_start__)
+        : Radial_solver(zn__, v__, radial_grid__)
         , n_(n__)
         , l_(l__)
     {
-        assert(l_ < n_);
         find_enu(rel__, enu_start__);
     }
 
-    inline double enu() const
+    inline double enu(int i__ = 0) const
     {
-        return enu_;
+        return enu_[i__];
     }
 
-    inline double ebot() const
+    inline double ebot(int i__ = 0) const
     {
-        return ebot_;
+        return ebot_[i__];
     }
 
-    inline double etop() const
+    inline double etop(int i__ = 0) const
     {
-        return etop_;
+        return etop_[i__];
     }
 };
 
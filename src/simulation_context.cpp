@@ -232,6 +232,7 @@ void Simulation_context::initialize()
     electronic_structure_method(parameters_input().electronic_structure_method_);
     set_core_relativity(parameters_input().core_relativity_);
     set_valence_relativity(parameters_input().valence_relativity_);
+    set_smearing(parameters_input().smearing_);
 
     /* can't run fp-lapw with Gamma point trick */
     if (full_potential()) {
@@ -609,6 +610,7 @@ void Simulation_context::print_info() const
     std::printf("lmax_rho                           : %i\n", lmax_rho());
     std::printf("lmax_pot                           : %i\n", lmax_pot());
     std::printf("lmax_rf                            : %i\n", unit_cell_.lmax());
+    std::printf("smearing                           : %s\n", parameters_input().smearing_.c_str());
     std::printf("smearing width                     : %f\n", smearing_width());
     std::printf("cyclic block size                  : %i\n", cyclic_block_size());
     std::printf("|G+k| cutoff                       : %f\n", gk_cutoff());
@@ -866,21 +868,11 @@ void Simulation_context::update()
                 new Radial_integrals_aug<false>(unit_cell(), new_pw_cutoff, settings().nprii_aug_));
         }
 
-        if (!aug_ri_djl_ || aug_ri_djl_->qmax() < new_pw_cutoff) {
-            aug_ri_djl_ = std::unique_ptr<Radial_integrals_aug<true>>(
-                new Radial_integrals_aug<true>(unit_cell(), new_pw_cutoff, settings().nprii_aug_));
-        }
-
         if (!ps_core_ri_ || ps_core_ri_->qmax() < new_pw_cutoff) {
             ps_core_ri_ = std::unique_ptr<Radial_integrals_rho_core_pseudo<false>>(
                 new Radial_integrals_rho_core_pseudo<false>(unit_cell(), new_pw_cutoff, settings().nprii_rho_core_));
         }
 
-        if (!ps_core_ri_djl_ || ps_core_ri_djl_->qmax() < new_pw_cutoff) {
-            ps_core_ri_djl_ = std::unique_ptr<Radial_integrals_rho_core_pseudo<true>>(
-                new Radial_integrals_rho_core_pseudo<true>(unit_cell(), new_pw_cutoff, settings().nprii_rho_core_));
-        }
-
         if (!ps_rho_ri_ || ps_rho_ri_->qmax() < new_pw_cutoff) {
             ps_rho_ri_ = std::unique_ptr<Radial_integrals_rho_pseudo>(
                 new Radial_integrals_rho_pseudo(unit_cell(), new_pw_cutoff, 20));
@@ -891,40 +883,19 @@ void Simulation_context::update()
                 new Radial_integrals_vloc<false>(unit_cell(), new_pw_cutoff, settings().nprii_vloc_));
         }
 
-        if (!vloc_ri_djl_ || vloc_ri_djl_->qmax() < new_pw_cutoff) {
-            vloc_ri_djl_ = std::unique_ptr<Radial_integrals_vloc<true>>(
-                new Radial_integrals_vloc<true>(unit_cell(), new_pw_cutoff, settings().nprii_vloc_));
-        }
-
-        /* radial integrals with pw_cutoff */
+        /* radial integrals with gk_cutoff */
         if (!beta_ri_ || beta_ri_->qmax() < new_gk_cutoff) {
             beta_ri_ = std::unique_ptr<Radial_integrals_beta<false>>(
                 new Radial_integrals_beta<false>(unit_cell(), new_gk_cutoff, settings().nprii_beta_));
         }
 
-        if (!beta_ri_djl_ || beta_ri_djl_->qmax() < new_gk_cutoff) {
-            beta_ri_djl_ = std::unique_ptr<Radial_integrals_beta<true>>(
-                new Radial_integrals_beta<true>(unit_cell(), new_gk_cutoff, settings().nprii_beta_));
-        }
-
-        if (!atomic_wf_ri_ || atomic_wf_ri_->qmax() < new_gk_cutoff) {
-            atomic_wf_ri_ = std::unique_ptr<Radial_integrals_atomic_wf<false>>(
-                new Radial_integrals_atomic_wf<false>(unit_cell(), new_gk_cutoff, 20, false));
-        }
-
-        if (!atomic_wf_ri_djl_ || atomic_wf_ri_djl_->qmax() < new_gk_cutoff) {
-            atomic_wf_ri_djl_ = std::unique_ptr<Radial_integrals_atomic_wf<true>>(
-                new Radial_integrals_atomic_wf<true>(unit_cell(), new_gk_cutoff, 20, false));
-        }
-
-        if (!hubbard_wf_ri_ || hubbard_wf_ri_->qmax() < new_gk_cutoff) {
-            hubbard_wf_ri_ = std::unique_ptr<Radial_integrals_atomic_wf<false>>(
-                new Radial_integrals_atomic_wf<false>(unit_cell(), new_gk_cutoff, 20, true));
-        }
+        /* the remaining radial integrals are created on the first request */
+        ri_pw_cutoff_ = new_pw_cutoff;
+        ri_gk_cutoff_ = new_gk_cutoff;
 
-        if (!hubbard_wf_ri_djl_ || hubbard_wf_ri_djl_->qmax() < new_gk_cutoff) {
-            hubbard_wf_ri_djl_ = std::unique_ptr<Radial_integrals_atomic_wf<true>>(
-                new Radial_integrals_atomic_wf<true>(unit_cell(), new_gk_cutoff, 20, true));
+        /* atomic wave-functions are used by each k-point to build Hubbard orbitals */
+        if (hubbard_correction()) {
+            atomic_wf_ri();
         }
     }
 
@@ -1056,32 +1027,7 @@ void Simulation_context::update()
         limits.second = std::max(limits.second, fft_grid().limits(x).second);
     }
 
-    /* recompute phase factors for atoms */
-    phase_factors_ = mdarray<double_complex, 3>(3, limits, unit_cell().num_atoms(), memory_t::host, "phase_factors_");
-    #pragma omp parallel for
-    for (int i = limits.first; i <= limits.second; i++) {
-        for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
-            auto pos = unit_cell_.atom(ia).position();
-            for (int x : {0, 1, 2}) {
-                phase_factors_(x, i, ia) = std::exp(double_complex(0.0, twopi * (i * pos[x])));
-            }
-        }
-    }
-
-    /* recompute phase factors for atom types */
-    phase_factors_t_ = mdarray<double_complex, 2>(gvec().count(), unit_cell().num_atom_types());
-    #pragma omp parallel for schedule(static)
-    for (int igloc = 0; igloc < gvec().count(); igloc++) {
-        /* global index of G-vector */
-        int ig = gvec().offset() + igloc;
-        for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
-            double_complex z(0, 0);
-            for (int ia = 0; ia < unit_cell().atom_type(iat).num_atoms(); ia++) {
-                z += gvec_phase_factor(ig, unit_cell().atom_type(iat).atom_id(ia));
-            }
-            phase_factors_t_(igloc, iat) = z;
-        }
-    }
+    update_phase_factors(limits);
 
     if (use_symmetry()) {
         sym_phase_factors_ = mdarray<double_complex, 3>(3, limits, unit_cell().symmetry().num_mag_sym());
@@ -1095,6 +1041,14 @@ void Simulation_context::update()
                 }
             }
         }
+
+        /* stars of G-vectors for the symmetrization of the plane-wave coefficients; the table is rebuilt only if
+           the rotations have changed (new lattice or point group), not on every update of atomic positions */
+        std::vector<matrix3d<int>> invRT;
+        for (int isym = 0; isym < unit_cell().symmetry().num_mag_sym(); isym++) {
+            invRT.push_back(unit_cell().symmetry().magnetic_group_symmetry(isym).spg_op.invRT);
+        }
+        remap_gvec_->build_stars(invRT);
     }
 
     /* precompute some G-vector related arrays */
@@ -1195,10 +1149,8 @@ void Simulation_context::generate_phase_factors(int iat__, mdarray<double_comple
         case device_t::CPU: {
             #pragma omp parallel for
             for (int igloc = 0; igloc < gvec().count(); igloc++) {
-                int ig = gvec().offset() + igloc;
                 for (int i = 0; i < na; i++) {
-                    int ia                    = unit_cell().atom_type(iat__).atom_id(i);
-                    phase_factors__(igloc, i) = gvec_phase_factor(ig, ia);
+                    phase_factors__(igloc, i) = gvec_phase_factor_loc(igloc, iat__, i);
                 }
             }
             break;
@@ -1238,20 +1190,172 @@ void Simulation_context::print_memory_usage(const char *file__, int line__)
     }
 }
 
+void Simulation_context::release_ri_djl() const
+{
+    if (control().memory_usage_ != "low") {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(ri_mutex_);
+    beta_ri_djl_.reset();
+    aug_ri_djl_.reset();
+    atomic_wf_ri_djl_.reset();
+    hubbard_wf_ri_djl_.reset();
+    ps_core_ri_djl_.reset();
+    vloc_ri_djl_.reset();
+}
+
+void Simulation_context::release_atomic_wf_ri() const
+{
+    if (control().memory_usage_ != "low" || hubbard_correction()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(ri_mutex_);
+    atomic_wf_ri_.reset();
+}
+
+void Simulation_context::update_phase_factors(std::pair<int, int> limits__)
+{
+    PROFILE("sirius::Simulation_context::update_phase_factors");
+
+    int na = unit_cell().num_atoms();
+
+    /* index of atom inside its atom type */
+    std::vector<int> idx_in_type(na);
+    for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
+        for (int i = 0; i < unit_cell().atom_type(iat).num_atoms(); i++) {
+            idx_in_type[unit_cell().atom_type(iat).atom_id(i)] = i;
+        }
+    }
+
+    size_t pf_size = sizeof(double_complex) * gvec().count() * na;
+    bool use_cache = pf_size > 0 && pf_size <= static_cast<size_t>(settings().phase_factors_cache_size_) * (1 << 20) &&
+                     control().memory_usage_ != "low";
+
+    /* everything is recomputed from scratch on the first call */
+    bool full = static_cast<int>(phase_factors_pos_.size()) != na ||
+                phase_factors_.size(1) != static_cast<size_t>(limits__.second - limits__.first + 1) ||
+                phase_factors_t_.size(0) != static_cast<size_t>(gvec().count()) ||
+                use_cache == phase_factors_cache_.empty();
+
+    /* list of atoms for which phase factors are recomputed */
+    std::vector<int> atoms;
+    for (int ia = 0; ia < na; ia++) {
+        auto pos = unit_cell_.atom(ia).position();
+        if (full || (pos - phase_factors_pos_[ia]).length() > settings().atom_pos_tol_) {
+            atoms.push_back(ia);
+        }
+    }
+    if (!full && atoms.empty()) {
+        return;
+    }
+
+    /* incremental update of the phase factors of atom types accumulates rounding errors; they are summed over all
+       atoms from time to time and if this is not more expensive than the incremental update */
+    bool full_t = full || 2 * static_cast<int>(atoms.size()) > na ||
+                  ++phase_factors_t_num_updates_ >= settings().phase_factors_t_rebuild_;
+
+    if (full) {
+        phase_factors_ = mdarray<double_complex, 3>(3, limits__, na, memory_t::host, "phase_factors_");
+        phase_factors_pos_.resize(na);
+        phase_factors_t_ = mdarray<double_complex, 2>(gvec().count(), unit_cell().num_atom_types());
+        phase_factors_cache_.clear();
+        if (use_cache) {
+            for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
+                phase_factors_cache_.push_back(mdarray<double_complex, 2>(gvec().count(),
+                    unit_cell().atom_type(iat).num_atoms(), memory_t::host, "phase_factors_cache_"));
+            }
+        }
+    } else if (!full_t) {
+        /* remove contribution of the old positions of the moved atoms */
+        #pragma omp parallel for schedule(static)
+        for (int igloc = 0; igloc < gvec().count(); igloc++) {
+            for (int ia : atoms) {
+                int iat = unit_cell().atom(ia).type_id();
+                phase_factors_t_(igloc, iat) -= gvec_phase_factor_loc(igloc, iat, idx_in_type[ia]);
+            }
+        }
+    }
+
+    for (int ia : atoms) {
+        phase_factors_pos_[ia] = unit_cell_.atom(ia).position();
+    }
+
+    /* recompute phase factors for atoms */
+    #pragma omp parallel for
+    for (int i = limits__.first; i <= limits__.second; i++) {
+        for (int ia : atoms) {
+            auto pos = unit_cell_.atom(ia).position();
+            for (int x : {0, 1, 2}) {
+                phase_factors_(x, i, ia) = std::exp(double_complex(0.0, twopi * (i * pos[x])));
+            }
+        }
+    }
+
+    /* update the cache of phase factors and add contribution of the new positions to the phase factors of
+       atom types */
+    #pragma omp parallel for schedule(static)
+    for (int igloc = 0; igloc < gvec().count(); igloc++) {
+        int ig = gvec().offset() + igloc;
+        for (int ia : atoms) {
+            int iat = unit_cell().atom(ia).type_id();
+            int i   = idx_in_type[ia];
+            if (!phase_factors_cache_.empty()) {
+                phase_factors_cache_[iat](igloc, i) = gvec_phase_factor(ig, ia);
+            }
+            if (!full_t) {
+                phase_factors_t_(igloc, iat) += gvec_phase_factor_loc(igloc, iat, i);
+            }
+        }
+    }
+
+    if (full_t) {
+        #pragma omp parallel for schedule(static)
+        for (int igloc = 0; igloc < gvec().count(); igloc++) {
+            for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
+                double_complex z(0, 0);
+                for (int i = 0; i < unit_cell().atom_type(iat).num_atoms(); i++) {
+                    z += gvec_phase_factor_loc(igloc, iat, i);
+                }
+                phase_factors_t_(igloc, iat) = z;
+            }
+        }
+        phase_factors_t_num_updates_ = 0;
+    }
+}
+
 void Simulation_context::init_atoms_to_grid_idx(double R__)
 {
     PROFILE("sirius::Simulation_context::init_atoms_to_grid_idx");
 
-    atoms_to_grid_idx_.resize(unit_cell_.num_atoms());
+    int na = unit_cell_.num_atoms();
+
+    /* search radius is extended by the skin distance */
+    double skin = std::max(settings().grid_skin_, 0.0);
+    double Rs   = R__ + skin;
+
+    /* lists of all atoms are rebuilt if the lattice, the radius or the number of atoms has changed */
+    bool full = static_cast<int>(atoms_to_grid_idx_.size()) != na || std::abs(R__ - atoms_to_grid_R_) > 1e-12;
+    for (int x : {0, 1, 2}) {
+        for (int y : {0, 1, 2}) {
+            full = full || std::abs(unit_cell_.lattice_vectors()(x, y) - atoms_to_grid_lv_(x, y)) > 1e-12;
+        }
+    }
+    if (full) {
+        atoms_to_grid_idx_.resize(na);
+        atoms_to_grid_cand_.resize(na);
+        atoms_to_grid_pos_.resize(na);
+        atoms_to_grid_R_  = R__;
+        atoms_to_grid_lv_ = unit_cell_.lattice_vectors();
+    }
 
     vector3d<double> delta(1.0 / spfft().dim_x(), 1.0 / spfft().dim_y(), 1.0 / spfft().dim_z());
 
     int z_off = spfft().local_z_offset();
     vector3d<int> grid_beg(0, 0, z_off);
     vector3d<int> grid_end(spfft().dim_x(), spfft().dim_y(), z_off + spfft().local_z_length());
-    std::vector<vector3d<double>> verts_cart{{-R__, -R__, -R__}, {R__, -R__, -R__}, {-R__, R__, -R__},
-                                             {R__, R__, -R__},   {-R__, -R__, R__}, {R__, -R__, R__},
-                                             {-R__, R__, R__},   {R__, R__, R__}};
+    std::vector<vector3d<double>> verts_cart{{-Rs, -Rs, -Rs}, {Rs, -Rs, -Rs}, {-Rs, Rs, -Rs},
+                                             {Rs, Rs, -Rs},   {-Rs, -Rs, Rs}, {Rs, -Rs, Rs},
+                                             {-Rs, Rs, Rs},   {Rs, Rs, Rs}};
 
     auto bounds_box = [&](vector3d<double> pos) {
         std::vector<vector3d<double>> verts;
@@ -1274,26 +1378,51 @@ void Simulation_context::init_atoms_to_grid_idx(double R__)
     };
 
     #pragma omp parallel for
-    for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+    for (int ia = 0; ia < na; ia++) {
+        auto pos = unit_cell_.atom(ia).position();
+
+        /* the previous list of candidates contains all points within R of the atom if it moved less than skin */
+        auto dr = unit_cell_.get_cartesian_coordinates(pos - atoms_to_grid_pos_[ia]).length();
+        if (!full && dr == 0) {
+            continue;
+        }
+        if (!full && dr <= skin) {
+            std::vector<std::pair<int, double>> atom_to_ind_map;
+            for (auto& c : atoms_to_grid_cand_[ia]) {
+                auto r = unit_cell_.get_cartesian_coordinates(pos - c.second).length();
+                if (r < R__) {
+                    atom_to_ind_map.push_back({c.first, r});
+                }
+            }
+            atoms_to_grid_idx_[ia] = std::move(atom_to_ind_map);
+            continue;
+        }
 
         std::vector<std::pair<int, double>> atom_to_ind_map;
+        std::vector<std::pair<int, vector3d<double>>> atom_to_ind_cand;
 
         for (int t0 = -1; t0 <= 1; t0++) {
             for (int t1 = -1; t1 <= 1; t1++) {
                 for (int t2 = -1; t2 <= 1; t2++) {
-                    auto pos = unit_cell_.atom(ia).position() + vector3d<double>(t0, t1, t2);
+                    vector3d<double> t(t0, t1, t2);
 
                     /* find the small box around this atom */
-                    auto box = bounds_box(pos);
+                    auto box = bounds_box(pos + t);
 
                     for (int j0 = box.first[0]; j0 < box.second[0]; j0++) {
                         for (int j1 = box.first[1]; j1 < box.second[1]; j1++) {
                             for (int j2 = box.first[2]; j2 < box.second[2]; j2++) {
-                                auto v = pos - vector3d<double>(delta[0] * j0, delta[1] * j1, delta[2] * j2);
-                                auto r  = unit_cell_.get_cartesian_coordinates(v).length();
-                                if (r < R__) {
+                                /* grid point shifted to the image of the atom */
+                                auto p = vector3d<double>(delta[0] * j0, delta[1] * j1, delta[2] * j2) - t;
+                                auto r = unit_cell_.get_cartesian_coordinates(pos - p).length();
+                                if (r < Rs) {
                                     auto ir = fft_grid_.index_by_coord(j0, j1, j2 - z_off);
-                                    atom_to_ind_map.push_back({ir, r});
+                                    if (r < R__) {
+                                        atom_to_ind_map.push_back({ir, r});
+                                    }
+                                    if (skin > 0) {
+                                        atom_to_ind_cand.push_back({ir, p});
+                                    }
                                 }
                             }
                         }
@@ -1302,7 +1431,9 @@ void Simulation_context::init_atoms_to_grid_idx(double R__)
             }
         }
 
-        atoms_to_grid_idx_[ia] = std::move(atom_to_ind_map);
+        atoms_to_grid_idx_[ia]  = std::move(atom_to_ind_map);
+        atoms_to_grid_cand_[ia] = std::move(atom_to_ind_cand);
+        atoms_to_grid_pos_[ia]  = pos;
     }
 }
 
@@ -26,6 +26,7 @@
 #define __SIMULATION_CONTEXT_HPP__
 
 #include <algorithm>
+#include <mutex>
 
 #include "simulation_parameters.hpp"
 #include "mpi_grid.hpp"
@@ -139,6 +140,18 @@ class Simulation_context : public Simulation_parameters
     /// Phase factors for atom types.
     sddk::mdarray<double_complex, 2> phase_factors_t_;
 
+    /// Cache of phase factors of atoms for the local set of G-vectors.
+    /** One block of dimensions (gvec().count(), atom_type(iat).num_atoms()) per atom type. The cache is rebuilt
+        in update() and is empty if it does not fit into the memory limit set by
+        settings().phase_factors_cache_size_ or if the low memory usage is requested. */
+    std::vector<sddk::mdarray<double_complex, 2>> phase_factors_cache_;
+
+    /// Fractional positions of atoms for which the phase factors were computed.
+    std::vector<vector3d<double>> phase_factors_pos_;
+
+    /// Number of incremental updates of phase_factors_t_ since it was last summed over all atoms.
+    int phase_factors_t_num_updates_{0};
+
     /// Lattice coordinats of G-vectors in a GPU-friendly ordering.
     sddk::mdarray<int, 2> gvec_coord_;
 
@@ -149,35 +162,42 @@ class Simulation_context : public Simulation_parameters
     /** This is needed to estimate the new cutoff for radial integrals. */
     double omega0_;
 
+    /// Plane-wave cutoff of the radial integrals.
+    double ri_pw_cutoff_{0};
+
+    /// G+k cutoff of the radial integrals.
+    double ri_gk_cutoff_{0};
+
     /// Radial integrals of beta-projectors.
     std::unique_ptr<Radial_integrals_beta<false>> beta_ri_;
 
     /// Radial integrals of beta-projectors with derivatives of spherical Bessel functions.
-    std::unique_ptr<Radial_integrals_beta<true>> beta_ri_djl_;
+    /** This and the other tables declared mutable are created on the first request (see lazy_ri()). */
+    mutable std::unique_ptr<Radial_integrals_beta<true>> beta_ri_djl_;
 
     /// Radial integrals of augmentation operator.
     std::unique_ptr<Radial_integrals_aug<false>> aug_ri_;
 
     /// Radial integrals of augmentation operator with derivatives of spherical Bessel functions.
-    std::unique_ptr<Radial_integrals_aug<true>> aug_ri_djl_;
+    mutable std::unique_ptr<Radial_integrals_aug<true>> aug_ri_djl_;
 
     /// Radial integrals of atomic wave-functions.
-    std::unique_ptr<Radial_integrals_atomic_wf<false>> atomic_wf_ri_;
+    mutable std::unique_ptr<Radial_integrals_atomic_wf<false>> atomic_wf_ri_;
 
     /// Radial integrals of atomic wave-functions with derivatives of spherical Bessel functions.
-    std::unique_ptr<Radial_integrals_atomic_wf<true>> atomic_wf_ri_djl_;
+    mutable std::unique_ptr<Radial_integrals_atomic_wf<true>> atomic_wf_ri_djl_;
 
     /// Radial integrals of hubbard wave-functions.
-    std::unique_ptr<Radial_integrals_atomic_wf<false>> hubbard_wf_ri_;
+    mutable std::unique_ptr<Radial_integrals_atomic_wf<false>> hubbard_wf_ri_;
 
     /// Radial integrals of hubbard wave-functions with derivatives of spherical Bessel functions.
-    std::unique_ptr<Radial_integrals_atomic_wf<true>> hubbard_wf_ri_djl_;
+    mutable std::unique_ptr<Radial_integrals_atomic_wf<true>> hubbard_wf_ri_djl_;
 
     /// Radial integrals of pseudo-core charge density.
     std::unique_ptr<Radial_integrals_rho_core_pseudo<false>> ps_core_ri_;
 
     /// Radial integrals of pseudo-core charge density with derivatives of spherical Bessel functions.
-    std::unique_ptr<Radial_integrals_rho_core_pseudo<true>> ps_core_ri_djl_;
+    mutable std::unique_ptr<Radial_integrals_rho_core_pseudo<true>> ps_core_ri_djl_;
 
     /// Radial integrals of total pseudo-charge density.
     std::unique_ptr<Radial_integrals_rho_pseudo> ps_rho_ri_;
@@ -186,11 +206,27 @@ class Simulation_context : public Simulation_parameters
     std::unique_ptr<Radial_integrals_vloc<false>> vloc_ri_;
 
     /// Radial integrals of the local part of pseudopotential with derivatives of spherical Bessel functions.
-    std::unique_ptr<Radial_integrals_vloc<true>> vloc_ri_djl_;
+    mutable std::unique_ptr<Radial_integrals_vloc<true>> vloc_ri_djl_;
+
+    /// Guard of the on-demand creation of radial integrals.
+    mutable std::mutex ri_mutex_;
 
     /// List of real-space point indices for each of the atoms.
     std::vector<std::vector<std::pair<int, double>>> atoms_to_grid_idx_;
 
+    /// List of candidate real-space points within the radius R + skin for each of the atoms.
+    /** Each point is stored together with its fractional coordinates shifted to the periodic image of the atom. */
+    std::vector<std::vector<std::pair<int, vector3d<double>>>> atoms_to_grid_cand_;
+
+    /// Fractional positions of atoms for which the lists of candidate points were found.
+    std::vector<vector3d<double>> atoms_to_grid_pos_;
+
+    /// Lattice vectors for which the lists of candidate points were found.
+    matrix3d<double> atoms_to_grid_lv_;
+
+    /// Radius for which the lists of real-space points were found.
+    double atoms_to_grid_R_{-1};
+
     /// Plane wave expansion coefficients of the step function.
     sddk::mdarray<double_complex, 1> theta_pw_;
 
@@ -269,8 +305,16 @@ class Simulation_context : public Simulation_parameters
     void init_step_function();
 
     /// Find a list of real-space grid points around each atom.
+    /** The lists are rebuilt only for the atoms which moved further than settings().grid_skin_ since the last
+        search; for the remaining atoms the previous list of candidate points is filtered. */
     void init_atoms_to_grid_idx(double R__);
 
+    /// Recompute phase factors of atoms.
+    /** Only the atoms which moved further than settings().atom_pos_tol_ since the last call are updated. The
+        phase factors of atom types are updated incrementally and summed over all atoms every
+        settings().phase_factors_t_rebuild_ updates or if more than half of the atoms have moved. */
+    void update_phase_factors(std::pair<int, int> limits__);
+
     /// Get the stsrting time stamp.
     void start()
     {
@@ -482,6 +526,37 @@ class Simulation_context : public Simulation_parameters
         return gvec_phase_factor(gvec().gvec(ig__), ia__);
     }
 
+    /// Phase factor \f$ e^{i {\bf G} {\bf r}_{\alpha}} \f$ of the i-th atom of type iat for the local G-vector.
+    /** The value is taken from the cache if it is available. */
+    inline double_complex gvec_phase_factor_loc(int igloc__, int iat__, int i__) const
+    {
+        if (!phase_factors_cache_.empty()) {
+            return phase_factors_cache_[iat__](igloc__, i__);
+        }
+        return gvec_phase_factor(gvec().offset() + igloc__, unit_cell_.atom_type(iat__).atom_id(i__));
+    }
+
+    /// True if the phase factors of atoms are cached.
+    inline bool phase_factors_cached() const
+    {
+        return !phase_factors_cache_.empty();
+    }
+
+    /// Cached phase factors of all atoms of a given type for the local set of G-vectors.
+    /** The block has the dimensions (gvec().count(), atom_type(iat).num_atoms()) and is used directly as a GEMM
+        operand. Treated as a real matrix it has the leading dimension 2 * ld() and holds the interleaved real and
+        imaginary parts in the same way as the plane-wave coefficients of the augmentation operator. */
+    inline sddk::mdarray<double_complex, 2> const& phase_factors_cache(int iat__) const
+    {
+        return phase_factors_cache_[iat__];
+    }
+
+    /// Phase factors \f$ \sum_{\alpha \in T} e^{i {\bf G} {\bf r}_{\alpha}} \f$ of atom type T for the local G-vector.
+    inline double_complex phase_factors_t(int igloc__, int iat__) const
+    {
+        return phase_factors_t_(igloc__, iat__);
+    }
+
     inline sddk::mdarray<int, 2> const& gvec_coord() const
     {
         return gvec_coord_;
@@ -543,6 +618,19 @@ class Simulation_context : public Simulation_parameters
     mdarray<double_complex, 2> sum_fg_fl_yg(int lmax__, double_complex const* fpw__, mdarray<double, 3>& fl__,
                                             matrix<double_complex>& gvec_ylm__);
 
+    /// Get radial integrals creating them on the first request or if the cutoff has grown since the last request.
+    /** Construction of radial integrals is collective over the communicator of the unit cell. The first request
+        must be made by all MPI ranks outside of the OpenMP parallel regions. */
+    template <typename T, typename... Args>
+    inline T const& lazy_ri(std::unique_ptr<T>& ri__, double qmax__, Args... args__) const
+    {
+        std::lock_guard<std::mutex> lock(ri_mutex_);
+        if (!ri__ || ri__->qmax() < qmax__) {
+            ri__ = std::unique_ptr<T>(new T(unit_cell_, qmax__, args__...));
+        }
+        return *ri__;
+    }
+
     inline Radial_integrals_beta<false> const& beta_ri() const
     {
         return *beta_ri_;
@@ -550,7 +638,7 @@ class Simulation_context : public Simulation_parameters
 
     inline Radial_integrals_beta<true> const& beta_ri_djl() const
     {
-        return *beta_ri_djl_;
+        return lazy_ri(beta_ri_djl_, ri_gk_cutoff_, settings().nprii_beta_);
     }
 
     inline Radial_integrals_aug<false> const& aug_ri() const
@@ -560,27 +648,27 @@ class Simulation_context : public Simulation_parameters
 
     inline Radial_integrals_aug<true> const& aug_ri_djl() const
     {
-        return *aug_ri_djl_;
+        return lazy_ri(aug_ri_djl_, ri_pw_cutoff_, settings().nprii_aug_);
     }
 
     inline Radial_integrals_atomic_wf<false> const& atomic_wf_ri() const
     {
-        return *atomic_wf_ri_;
+        return lazy_ri(atomic_wf_ri_, ri_gk_cutoff_, 20, false);
     }
 
     inline Radial_integrals_atomic_wf<true> const& atomic_wf_djl() const
     {
-        return *atomic_wf_ri_djl_;
+        return lazy_ri(atomic_wf_ri_djl_, ri_gk_cutoff_, 20, false);
     }
 
     inline Radial_integrals_atomic_wf<false> const& hubbard_wf_ri() const
     {
-        return *hubbard_wf_ri_;
+        return lazy_ri(hubbard_wf_ri_, ri_gk_cutoff_, 20, true);
     }
 
     inline Radial_integrals_atomic_wf<true> const& hubbard_wf_djl() const
     {
-        return *hubbard_wf_ri_djl_;
+        return lazy_ri(hubbard_wf_ri_djl_, ri_gk_cutoff_, 20, true);
     }
 
     inline Radial_integrals_rho_core_pseudo<false> const& ps_core_ri() const
@@ -590,7 +678,7 @@ class Simulation_context : public Simulation_parameters
 
     inline Radial_integrals_rho_core_pseudo<true> const& ps_core_ri_djl() const
     {
-        return *ps_core_ri_djl_;
+        return lazy_ri(ps_core_ri_djl_, ri_pw_cutoff_, settings().nprii_rho_core_);
     }
 
     inline Radial_integrals_rho_pseudo const& ps_rho_ri() const
@@ -605,9 +693,17 @@ class Simulation_context : public Simulation_parameters
 
     inline Radial_integrals_vloc<true> const& vloc_ri_djl() const
     {
-        return *vloc_ri_djl_;
+        return lazy_ri(vloc_ri_djl_, ri_pw_cutoff_, settings().nprii_vloc_);
     }
 
+    /// Release radial integrals with derivatives of spherical Bessel functions in the memory-lean mode.
+    /** The integrals are needed only for the stress tensor and are recreated on the next request. */
+    void release_ri_djl() const;
+
+    /// Release radial integrals of atomic wave-functions in the memory-lean mode.
+    /** The integrals are kept if the Hubbard correction is switched on. */
+    void release_atomic_wf_ri() const;
+
     /// Find the lambda parameter used in the Ewald summation.
     /** Lambda parameter scales the erfc function argument:
      *  \f[
@@ -745,6 +841,7 @@ class Simulation_context : public Simulation_parameters
 
     inline double evp_work_count(double w__ = 0) const
     {
+        #pragma omp atomic
         evp_work_count_ += w__;
         return evp_work_count_;
     }
@@ -752,6 +849,7 @@ class Simulation_context : public Simulation_parameters
     /// Keep track of the total number of wave-functions to which the local operator was applied.
     inline int num_loc_op_applied(int n = 0) const
     {
+        #pragma omp atomic
         num_loc_op_applied_ += n;
         return num_loc_op_applied_;
     }
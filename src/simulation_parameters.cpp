@@ -124,6 +124,23 @@ void Simulation_parameters::set_valence_relativity(std::string name__)
     valence_relativity_ = m.at(name__);
 }
 
+void Simulation_parameters::set_smearing(std::string name__)
+{
+    parameters_input_.smearing_ = name__;
+
+    std::map<std::string, smearing_t> const m = {{"gaussian", smearing_t::gaussian},
+                                                 {"fermi_dirac", smearing_t::fermi_dirac},
+                                                 {"methfessel_paxton", smearing_t::methfessel_paxton},
+                                                 {"cold", smearing_t::cold}};
+
+    if (m.count(name__) == 0) {
+        std::stringstream s;
+        s << "wrong type of smearing: " << name__;
+        TERMINATE(s);
+    }
+    smearing_ = m.at(name__);
+}
+
 void Simulation_parameters::set_processing_unit(std::string name__)
 {
     std::transform(name__.begin(), name__.end(), name__.begin(), ::tolower);
@@ -63,6 +63,9 @@ class Simulation_parameters
     /// Type of relativity for core states.
     relativity_t core_relativity_{relativity_t::dirac};
 
+    /// Type of smearing of the band occupancies.
+    smearing_t smearing_{smearing_t::gaussian};
+
     /// Type of electronic structure method.
     electronic_structure_method_t electronic_structure_method_{electronic_structure_method_t::full_potential_lapwlo};
 
@@ -173,6 +176,8 @@ class Simulation_parameters
 
     void set_valence_relativity(std::string name__);
 
+    void set_smearing(std::string name__);
+
     void set_processing_unit(std::string name__);
 
     void set_processing_unit(device_t pu__);
@@ -376,6 +381,11 @@ class Simulation_parameters
         parameters_input_.smearing_width_ = smearing_width__;
     }
 
+    smearing_t smearing() const
+    {
+        return smearing_;
+    }
+
     void set_auto_rmt(int auto_rmt__)
     {
         parameters_input_.auto_rmt_ = auto_rmt__;
@@ -720,6 +720,40 @@ void sirius_find_ground_state(void*  const* gs_handler__,
     auto result = gs.find(rho_tol, etol, ctx.iterative_solver_tolerance(), niter, save);
 }
 
+/* @fortran begin function void sirius_find_ground_state_direct  Find the ground state by the direct minimization of the total energy.
+   @fortran argument in required void*  gs_handler                 Handler of the ground state.
+   @fortran argument in optional double energy_tol                 Tolerance in total energy difference.
+   @fortran argument in optional double residual_tol               Tolerance on the norm of the energy gradient.
+   @fortran argument in optional int    niter                      Maximum number of iterations.
+   @fortran end */
+void sirius_find_ground_state_direct(void*  const* gs_handler__,
+                                     double const* energy_tol__,
+                                     double const* residual_tol__,
+                                     int    const* niter__)
+{
+    auto& gs = get_gs(gs_handler__);
+    auto& ctx = gs.ctx();
+    auto& inp = ctx.parameters_input();
+    gs.initial_state();
+
+    double etol = inp.energy_tol_;
+    if (energy_tol__) {
+        etol = *energy_tol__;
+    }
+
+    double rtol = ctx.iterative_solver_input().residual_tolerance_;
+    if (residual_tol__) {
+        rtol = *residual_tol__;
+    }
+
+    int niter = inp.num_dft_iter_;
+    if (niter__) {
+        niter = *niter__;
+    }
+
+    auto result = gs.find_direct(etol, rtol, niter);
+}
+
 /* @fortran begin function void sirius_update_ground_state   Update a ground state object after change of atomic coordinates or lattice vectors.
    @fortran argument in  required void*  gs_handler          Ground-state handler.
    @fortran end */
@@ -1020,28 +1054,20 @@ void sirius_set_pw_coeffs(void*                const* handler__,
         mdarray<int, 2> gvec(gvl__, 3, *ngv__);
 
         std::vector<double_complex> v(gs.ctx().gvec().num_gvec(), 0);
+        auto igv = gs.ctx().gvec().index_by_gvec(*ngv__, gvl__, true);
         #pragma omp parallel for schedule(static)
         for (int i = 0; i < *ngv__; i++) {
-            vector3d<int> G(gvec(0, i), gvec(1, i), gvec(2, i));
-            //auto gvc = gs.ctx().unit_cell().reciprocal_lattice_vectors() * vector3d<double>(G[0], G[1], G[2]);
-            //if (gvc.length() > gs.ctx().pw_cutoff()) {
-            //    continue;
-            //}
-            int ig = gs.ctx().gvec().index_by_gvec(G);
+            int ig = igv[i].first;
             if (ig >= 0) {
-                v[ig] = pw_coeffs__[i];
+                v[ig] = igv[i].second ? std::conj(pw_coeffs__[i]) : pw_coeffs__[i];
             } else {
                 if (gs.ctx().gamma_point()) {
-                    ig = gs.ctx().gvec().index_by_gvec(G * (-1));
-                    if (ig == -1) {
-                        std::stringstream s;
-                        auto gvc = gs.ctx().unit_cell().reciprocal_lattice_vectors() * vector3d<double>(G[0], G[1], G[2]);
-                        s << "wrong index of G-vector" << std::endl
-                          << "input G-vector: " << G << " (length: " << gvc.length() << " [a.u.^-1])" << std::endl;
-                        TERMINATE(s);
-                    } else {
-                        v[ig] = std::conj(pw_coeffs__[i]);
-                    }
+                    vector3d<int> G(gvec(0, i), gvec(1, i), gvec(2, i));
+                    std::stringstream s;
+                    auto gvc = gs.ctx().unit_cell().reciprocal_lattice_vectors() * vector3d<double>(G[0], G[1], G[2]);
+                    s << "wrong index of G-vector" << std::endl
+                      << "input G-vector: " << G << " (length: " << gvc.length() << " [a.u.^-1])" << std::endl;
+                    TERMINATE(s);
                 }
             }
         }
@@ -1120,6 +1146,8 @@ void sirius_get_pw_coeffs(void*                const* handler__,
             TERMINATE("wrong label");
         }
 
+        auto igv = gs.ctx().gvec().index_by_gvec(*ngv__, gvl__, true);
+
         for (int i = 0; i < *ngv__; i++) {
             vector3d<int> G(gvec(0, i), gvec(1, i), gvec(2, i));
 
@@ -1129,12 +1157,8 @@ void sirius_get_pw_coeffs(void*                const* handler__,
             //    continue;
             //}
 
-            bool is_inverse{false};
-            int ig = gs.ctx().gvec().index_by_gvec(G);
-            if (ig == -1 && gs.ctx().gvec().reduced()) {
-                ig = gs.ctx().gvec().index_by_gvec(G * (-1));
-                is_inverse = true;
-            }
+            int ig = igv[i].first;
+            bool is_inverse = igv[i].second;
             if (ig == -1) {
                 std::stringstream s;
                 auto gvc = gs.ctx().unit_cell().reciprocal_lattice_vectors() * vector3d<double>(G[0], G[1], G[2]);
@@ -1188,25 +1212,30 @@ void sirius_get_pw_coeffs_real(void* const* handler__,
         }
     };
 
+    /* the tables are obtained before the OpenMP region: lazy ones are created collectively on the first request */
     if (label == "rhoc") {
+        auto& ri = sim_ctx.ps_core_ri();
         make_pw_coeffs([&](double g)
                        {
-                           return sim_ctx.ps_core_ri().value<int>(iat, g);
+                           return ri.value<int>(iat, g);
                        });
     } else if (label == "rhoc_dg") {
+        auto& ri = sim_ctx.ps_core_ri_djl();
         make_pw_coeffs([&](double g)
                        {
-                           return sim_ctx.ps_core_ri_djl().value<int>(iat, g);
+                           return ri.value<int>(iat, g);
                        });
     } else if (label == "vloc") {
+        auto& ri = sim_ctx.vloc_ri();
         make_pw_coeffs([&](double g)
                        {
-                           return sim_ctx.vloc_ri().value(iat, g);
+                           return ri.value(iat, g);
                        });
     } else if (label == "rho") {
+        auto& ri = sim_ctx.ps_rho_ri();
         make_pw_coeffs([&](double g)
                        {
-                           return sim_ctx.ps_rho_ri().value<int>(iat, g);
+                           return ri.value<int>(iat, g);
                        });
     } else {
         std::stringstream s;
@@ -1742,6 +1771,8 @@ void sirius_get_q_operator(void*          const* handler__,
     }
     sim_ctx.comm().allgather(q_pw.data(), sim_ctx.gvec().offset(), sim_ctx.gvec().count());
 
+    auto igv = sim_ctx.gvec().index_by_gvec(*ngv__, gvl__, true);
+
     for (int i = 0; i < *ngv__; i++) {
         vector3d<int> G(gvl(0, i), gvl(1, i), gvl(2, i));
 
@@ -1751,12 +1782,8 @@ void sirius_get_q_operator(void*          const* handler__,
             continue;
         }
 
-        bool is_inverse{false};
-        int ig = sim_ctx.gvec().index_by_gvec(G);
-        if (ig == -1 && sim_ctx.gvec().reduced()) {
-            ig = sim_ctx.gvec().index_by_gvec(G * (-1));
-            is_inverse = true;
-        }
+        int ig = igv[i].first;
+        bool is_inverse = igv[i].second;
         if (ig == -1) {
             std::stringstream s;
             auto gvc = sim_ctx.unit_cell().reciprocal_lattice_vectors() * vector3d<double>(G[0], G[1], G[2]);
@@ -1827,6 +1854,8 @@ void sirius_get_wave_functions(void*          const* ks_handler__,
 
         mdarray<int, 2> gvec_k(gvec_k__, 3, *npw__);
 
+        auto igv = gkvec.index_by_gvec(*npw__, gvec_k__, true);
+
         for (int ig = 0; ig < *npw__; ig++) {
             /* G vector of host code */
             auto gvc = kset.ctx().unit_cell().reciprocal_lattice_vectors() *
@@ -1834,25 +1863,13 @@ void sirius_get_wave_functions(void*          const* ks_handler__,
             if (gvc.length() > kset.ctx().gk_cutoff()) {
                 continue;
             }
-            int ig1 = gkvec.index_by_gvec({gvec_k(0, ig), gvec_k(1, ig), gvec_k(2, ig)});
-            /* vector is out of bounds */
-            if (ig1 >= gkvec.num_gvec()) {
-                continue;
-            }
-            /* index of G was not found */
+            int ig1 = igv[ig].first;
+            /* index of G or -G was not found */
             if (ig1 < 0) {
-                /* try -G */
-                ig1 = gkvec.index_by_gvec({-gvec_k(0, ig), -gvec_k(1, ig), -gvec_k(2, ig)});
-                /* index of -G was not found */
-                if (ig1 < 0) {
-                    continue;
-                } else {
-                    /* this will tell co conjugate PW coefficients as we take them from -G index */
-                    igm[ig] = -ig1;
-                }
-            } else {
-                igm[ig] = ig1;
+                continue;
             }
+            /* negative index tells to conjugate PW coefficients as we take them from -G index */
+            igm[ig] = igv[ig].second ? -ig1 : ig1;
         }
         return igm;
     };
@@ -1983,6 +2000,10 @@ void sirius_get_wave_functions(void*          const* ks_handler__,
    @fortran argument in   required double  q                     Length of the reciprocal wave-vector.
    @fortran argument in   required int     idx                   Index of the radial integral.
    @fortran argument in   optional int     l                     Orbital quantum number (for Q-radial integrals).
+   @fortran details
+   Tables of the "aug_dj" and "beta_dj" integrals are created on the first request (and recreated
+   after they are released in the low-memory mode). The creation is collective: the first call with
+   such a label must be made by all MPI ranks of the simulation context outside of OpenMP regions.
    @fortran end */
 double sirius_get_radial_integral(void*  const* handler__,
                                   char   const* atom_type__,
@@ -27,40 +27,108 @@
 
 #include <cmath>
 
+/// Smearing functions of the band occupancies.
+/** Each smearing defines the occupancy \f$ f(x) \f$ and the broadened delta-function \f$ \delta(x) = -f'(x) \f$ of
+ *  the dimensionless argument \f$ x = (\varepsilon - \varepsilon_F) / \sigma \f$, where \f$ \sigma \f$ is the
+ *  smearing width. All functions are branch-free and can be used inside vectorized loops.
+ *
+ *  The entropy-like term
+ *  \f[
+ *    s(x) = \int_{-\infty}^{x} t \delta(t) dt
+ *  \f]
+ *  gives the smearing contribution \f$ -TS = \sigma \sum_i w_i s(x_i) \f$ to the free energy, which makes the
+ *  free energy variational with respect to the occupancies. */
 namespace smearing {
 
-inline double fermi_dirac(double e)
+const double sqrt_pi = 1.7724538509055160273;
+
+const double sqrt2 = 1.4142135623730950488;
+
+/// Gaussian smearing.
+struct gaussian
 {
-    double kT = 0.001;
-    if (e > 100 * kT) {
-        return 0.0;
+    static inline double occupancy(double x__)
+    {
+        return 0.5 * std::erfc(x__);
     }
-    if (e < -100 * kT) {
-        return 1.0;
+
+    static inline double delta(double x__)
+    {
+        return std::exp(-x__ * x__) / sqrt_pi;
     }
-    return (1.0 / (std::exp(e / kT) + 1.0));
-}
 
-inline double gaussian(double e, double delta)
+    static inline double entropy(double x__)
+    {
+        return -std::exp(-x__ * x__) / (2 * sqrt_pi);
+    }
+};
+
+/// Fermi-Dirac smearing.
+struct fermi_dirac
 {
-    return 0.5 * (1 - std::erf(e / delta));
-}
+    static inline double occupancy(double x__)
+    {
+        /* exp() overflows to inf for large x and the occupancy correctly goes to zero */
+        return 1.0 / (std::exp(x__) + 1.0);
+    }
+
+    static inline double delta(double x__)
+    {
+        double e = std::exp(-std::abs(x__));
+        return e / ((1.0 + e) * (1.0 + e));
+    }
 
-inline double cold(double e)
+    /// Returns \f$ f \ln f + (1 - f) \ln (1 - f) \f$, written in the form which is stable for large \f$ |x| \f$.
+    static inline double entropy(double x__)
+    {
+        double e = std::exp(-std::abs(x__));
+        double f = e / (1.0 + e);
+        return -std::log1p(e) - f * std::abs(x__);
+    }
+};
+
+/// First-order Methfessel-Paxton smearing.
+/** M. Methfessel and A. T. Paxton, Phys. Rev. B 40, 3616 (1989). */
+struct methfessel_paxton
 {
-    const double pi = 3.1415926535897932385;
-    
-    double a = -0.5634;
+    static inline double occupancy(double x__)
+    {
+        return 0.5 * std::erfc(x__) - x__ * std::exp(-x__ * x__) / (2 * sqrt_pi);
+    }
 
-    if (e < -10.0) {
-        return 1.0;
+    static inline double delta(double x__)
+    {
+        return std::exp(-x__ * x__) * (1.5 - x__ * x__) / sqrt_pi;
     }
-    if (e > 10.0) {
-        return 0.0;
+
+    static inline double entropy(double x__)
+    {
+        return std::exp(-x__ * x__) * (x__ * x__ - 0.5) / (2 * sqrt_pi);
     }
+};
 
-    return 0.5 * (1 - std::erf(e)) - 1 - 0.25 * std::exp(-e * e) * (a + 2 * e - 2 * a * e * e) / std::sqrt(pi);
-}
+/// Marzari-Vanderbilt (cold) smearing.
+/** N. Marzari, D. Vanderbilt, A. De Vita and M. C. Payne, Phys. Rev. Lett. 82, 3296 (1999). */
+struct cold
+{
+    static inline double occupancy(double x__)
+    {
+        double u = x__ + 1.0 / sqrt2;
+        return 0.5 * std::erfc(u) + std::exp(-u * u) / (sqrt2 * sqrt_pi);
+    }
+
+    static inline double delta(double x__)
+    {
+        double u = x__ + 1.0 / sqrt2;
+        return std::exp(-u * u) * (2.0 + sqrt2 * x__) / sqrt_pi;
+    }
+
+    static inline double entropy(double x__)
+    {
+        double u = x__ + 1.0 / sqrt2;
+        return -u * std::exp(-u * u) / (sqrt2 * sqrt_pi);
+    }
+};
 
 }
 
@@ -69,6 +69,15 @@ class Smooth_periodic_function
         gvecp_->gather_pw_fft(f_pw_local_.at(sddk::memory_t::host), f_pw_fft_.at(sddk::memory_t::host));
     }
 
+    /// Copy the local fraction of plane-wave coefficients after the FFT call.
+    inline void scatter_f_pw_fft()
+    {
+        int count  = gvecp_->gvec_fft_slab().counts[gvecp_->comm_ortho_fft().rank()];
+        int offset = gvecp_->gvec_fft_slab().offsets[gvecp_->comm_ortho_fft().rank()];
+        std::memcpy(f_pw_local_.at(sddk::memory_t::host), f_pw_fft_.at(sddk::memory_t::host, offset),
+                    count * sizeof(double_complex));
+    }
+
     Smooth_periodic_function(Smooth_periodic_function<T> const& src__) = delete;
     Smooth_periodic_function<T>& operator=(Smooth_periodic_function<T> const& src__) = delete;
 
@@ -223,10 +232,7 @@ class Smooth_periodic_function
                 spfft_->forward(SPFFT_PU_HOST, reinterpret_cast<double*>(f_pw_fft_.at(sddk::memory_t::host)),
                                 SPFFT_FULL_SCALING);
                 if (gvecp_->comm_ortho_fft().size() != 1) {
-                    int count  = gvecp_->gvec_fft_slab().counts[gvecp_->comm_ortho_fft().rank()];
-                    int offset = gvecp_->gvec_fft_slab().offsets[gvecp_->comm_ortho_fft().rank()];
-                    std::memcpy(f_pw_local_.at(sddk::memory_t::host), f_pw_fft_.at(sddk::memory_t::host, offset),
-                                count * sizeof(double_complex));
+                    scatter_f_pw_fft();
                 }
                 break;
             }
@@ -236,6 +242,9 @@ class Smooth_periodic_function
         }
     }
 
+    friend void fft_transform(std::vector<Smooth_periodic_function<double>*> const& f__,
+                              std::vector<spfft::Transform>& spfft__, int direction__);
+
     inline std::vector<double_complex> gather_f_pw()
     {
         PROFILE("sirius::Smooth_periodic_function::gather_f_pw");
@@ -303,6 +312,57 @@ class Smooth_periodic_function
     }
 };
 
+/// Batched FFT of several smooth periodic functions.
+/** The i-th function is transformed with the i-th FFT driver. The drivers must be independent copies of the FFT
+ *  driver of the functions (created with spfft::Transform::clone()), such that SpFFT can overlap the data
+ *  exchange and the computation of different transforms. */
+inline void fft_transform(std::vector<Smooth_periodic_function<double>*> const& f__,
+                          std::vector<spfft::Transform>& spfft__, int direction__)
+{
+    PROFILE("sirius::fft_transform");
+
+    int n = static_cast<int>(f__.size());
+    if (static_cast<int>(spfft__.size()) < n) {
+        throw std::runtime_error("not enough FFT drivers for the batched transform");
+    }
+    std::vector<SpfftProcessingUnitType> pu(n, SPFFT_PU_HOST);
+
+    switch (direction__) {
+        case 1: {
+            std::vector<double const*> f_pw(n);
+            for (int i = 0; i < n; i++) {
+                if (f__[i]->gvecp_->comm_ortho_fft().size() != 1) {
+                    f__[i]->gather_f_pw_fft();
+                }
+                f_pw[i] = reinterpret_cast<double const*>(f__[i]->f_pw_fft_.at(sddk::memory_t::host));
+            }
+            spfft::multi_transform_backward(n, spfft__.data(), f_pw.data(), pu.data());
+            for (int i = 0; i < n; i++) {
+                spfft_output(spfft__[i], &f__[i]->f_rg_[0]);
+            }
+            break;
+        }
+        case -1: {
+            std::vector<double*> f_pw(n);
+            for (int i = 0; i < n; i++) {
+                spfft_input(spfft__[i], &f__[i]->f_rg_[0]);
+                f_pw[i] = reinterpret_cast<double*>(f__[i]->f_pw_fft_.at(sddk::memory_t::host));
+            }
+            std::vector<SpfftScalingType> scaling(n, SPFFT_FULL_SCALING);
+            spfft::multi_transform_forward(n, spfft__.data(), pu.data(), f_pw.data(), scaling.data());
+            for (int i = 0; i < n; i++) {
+                if (f__[i]->gvecp_->comm_ortho_fft().size() != 1) {
+                    f__[i]->scatter_f_pw_fft();
+                }
+            }
+            break;
+        }
+        default: {
+            throw std::runtime_error("wrong FFT direction");
+        }
+    }
+}
+
 /// Vector of the smooth periodic functions.
 template <typename T>
 class Smooth_periodic_vector_function : public std::array<Smooth_periodic_function<T>, 3>
@@ -349,39 +409,53 @@ class Smooth_periodic_vector_function : public std::array<Smooth_periodic_functi
 };
 
 /// Gradient of the function in the plane-wave domain.
-/** Input functions is expected in the plane wave domain, output function is also in the plane-wave domain */
-inline Smooth_periodic_vector_function<double> gradient(Smooth_periodic_function<double>& f__)
+/** Plane-wave coefficients of the gradient are stored in the existing vector function. */
+inline void gradient(Smooth_periodic_function<double>& f__, Smooth_periodic_vector_function<double>& g__)
 {
     PROFILE("sirius::gradient");
 
+    #pragma omp parallel for schedule(static)
+    for (int igloc = 0; igloc < f__.gvec().count(); igloc++) {
+        auto G = f__.gvec().gvec_cart<sddk::index_domain_t::local>(igloc);
+        for (int x : {0, 1, 2}) {
+            g__[x].f_pw_local(igloc) = f__.f_pw_local(igloc) * double_complex(0, G[x]);
+        }
+    }
+}
+
+/// Gradient of the function in the plane-wave domain.
+/** Input functions is expected in the plane wave domain, output function is also in the plane-wave domain */
+inline Smooth_periodic_vector_function<double> gradient(Smooth_periodic_function<double>& f__)
+{
     Smooth_periodic_vector_function<double> g(f__.spfft(), f__.gvec_partition());
+    gradient(f__, g);
+    return g;
+}
+
+/// Divergence of the vector function in the plane-wave domain.
+/** Output function is allowed to be one of the components of the input vector function. */
+inline void divergence(Smooth_periodic_vector_function<double>& g__, Smooth_periodic_function<double>& f__)
+{
+    PROFILE("sirius::divergence");
 
     #pragma omp parallel for schedule(static)
     for (int igloc = 0; igloc < f__.gvec().count(); igloc++) {
         auto G = f__.gvec().gvec_cart<sddk::index_domain_t::local>(igloc);
+        double_complex z(0, 0);
         for (int x : {0, 1, 2}) {
-            g[x].f_pw_local(igloc) = f__.f_pw_local(igloc) * double_complex(0, G[x]);
+            z += g__[x].f_pw_local(igloc) * double_complex(0, G[x]);
         }
+        f__.f_pw_local(igloc) = z;
     }
-    return g;
 }
 
 /// Divergence of the vecor function.
 /** Input and output functions are in plane-wave domain */
 inline Smooth_periodic_function<double> divergence(Smooth_periodic_vector_function<double>& g__)
 {
-    PROFILE("sirius::divergence");
-
     /* resulting scalar function */
     Smooth_periodic_function<double> f(g__.spfft(), g__.gvec_partition());
-    f.zero();
-    for (int x : {0, 1, 2}) {
-        for (int igloc = 0; igloc < f.gvec().count(); igloc++) {
-            auto G = f.gvec().gvec_cart<sddk::index_domain_t::local>(igloc);
-            f.f_pw_local(igloc) += g__[x].f_pw_local(igloc) * double_complex(0, G[x]);
-        }
-    }
-
+    divergence(g__, f);
     return f;
 }
 
@@ -357,6 +357,17 @@ inline void spherical_harmonics(int lmax, double theta, double phi, double* rlm)
     }
 }
 
+/// Real spherical harmonics for a batch of directions.
+/** The directions are distributed between OpenMP threads, each calling the scalar spherical_harmonics() above.
+ *  On output rlm[lm + ld * i] contains \f$ R_{\ell m}(\theta_i, \phi_i) \f$. */
+inline void spherical_harmonics(int lmax, int n, double const* theta, double const* phi, double* rlm, int ld)
+{
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++) {
+        spherical_harmonics(lmax, theta[i], phi[i], rlm + static_cast<size_t>(ld) * i);
+    }
+}
+
 /// Generate \f$ \cos(m x) \f$ for m in [1, n] using recursion.
 inline sddk::mdarray<double, 1> cosxn(int n__, double x__)
 {
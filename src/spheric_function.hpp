@@ -30,6 +30,7 @@
 #include <typeinfo>
 #include "spline.hpp"
 #include "SHT/sht.hpp"
+#include "SHT/sht_hierarchy.hpp"
 
 namespace sirius {
 
@@ -518,6 +519,41 @@ inline Spheric_function<function_domain_t::spectral, T> transform(SHT const& sht
     return g;
 }
 
+template <typename T>
+inline void transform(SHT_hierarchy const& sht__, Spheric_function<function_domain_t::spectral, T> const& f__,
+                      Spheric_function<function_domain_t::spatial, T>& g__)
+{
+    sht__.backward_transform(f__.angular_domain_size(), &f__(0, 0), f__.radial_grid().num_points(),
+                             std::min(sht__.lmmax(), f__.angular_domain_size()), &g__(0, 0));
+}
+
+/// Transform to spatial domain using the radially adaptive spherical meshes.
+template <typename T>
+inline Spheric_function<function_domain_t::spatial, T>
+transform(SHT_hierarchy const& sht__, Spheric_function<function_domain_t::spectral, T> const& f__)
+{
+    Spheric_function<function_domain_t::spatial, T> g(sht__.num_points(), f__.radial_grid());
+    transform(sht__, f__, g);
+    return g;
+}
+
+template <typename T>
+inline void transform(SHT_hierarchy const& sht__, Spheric_function<function_domain_t::spatial, T> const& f__,
+                      Spheric_function<function_domain_t::spectral, T>& g__)
+{
+    sht__.forward_transform(&f__(0, 0), f__.radial_grid().num_points(), sht__.lmmax(), sht__.lmmax(), &g__(0, 0));
+}
+
+/// Transform to spectral domain using the radially adaptive spherical meshes.
+template <typename T>
+inline Spheric_function<function_domain_t::spectral, T>
+transform(SHT_hierarchy const& sht__, Spheric_function<function_domain_t::spatial, T> const& f__)
+{
+    Spheric_function<function_domain_t::spectral, T> g(sht__.lmmax(), f__.radial_grid());
+    transform(sht__, f__, g);
+    return g;
+}
+
 /// Gradient of the function in complex spherical harmonics.
 inline Spheric_vector_function<function_domain_t::spectral, double_complex> gradient(Spheric_function<function_domain_t::spectral, double_complex> const& f)
 {
@@ -82,7 +82,7 @@ class Spline : public Radial_grid<U>
     /* forbid assigment operator */
     Spline<T, U>& operator=(Spline<T, U> const& src__) = delete;
     /// Solver tridiagonal system of linear equaitons.
-    int solve(T* dl, T* d, T* du, T* b, int n)
+    static int solve(T* dl, T* d, T* du, T* b, int n)
     {
         for (int i = 0; i < n - 1; i++) {
             if (std::abs(dl[i]) == 0) {
@@ -353,6 +353,113 @@ class Spline : public Radial_grid<U>
         return *this;
     }
 
+    /// Weights of the spline inner product.
+    /** Return the weights \f$ w_i \f$ such that for any spline \f$ f(x) \f$ defined on the same grid
+        \f[
+          \int_{x_0}^{x_{n-1}} f(x) g(x) x^m dx = \sum_{i} f(x_i) w_i
+        \f]
+        where \f$ g(x) \f$ is this spline and \f$ n \f$ is the number of points. The result is identical to
+        inner(f, g, m, n) up to rounding, but a set of inner products with many functions \f$ f \f$ reduces to
+        a matrix multiplication. The weights are obtained by propagating the derivatives of the integral with
+        respect to the coefficients of the spline segments back through the interpolate() procedure. */
+    std::vector<T> inner_weights(int m__, int num_points__) const
+    {
+        int ns = this->num_points();
+        assert(ns >= 4);
+
+        /* derivatives of the integral with respect to the a, b, c and d coefficients of f in each segment */
+        sddk::mdarray<T, 2> h(ns, 4);
+        h.zero();
+        for (int i = 0; i < num_points__ - 1; i++) {
+            U x0 = this->x(i);
+            U dx = this->dx(i);
+            /* int_0^dx t^k (x0 + t)^m dt */
+            std::array<T, 7> p;
+            for (int k = 0; k < 7; k++) {
+                T t1 = std::pow(dx, k + 1) / (k + 1);
+                T t2 = std::pow(dx, k + 2) / (k + 2);
+                T t3 = std::pow(dx, k + 3) / (k + 3);
+                switch (m__) {
+                    case 0: {
+                        p[k] = t1;
+                        break;
+                    }
+                    case 1: {
+                        p[k] = x0 * t1 + t2;
+                        break;
+                    }
+                    case 2: {
+                        p[k] = x0 * x0 * t1 + 2.0 * x0 * t2 + t3;
+                        break;
+                    }
+                    default: {
+                        throw std::runtime_error("wrong r^m prefactor");
+                    }
+                }
+            }
+            for (int a = 0; a < 4; a++) {
+                for (int b = 0; b < 4; b++) {
+                    h(i, a) += p[a + b] * coeffs_(i, b);
+                }
+            }
+        }
+
+        /* adjoint of the coefficients evaluation: c_i = m_i / 2, b_i = dy_i - dx_i (m_i / 3 + m_{i+1} / 6),
+           d_i = (m_{i+1} - m_i) / (6 dx_i) */
+        std::vector<T> gm(ns, 0), gdy(ns - 1, 0);
+        for (int i = 0; i < ns - 1; i++) {
+            U dx = this->dx(i);
+            gdy[i] += h(i, 1);
+            gm[i] += h(i, 2) / 2.0 - h(i, 1) * dx / 3.0 - h(i, 3) / dx / 6.0;
+            gm[i + 1] += -h(i, 1) * dx / 6.0 + h(i, 3) / dx / 6.0;
+        }
+
+        /* adjoint of the tridiagonal solver: solve A^{T} x = gm */
+        std::vector<T> dl(ns - 1), d(ns), du(ns - 1);
+        for (int i = 0; i < ns - 2; i++) {
+            d[i + 1] = static_cast<T>(this->x(i + 2) - this->x(i)) * 2.0;
+        }
+        for (int i = 0; i < ns - 1; i++) {
+            du[i] = this->dx(i);
+            dl[i] = this->dx(i);
+        }
+        U h0  = this->dx(0);
+        U h1  = this->dx(1);
+        d[0]  = h0 - (h1 / h0) * h1;
+        /* upper diagonal of A becomes lower diagonal of A^{T} */
+        dl[0] = h1 * ((h1 / h0) + 1) + 2 * (h0 + h1);
+        h0         = this->dx(ns - 2);
+        h1         = this->dx(ns - 3);
+        d[ns - 1]  = h0 - (h1 / h0) * h1;
+        du[ns - 2] = h1 * ((h1 / h0) + 1) + 2 * (h0 + h1);
+
+        int info = solve(&dl[0], &d[0], &du[0], &gm[0], ns);
+        if (info) {
+            std::stringstream s;
+            s << "[sirius::Spline::inner_weights] error in tridiagonal solver: " << info;
+            throw std::runtime_error(s.str());
+        }
+
+        /* adjoint of the right-hand side: r_{i+1} = 6 (dy_{i+1} - dy_i), r_0 = r_1, r_{n-1} = r_{n-2} */
+        gm[1] += gm[0];
+        gm[ns - 2] += gm[ns - 1];
+        for (int i = 0; i < ns - 2; i++) {
+            gdy[i + 1] += 6.0 * gm[i + 1];
+            gdy[i] -= 6.0 * gm[i + 1];
+        }
+
+        /* adjoint of the finite differences dy_i = (y_{i+1} - y_i) / dx_i */
+        std::vector<T> w(ns, 0);
+        for (int i = 0; i < ns; i++) {
+            w[i] = h(i, 0);
+        }
+        for (int i = 0; i < ns - 1; i++) {
+            w[i + 1] += gdy[i] / this->dx(i);
+            w[i] -= gdy[i] / this->dx(i);
+        }
+        return w;
+    }
+
     /// Integrate spline with r^m prefactor.
     /**
     Derivation for r^2 prefactor is based on the following Mathematica notebook:
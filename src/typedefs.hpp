@@ -72,6 +72,22 @@ enum class function_domain_t
     spectral
 };
 
+/// Type of smearing of the band occupancies.
+enum class smearing_t
+{
+    /// Gaussian smearing.
+    gaussian,
+
+    /// Fermi-Dirac distribution.
+    fermi_dirac,
+
+    /// First-order Methfessel-Paxton smearing.
+    methfessel_paxton,
+
+    /// Marzari-Vanderbilt cold smearing.
+    cold
+};
+
 /// Type of relativity treatment in the case of LAPW.
 enum class relativity_t
 {
@@ -26,4 +26,5 @@
 
 namespace utils {
 ::rt_graph::Timer global_rtgraph_timer;
+bool global_rtgraph_timer_suspended{false};
 }
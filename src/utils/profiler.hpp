@@ -27,6 +27,9 @@
 
 #include <mpi.h>
 #include <string>
+#include <new>
+#include <utility>
+#include <type_traits>
 #if defined(__APEX)
 #include <apex_api.hpp>
 #endif
@@ -39,6 +42,48 @@ namespace utils {
 
 extern ::rt_graph::Timer global_rtgraph_timer;
 
+/// True if the global timer is temporarily switched off.
+/** The timer is not thread-safe; it is switched off while several teams of threads run the instrumented code
+ *  concurrently. */
+extern bool global_rtgraph_timer_suspended;
+
+/// Scoped timing of a code region which is skipped when the global timer is suspended.
+class scoped_timing
+{
+  private:
+    typename std::aligned_storage<sizeof(::rt_graph::ScopedTiming), alignof(::rt_graph::ScopedTiming)>::type timing_;
+    bool active_{false};
+
+  public:
+    template <std::size_t N>
+    scoped_timing(char const (&identifier__)[N])
+        : active_(!global_rtgraph_timer_suspended)
+    {
+        if (active_) {
+            new (&timing_)::rt_graph::ScopedTiming(identifier__, global_rtgraph_timer);
+        }
+    }
+
+    scoped_timing(std::string identifier__)
+        : active_(!global_rtgraph_timer_suspended)
+    {
+        if (active_) {
+            new (&timing_)::rt_graph::ScopedTiming(std::move(identifier__), global_rtgraph_timer);
+        }
+    }
+
+    scoped_timing(scoped_timing const&) = delete;
+
+    scoped_timing& operator=(scoped_timing const&) = delete;
+
+    ~scoped_timing()
+    {
+        if (active_) {
+            reinterpret_cast<::rt_graph::ScopedTiming*>(&timing_)->~ScopedTiming();
+        }
+    }
+};
+
 // TODO: add calls to apex and cudaNvtx
 
 #if defined(__PROFILE)
@@ -46,11 +91,16 @@ extern ::rt_graph::Timer global_rtgraph_timer;
     #define PROFILER_CONCAT(x, y) PROFILER_CONCAT_IMPL(x, y)
 
     #define PROFILE(identifier)                                                                                            \
-        ::rt_graph::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier,                            \
-                                                                                    ::utils::global_rtgraph_timer);
+        ::utils::scoped_timing PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier);
 
-    #define PROFILE_START(identifier) ::utils::global_rtgraph_timer.start(identifier);
-    #define PROFILE_STOP(identifier) ::utils::global_rtgraph_timer.stop(identifier);
+    #define PROFILE_START(identifier)                                                                                      \
+        if (!::utils::global_rtgraph_timer_suspended) {                                                                    \
+            ::utils::global_rtgraph_timer.start(identifier);                                                               \
+        }
+    #define PROFILE_STOP(identifier)                                                                                       \
+        if (!::utils::global_rtgraph_timer_suspended) {                                                                    \
+            ::utils::global_rtgraph_timer.stop(identifier);                                                                \
+        }
 #else
     #define PROFILE(...)
     #define PROFILE_START(...)
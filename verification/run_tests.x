@@ -33,4 +33,28 @@ for f in ./*; do
   fi
 done
 
+# direct minimization of an insulator (LiF, Gamma-point) must reproduce the SCF total energy
+if [ -z "$SIRIUS_TEST_BINARIES" ];
+then
+    export SIRIUS_TEST_BINARIES=${SIRIUS_BINARIES}/../tests
+fi
+
+exe=${SIRIUS_TEST_BINARIES}/test_direct_min
+if [[ $(type -f ${exe} 2> /dev/null) ]]; then
+    echo "running direct minimization in './test04'"
+    cd ./test04
+    ${SRUN_CMD} ${exe} --tol=1e-6
+    err=$?
+
+    if [ ${err} == 0 ]; then
+      echo "OK"
+    else
+      echo "direct minimization in './test04' failed"
+      exit ${err}
+    fi
+    cd ../
+else
+    echo "'${exe}' is not found; skipping the direct minimization test"
+fi
+
 echo "All tests were passed correctly!"